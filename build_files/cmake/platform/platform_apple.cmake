@@ -451,6 +451,14 @@ if(WITH_GMP)
   endif()
 endif()
 
+if(WITH_ZSTD)
+  find_package(Zstd)
+  if(NOT ZSTD_FOUND)
+    message(WARNING "Zstd not found, disabling WITH_ZSTD")
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_HARU)
   find_package(Haru)
   if(NOT HARU_FOUND)
@@ -537,6 +537,14 @@ if(WITH_LZO AND WITH_SYSTEM_LZO)
   endif()
 endif()
 
+if(WITH_ZSTD)
+  find_package_wrapper(Zstd)
+  if(NOT ZSTD_FOUND)
+    message(WARNING "Zstd not found, disabling WITH_ZSTD")
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_SYSTEM_EIGEN3)
   find_package_wrapper(Eigen3)
   if(NOT EIGEN3_FOUND)
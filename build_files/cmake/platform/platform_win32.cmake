@@ -862,6 +862,18 @@ if(WITH_POTRACE)
   set(POTRACE_FOUND On)
 endif()
 
+if(WITH_ZSTD)
+  if(EXISTS ${LIBDIR}/zstd)
+    set(ZSTD_FOUND On)
+    set(ZSTD_ROOT_DIR ${LIBDIR}/zstd)
+    set(ZSTD_INCLUDE_DIRS ${ZSTD_ROOT_DIR}/include)
+    set(ZSTD_LIBRARIES ${ZSTD_ROOT_DIR}/lib/zstd_static.lib)
+  else()
+    message(WARNING "Zstd was not found, disabling WITH_ZSTD")
+    set(WITH_ZSTD OFF)
+  endif()
+endif()
+
 if(WITH_HARU)
   if(EXISTS ${LIBDIR}/haru)
     set(HARU_FOUND On)
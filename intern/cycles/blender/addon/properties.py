@@ -392,6 +392,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Sample lights using a tree that accounts for their distance, orientation and power, "
+        "reducing noise in scenes with many lights (not used when branched path tracing samples all lights)",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -801,6 +807,20 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures on demand during CPU rendering, loading only the tiles and mipmap levels that are needed. "
+        "Reduces memory usage for scenes with many or large textures, tiled and mipmapped .tx files work best",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        min=64, max=1048576,
+        default=4096,
+        subtype='UNSIGNED',
+    )
+
     use_fast_gi: BoolProperty(
         name="Fast GI Approximation",
         description="Approximate diffuse indirect light with background tinted ambient occlusion. This provides fast alternative to full global illumination, for interactive viewport rendering or final renders with reduced quality",
@@ -322,10 +322,16 @@ class CYCLES_RENDER_PT_sampling_advanced(CyclesButtonsPanel, Panel):
         col.prop(cscene, "min_transparent_bounces")
         col.prop(cscene, "light_sampling_threshold", text="Light Threshold")
 
+        sample_all_lights = False
         if cscene.progressive != 'PATH' and use_branched_path(context):
             col = layout.column(align=True)
             col.prop(cscene, "sample_all_lights_direct")
             col.prop(cscene, "sample_all_lights_indirect")
+            sample_all_lights = cscene.sample_all_lights_direct or cscene.sample_all_lights_indirect
+
+        col = layout.column()
+        col.active = not sample_all_lights
+        col.prop(cscene, "use_light_tree")
 
         for view_layer in scene.view_layers:
             if view_layer.samples > 0:
@@ -780,6 +786,30 @@ class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
         col.prop(rd, "use_persistent_data", text="Persistent Data")
 
 
+class CYCLES_RENDER_PT_performance_texture_cache(CyclesButtonsPanel, Panel):
+    bl_label = "Texture Cache"
+    bl_parent_id = "CYCLES_RENDER_PT_performance"
+
+    def draw_header(self, context):
+        layout = self.layout
+
+        cscene = context.scene.cycles
+
+        layout.active = use_cpu(context)
+        layout.prop(cscene, "use_texture_cache", text="")
+
+    def draw(self, context):
+        layout = self.layout
+        layout.use_property_split = True
+        layout.use_property_decorate = False
+
+        cscene = context.scene.cycles
+
+        col = layout.column()
+        col.active = use_cpu(context) and cscene.use_texture_cache
+        col.prop(cscene, "texture_cache_size", text="Size (MB)")
+
+
 class CYCLES_RENDER_PT_performance_viewport(CyclesButtonsPanel, Panel):
     bl_label = "Viewport"
     bl_parent_id = "CYCLES_RENDER_PT_performance"
@@ -2295,6 +2325,7 @@ classes = (
     CYCLES_RENDER_PT_performance_tiles,
     CYCLES_RENDER_PT_performance_acceleration_structure,
     CYCLES_RENDER_PT_performance_final_render,
+    CYCLES_RENDER_PT_performance_texture_cache,
     CYCLES_RENDER_PT_performance_viewport,
     CYCLES_RENDER_PT_passes,
     CYCLES_RENDER_PT_passes_data,
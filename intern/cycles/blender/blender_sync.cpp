@@ -244,21 +244,37 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
 
   scoped_timer timer;
 
+  /* Time each stage for the render statistics. */
+  sync_times.clear();
+  double stage_start = timer.get_start();
+  auto end_stage = [&](const char *name) {
+    const double time = time_dt();
+    sync_times.add_entry({name, time - stage_start});
+    stage_start = time;
+  };
+
   BL::ViewLayer b_view_layer = b_depsgraph.view_layer_eval();
 
   sync_view_layer(b_v3d, b_view_layer);
   sync_integrator();
   sync_film(b_v3d);
+  end_stage("sync_settings");
+
   sync_shaders(b_depsgraph, b_v3d);
+  end_stage("sync_shaders");
+
   sync_images();
+  end_stage("sync_images");
 
   geometry_synced.clear(); /* use for objects and motion sync */
 
   if (scene->need_motion() == Scene::MOTION_PASS || scene->need_motion() == Scene::MOTION_NONE ||
       scene->camera->get_motion_position() == Camera::MOTION_POSITION_CENTER) {
     sync_objects(b_depsgraph, b_v3d);
+    end_stage("sync_objects");
   }
   sync_motion(b_render, b_depsgraph, b_v3d, b_override, width, height, python_thread_state);
+  end_stage("sync_motion");
 
   geometry_synced.clear();
 
@@ -267,6 +283,7 @@ void BlenderSync::sync_data(BL::RenderSettings &b_render,
   shader_map.post_sync(false);
 
   free_data_after_sync(b_depsgraph);
+  end_stage("free_data_after_sync");
 
   VLOG(1) << "Total time spent synchronizing data: " << timer.get_time();
 
@@ -330,6 +347,7 @@ void BlenderSync::sync_integrator()
   integrator->set_sample_all_lights_direct(get_boolean(cscene, "sample_all_lights_direct"));
   integrator->set_sample_all_lights_indirect(get_boolean(cscene, "sample_all_lights_indirect"));
   integrator->set_light_sampling_threshold(get_float(cscene, "light_sampling_threshold"));
+  integrator->set_use_light_tree(get_boolean(cscene, "use_light_tree"));
 
   SamplingPattern sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
@@ -779,6 +797,11 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph &b_depsgraph)
   }
 }
 
+void BlenderSync::collect_statistics(RenderStats *stats)
+{
+  stats->sync = sync_times;
+}
+
 /* Scene Parameters */
 
 SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
@@ -792,7 +815,12 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   else if (shadingsystem == 1)
     params.shadingsystem = SHADINGSYSTEM_OSL;
 
-  if (background || DebugFlags().viewport_static_bvh)
+  /* With persistent data the scene is kept across animation frames, and a dynamic BVH lets the
+   * BVH of geometry that does not change be reused, only rebuilding the top level. A static BVH
+   * bakes object transforms into the geometry, so any animated object would rebuild it all. */
+  const bool is_persistent_data = b_scene.render().use_persistent_data();
+
+  if ((background && !is_persistent_data) || DebugFlags().viewport_static_bvh)
     params.bvh_type = SceneParams::BVH_STATIC;
   else
     params.bvh_type = SceneParams::BVH_DYNAMIC;
@@ -820,6 +848,9 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = get_boolean(cscene, "use_texture_cache");
+  params.texture_cache_size = get_int(cscene, "texture_cache_size");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
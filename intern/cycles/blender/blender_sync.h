@@ -27,6 +27,7 @@
 
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_map.h"
 #include "util/util_set.h"
@@ -95,6 +96,9 @@ class BlenderSync {
     return view_layer.bound_samples;
   }
 
+  /* Time spent in each stage of the last sync_data(). */
+  void collect_statistics(RenderStats *stats);
+
   /* get parameters */
   static SceneParams get_scene_params(BL::Scene &b_scene, bool background);
   static SessionParams get_session_params(
@@ -188,6 +192,10 @@ class BlenderSync {
                             bool use_particle_hair,
                             TaskPool *task_pool);
 
+  /* Geometry that is synced in the current object loop, its conversion may still be running in
+   * the geometry task pool so it can not be tested for modifications yet. */
+  bool geometry_is_synced(Geometry *geom) const;
+
   /* Light */
   void sync_light(BL::Object &b_parent,
                   int persistent_id[OBJECT_PERSISTENT_ID_SIZE],
@@ -228,6 +236,7 @@ class BlenderSync {
   set<Geometry *> geometry_synced;
   set<Geometry *> geometry_motion_synced;
   set<float> motion_times;
+  NamedTimeStats sync_times;
   void *world_map;
   bool world_recalc;
   BlenderViewportParameters viewport_parameters;
@@ -42,7 +42,10 @@ int BVHStackEntry::encodeIdx() const
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_),
+      top_level_prims_size(0),
+      top_level_nodes_size(0),
+      top_level_leaf_nodes_size(0)
 {
 }
 
@@ -100,12 +103,35 @@ void BVH2::build(Progress &progress, Stats *)
 
 void BVH2::refit(Progress &progress)
 {
+  if (params.top_level) {
+    /* Strip the merged instances and the offsets added to the primitive indices when merging,
+     * the instance BVHs are merged again after packing so they include their refitted nodes. */
+    pack.prim_index.resize(top_level_prims_size);
+    pack.prim_type.resize(top_level_prims_size);
+    pack.prim_object.resize(top_level_prims_size);
+    if (pack.prim_time.size()) {
+      pack.prim_time.resize(top_level_prims_size);
+    }
+    pack.nodes.resize(top_level_nodes_size);
+    pack.leaf_nodes.resize(top_level_leaf_nodes_size);
+
+    for (size_t i = 0; i < pack.prim_index.size(); i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] -= objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+  }
+
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
   if (progress.get_cancel())
     return;
 
+  if (params.top_level) {
+    pack_instances(top_level_nodes_size, top_level_leaf_nodes_size);
+  }
+
   progress.set_substatus("Refitting BVH nodes");
   refit_nodes();
 }
@@ -260,6 +286,9 @@ void BVH2::pack_nodes(const BVHNode *root)
   pack.leaf_nodes.clear();
   /* For top level BVH, first merge existing BVH's so we know the offsets. */
   if (params.top_level) {
+    top_level_prims_size = pack.prim_index.size();
+    top_level_nodes_size = node_size;
+    top_level_leaf_nodes_size = num_leaf_nodes * BVH_NODE_LEAF_SIZE;
     pack_instances(node_size, num_leaf_nodes * BVH_NODE_LEAF_SIZE);
   }
   else {
@@ -315,8 +344,6 @@ void BVH2::pack_nodes(const BVHNode *root)
 
 void BVH2::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
@@ -331,7 +358,13 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c0 = data[0].x;
     const int c1 = data[0].y;
 
-    refit_primitives(c0, c1, bbox, visibility);
+    if (c0 < 0) {
+      /* Object instance in the top level BVH. */
+      refit_primitives(~c0, ~c0 + 1, bbox, visibility);
+    }
+    else {
+      refit_primitives(c0, c1, bbox, visibility);
+    }
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
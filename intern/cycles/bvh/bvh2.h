@@ -103,6 +103,11 @@ class BVH2 : public BVH {
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+
+  /* Size of the top level BVH data preceding the merged instances, to refit it in place. */
+  size_t top_level_prims_size;
+  size_t top_level_nodes_size;
+  size_t top_level_leaf_nodes_size;
 };
 
 CCL_NAMESPACE_END
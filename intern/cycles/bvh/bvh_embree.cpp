@@ -335,9 +335,12 @@ void BVHEmbree::build(Progress &progress, Stats *stats, RTCDevice rtc_device_)
   const RTCSceneFlags scene_flags = (dynamic ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE) |
                                     RTC_SCENE_FLAG_COMPACT | RTC_SCENE_FLAG_ROBUST;
   rtcSetSceneFlags(scene, scene_flags);
-  build_quality = dynamic ? RTC_BUILD_QUALITY_LOW :
-                            (params.use_spatial_split ? RTC_BUILD_QUALITY_HIGH :
-                                                        RTC_BUILD_QUALITY_MEDIUM);
+  /* Only trade quality for build time in the viewport. Final renders can use a dynamic BVH
+   * with persistent data, and are still built for render speed. */
+  build_quality = (dynamic && !params.background) ?
+                      RTC_BUILD_QUALITY_LOW :
+                      (params.use_spatial_split ? RTC_BUILD_QUALITY_HIGH :
+                                                  RTC_BUILD_QUALITY_MEDIUM);
   rtcSetSceneBuildQuality(scene, build_quality);
 
   int i = 0;
@@ -693,6 +696,10 @@ void BVHEmbree::refit(Progress &progress)
         }
       }
     }
+    else if (ob->is_traceable()) {
+      /* Commit instances again so they pick up the bounds of refitted instanced scenes. */
+      rtcCommitGeometry(rtcGetGeometry(scene, geom_id));
+    }
     geom_id += 2;
   }
 
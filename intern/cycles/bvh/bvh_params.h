@@ -87,6 +87,7 @@ class BVHParams {
 
   /* Same as in SceneParams. */
   int bvh_type;
+  bool background;
 
   /* These are needed for Embree. */
   int curve_subdivisions;
@@ -120,6 +121,7 @@ class BVHParams {
     num_motion_triangle_steps = 0;
 
     bvh_type = 0;
+    background = false;
 
     curve_subdivisions = 4;
   }
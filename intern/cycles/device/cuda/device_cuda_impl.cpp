@@ -952,6 +952,23 @@ void CUDADevice::generic_copy_to(device_memory &mem)
   }
 }
 
+void CUDADevice::generic_copy_to(device_memory &mem, size_t offset, size_t size)
+{
+  if (!mem.host_pointer || !mem.device_pointer) {
+    return;
+  }
+
+  assert(offset + size <= mem.memory_size());
+
+  thread_scoped_lock lock(cuda_mem_map_mutex);
+  if (!cuda_mem_map[&mem].use_mapped_host || mem.host_pointer != mem.shared_pointer) {
+    const CUDAContextScope scope(this);
+    cuda_assert(cuMemcpyHtoD((CUdeviceptr)mem.device_pointer + offset,
+                             (const char *)mem.host_pointer + offset,
+                             size));
+  }
+}
+
 void CUDADevice::generic_free(device_memory &mem)
 {
   if (mem.device_pointer) {
@@ -1026,6 +1043,20 @@ void CUDADevice::mem_copy_to(device_memory &mem)
   }
 }
 
+void CUDADevice::mem_copy_range_to(device_memory &mem, size_t offset, size_t size)
+{
+  /* Global memory is copied in place when the allocation still fits, so the pointer in the
+   * kernel globals remains valid. */
+  if ((mem.type == MEM_GLOBAL || mem.type == MEM_READ_ONLY || mem.type == MEM_READ_WRITE) &&
+      mem.device_pointer && mem.device_size == mem.memory_size() &&
+      (mem.type != MEM_GLOBAL || mem.is_resident(this))) {
+    generic_copy_to(mem, offset, size);
+  }
+  else {
+    mem_copy_to(mem);
+  }
+}
+
 void CUDADevice::mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
 {
   if (mem.type == MEM_PIXELS && !background) {
@@ -366,6 +366,11 @@ void Device::draw_pixels(device_memory &rgba,
   }
 }
 
+void Device::mem_copy_range_to(device_memory &mem, size_t /*offset*/, size_t /*size*/)
+{
+  mem_copy_to(mem);
+}
+
 void Device::build_bvh(BVH *bvh, Progress &progress, bool refit)
 {
   assert(bvh->params.bvh_layout == BVH_LAYOUT_BVH2);
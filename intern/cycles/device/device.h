@@ -487,6 +487,9 @@ class Device {
 
   virtual void mem_alloc(device_memory &mem) = 0;
   virtual void mem_copy_to(device_memory &mem) = 0;
+  /* Copy a byte range of memory that was already copied to the device before. Devices without
+   * support for it copy everything again. */
+  virtual void mem_copy_range_to(device_memory &mem, size_t offset, size_t size);
   virtual void mem_copy_from(device_memory &mem, int y, int w, int h, int elem) = 0;
   virtual void mem_zero(device_memory &mem) = 0;
   virtual void mem_free(device_memory &mem) = 0;
@@ -253,6 +253,7 @@ class device_memory {
   void device_alloc();
   void device_free();
   void device_copy_to();
+  void device_copy_to(size_t offset, size_t size);
   void device_copy_from(int y, int w, int h, int elem);
   void device_zero();
 
@@ -333,6 +334,8 @@ template<typename T> class device_vector : public device_memory {
     data_elements = device_type_traits<T>::num_elements;
     modified = true;
     need_realloc_ = true;
+    modified_begin = 0;
+    modified_end = 0;
 
     assert(data_elements > 0);
   }
@@ -418,6 +421,20 @@ template<typename T> class device_vector : public device_memory {
     assert(device_pointer == 0);
   }
 
+  /* Temporarily hand the host memory over to an array without freeing the device memory, so it
+   * can be updated in place. The array must be given back with take_back_data() unresized, after
+   * which only the ranges tagged as modified need to be copied to the device again. */
+  void lend_data(array<T> &to)
+  {
+    to.set_data((T *)host_pointer, data_size);
+  }
+
+  void take_back_data(array<T> &from)
+  {
+    assert(from.data() == host_pointer && from.size() == data_size);
+    from.steal_pointer();
+  }
+
   /* Free device and host memory. */
   void free()
   {
@@ -431,6 +448,8 @@ template<typename T> class device_vector : public device_memory {
     host_pointer = 0;
     modified = true;
     need_realloc_ = true;
+    modified_begin = 0;
+    modified_end = 0;
     assert(device_pointer == 0);
   }
 
@@ -456,6 +475,24 @@ template<typename T> class device_vector : public device_memory {
     modified = true;
   }
 
+  /* Tag a range of elements as modified. Unless the entire vector is tagged as well, only the
+   * union of the modified ranges is copied by copy_to_device_if_modified(). */
+  void tag_modified(size_t offset, size_t num)
+  {
+    if (num == 0) {
+      return;
+    }
+
+    if (modified_end == 0) {
+      modified_begin = offset;
+      modified_end = offset + num;
+    }
+    else {
+      modified_begin = (offset < modified_begin) ? offset : modified_begin;
+      modified_end = (offset + num > modified_end) ? offset + num : modified_end;
+    }
+  }
+
   void tag_realloc()
   {
     need_realloc_ = true;
@@ -487,17 +524,25 @@ template<typename T> class device_vector : public device_memory {
 
   void copy_to_device_if_modified()
   {
-    if (!modified) {
+    if (modified || !device_pointer) {
+      if (modified || modified_end != 0) {
+        copy_to_device();
+      }
       return;
     }
 
-    copy_to_device();
+    const size_t end = (modified_end < data_size) ? modified_end : data_size;
+    if (modified_begin < end) {
+      device_copy_to(sizeof(T) * modified_begin, sizeof(T) * (end - modified_begin));
+    }
   }
 
   void clear_modified()
   {
     modified = false;
     need_realloc_ = false;
+    modified_begin = 0;
+    modified_end = 0;
   }
 
   void copy_from_device()
@@ -528,6 +573,10 @@ template<typename T> class device_vector : public device_memory {
   {
     return width * ((height == 0) ? 1 : height) * ((depth == 0) ? 1 : depth);
   }
+
+  /* Range of elements tagged as modified, empty when modified_end is zero. */
+  size_t modified_begin;
+  size_t modified_end;
 };
 
 /* Pixel Memory
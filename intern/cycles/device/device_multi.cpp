@@ -440,6 +440,43 @@ class MultiDevice : public Device {
     stats.mem_alloc(mem.device_size - existing_size);
   }
 
+  void mem_copy_range_to(device_memory &mem, size_t offset, size_t size) override
+  {
+    device_ptr existing_key = mem.device_pointer;
+    if (!existing_key || mem.type == MEM_TEXTURE || strcmp(mem.name, "RenderBuffers") == 0) {
+      mem_copy_to(mem);
+      return;
+    }
+
+    /* Only the owner of the memory in each island holds a copy, pointers in the kernel globals
+     * of the other devices remain valid as long as it is copied in place. */
+    size_t existing_size = mem.device_size;
+
+    foreach (const vector<SubDevice *> &island, peer_islands) {
+      SubDevice *owner_sub = find_suitable_mem_device(existing_key, island);
+      const device_ptr existing_ptr = owner_sub->ptr_map[existing_key];
+      mem.device = owner_sub->device;
+      mem.device_pointer = existing_ptr;
+      mem.device_size = existing_size;
+
+      owner_sub->device->mem_copy_range_to(mem, offset, size);
+      owner_sub->ptr_map[existing_key] = mem.device_pointer;
+
+      if (mem.type == MEM_GLOBAL && mem.device_pointer != existing_ptr) {
+        /* Memory was reallocated after all, update the pointer in kernel globals. */
+        foreach (SubDevice *island_sub, island) {
+          if (island_sub != owner_sub) {
+            island_sub->device->mem_copy_to(mem);
+          }
+        }
+      }
+    }
+
+    mem.device = this;
+    mem.device_pointer = existing_key;
+    stats.mem_alloc(mem.device_size - existing_size);
+  }
+
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem) override
   {
     device_ptr key = mem.device_pointer;
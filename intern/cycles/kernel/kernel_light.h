@@ -15,6 +15,7 @@
  */
 
 #include "kernel_light_background.h"
+#include "kernel_light_tree.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -171,11 +172,21 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
-
   return (ls->pdf > 0.0f);
 }
 
+/* Probability of selecting the lamp for the shading point. */
+ccl_device_inline float lamp_light_select_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+  if (kernel_data.integrator.use_light_tree) {
+    const int num_triangles = kernel_data.integrator.num_distribution -
+                              kernel_data.integrator.num_all_lights;
+    return light_tree_pdf(kg, P, num_triangles + lamp);
+  }
+
+  return kernel_data.integrator.pdf_lights;
+}
+
 ccl_device bool lamp_light_eval(
     KernelGlobals *kg, int lamp, float3 P, float3 D, float t, LightSample *ls)
 {
@@ -328,7 +339,7 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= lamp_light_select_pdf(kg, lamp, P);
 
   return true;
 }
@@ -365,12 +376,10 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
-                                                const float3 Ng,
-                                                const float3 I,
-                                                float t)
+ccl_device_inline float triangle_light_pdf_area(
+    KernelGlobals *kg, const float3 Ng, const float3 I, float t, float pdf_triangles)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
+  float pdf = pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -385,6 +394,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
    * and simple area sampling, comparing the distance to the triangle plane
    * to the length of the edges of the triangle. */
 
+  float pdf_triangles = kernel_data.integrator.pdf_triangles;
+  if (kernel_data.integrator.use_light_tree) {
+    const float3 Px = sd->P + sd->I * t;
+    pdf_triangles = light_tree_triangle_pdf_area(kg, Px, sd->object, sd->prim);
+  }
+
   float3 V[3];
   bool has_motion = triangle_world_space_vertices(kg, sd->object, sd->prim, sd->time, V);
 
@@ -426,12 +441,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
       else {
         area = 0.5f * len(N);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       return pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t, pdf_triangles);
     if (has_motion) {
       const float area = 0.5f * len(N);
       if (UNLIKELY(area == 0.0f)) {
@@ -455,7 +470,8 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   float randv,
                                                   float time,
                                                   LightSample *ls,
-                                                  const float3 P)
+                                                  const float3 P,
+                                                  float pdf_triangles)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -579,7 +595,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
         triangle_world_space_vertices(kg, object, prim, -1.0f, V);
         area = triangle_area(V[0], V[1], V[2]);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       ls->pdf = pdf / solid_angle;
     }
   }
@@ -601,7 +617,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t, pdf_triangles);
     if (has_motion && area != 0.0f) {
       /* scale the PDF.
        * area = the area the sample was taken from
@@ -669,9 +685,20 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  float select_pdf = kernel_data.integrator.pdf_lights;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (kernel_data.integrator.use_light_tree) {
+      index = light_tree_sample(kg, P, &randu, &select_pdf);
+      if (index < 0) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -682,7 +709,13 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
       int object = kdistribution->mesh_light.object_id;
       int shader_flag = kdistribution->mesh_light.shader_flag;
 
-      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+      float pdf_triangles = kernel_data.integrator.pdf_triangles;
+      if (kernel_data.integrator.use_light_tree) {
+        const float area = kernel_tex_fetch(__light_tree_emitters, index).area;
+        pdf_triangles = (area > 0.0f) ? select_pdf / area : 0.0f;
+      }
+
+      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P, pdf_triangles);
       ls->shader |= shader_flag;
       return (ls->pdf > 0.0f);
     }
@@ -694,7 +727,13 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+    return false;
+  }
+
+  ls->pdf *= select_pdf;
+
+  return (ls->pdf > 0.0f);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
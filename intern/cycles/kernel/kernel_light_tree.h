@@ -0,0 +1,232 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Hierarchy over the mesh lights and lamps, built by LightTree on the host. Traversing it selects
+ * an emitter proportional to an estimate of its contribution to the shading point, taking into
+ * account the power, distance and orientation of the emitters. Distant and background lights are
+ * not part of the tree and are selected uniformly with a fixed probability.
+ *
+ * Based on "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Alejandro Conty
+ * Estevez and Christopher Kulla. */
+
+ccl_device float light_tree_node_importance(const ccl_global KernelLightTreeNode *knode,
+                                            const float3 P)
+{
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius = 0.5f * len(bbox_max - bbox_min);
+
+  const float3 D = P - centroid;
+  const float distance = len(D);
+
+  /* Angle between the axis and the direction to the shading point, minus the spread of the
+   * normals and the angle subtended by the bounds. Emitters can not illuminate the point when
+   * what is left exceeds the emission angle. */
+  float cos_theta = (distance > 0.0f) ? dot(axis, D) / distance : 1.0f;
+  if (knode->two_sided) {
+    cos_theta = fabsf(cos_theta);
+  }
+  const float theta = fast_acosf(clamp(cos_theta, -1.0f, 1.0f));
+  const float theta_u = (distance > radius) ? fast_asinf(radius / distance) : M_PI_F;
+  const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+
+  if (theta_prime >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  /* Clamp the distance to avoid overestimating nodes the shading point is close to or inside. */
+  const float distance_squared = max(distance * distance, 0.25f * radius * radius);
+
+  return knode->energy * fast_cosf(theta_prime) / max(distance_squared, 1e-12f);
+}
+
+/* Select an emitter for the shading point, returning its index in the light distribution or -1
+ * when no emitter can illuminate it. The random number is rescaled to be reused. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  const float pdf_local = kernel_data.integrator.light_tree_pdf_local;
+  float r = *randu;
+
+  if (r >= pdf_local) {
+    /* Distant and background lights. */
+    const int num_infinite = kernel_data.integrator.light_tree_num_infinite;
+    r = (r - pdf_local) / (1.0f - pdf_local);
+    const int i = min((int)(r * num_infinite), num_infinite - 1);
+    *randu = clamp(r * num_infinite - i, 0.0f, 1.0f);
+    *pdf = kernel_data.integrator.pdf_lights;
+    return kernel_tex_fetch(__light_tree_leaf_emitters,
+                            kernel_data.integrator.light_tree_infinite_offset + i);
+  }
+
+  r /= pdf_local;
+  float selection_pdf = pdf_local;
+
+  /* Descend into the children proportional to their importance. */
+  int node_index = 0;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (knode->num_emitters == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float left_importance = light_tree_node_importance(
+        &kernel_tex_fetch(__light_tree_nodes, left_index), P);
+    const float right_importance = light_tree_node_importance(
+        &kernel_tex_fetch(__light_tree_nodes, right_index), P);
+    const float total_importance = left_importance + right_importance;
+
+    if (total_importance == 0.0f) {
+      return -1;
+    }
+
+    const float left_probability = left_importance / total_importance;
+    if (r < left_probability) {
+      node_index = left_index;
+      r = r / left_probability;
+      selection_pdf *= left_probability;
+    }
+    else {
+      node_index = right_index;
+      r = (r - left_probability) / (1.0f - left_probability);
+      selection_pdf *= 1.0f - left_probability;
+    }
+
+    knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  }
+
+  /* Select an emitter in the leaf proportional to its energy. */
+  float r_energy = r * knode->energy;
+
+  for (int i = 0; i < knode->num_emitters; i++) {
+    const int index = kernel_tex_fetch(__light_tree_leaf_emitters, knode->child_index + i);
+    const float energy = kernel_tex_fetch(__light_tree_emitters, index).energy;
+
+    if (r_energy < energy || i == knode->num_emitters - 1) {
+      *randu = clamp(r_energy / energy, 0.0f, 1.0f);
+      *pdf = selection_pdf * energy / knode->energy;
+      return index;
+    }
+
+    r_energy -= energy;
+  }
+
+  return -1;
+}
+
+/* Probability of light_tree_sample() selecting the emitter with the given index in the light
+ * distribution from the shading point. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, int index)
+{
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        index);
+  if (kemitter->leaf_index == -1) {
+    return kernel_data.integrator.pdf_lights;
+  }
+  else if (kemitter->leaf_index < 0) {
+    return 0.0f;
+  }
+
+  int node_index = kemitter->leaf_index;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  float pdf = kernel_data.integrator.light_tree_pdf_local * kemitter->energy / knode->energy;
+
+  /* Walk up to the root, computing the probabilities the same way as light_tree_sample(). */
+  while (node_index != 0) {
+    const int parent_index = knode->parent_index;
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes,
+                                                                      parent_index);
+    const bool is_left = (node_index == parent_index + 1);
+    const int left_index = parent_index + 1;
+    const int right_index = kparent->child_index;
+    const float left_importance = light_tree_node_importance(
+        &kernel_tex_fetch(__light_tree_nodes, left_index), P);
+    const float right_importance = light_tree_node_importance(
+        &kernel_tex_fetch(__light_tree_nodes, right_index), P);
+    const float total_importance = left_importance + right_importance;
+
+    if (total_importance == 0.0f) {
+      return 0.0f;
+    }
+
+    const float left_probability = left_importance / total_importance;
+    pdf *= (is_left) ? left_probability : 1.0f - left_probability;
+
+    node_index = parent_index;
+    knode = kparent;
+  }
+
+  return pdf;
+}
+
+/* Index of a mesh light triangle in the light distribution, where triangles are sorted by object
+ * and primitive. Returns -1 when the triangle is not a light. */
+ccl_device int light_tree_triangle_index(KernelGlobals *kg, int object, int prim)
+{
+  int first = 0;
+  int len = kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights;
+
+  while (len > 0) {
+    const int half_len = len >> 1;
+    const int middle = first + half_len;
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, middle);
+    const int middle_object = kdistribution->mesh_light.object_id;
+
+    if (middle_object < object || (middle_object == object && kdistribution->prim < prim)) {
+      first = middle + 1;
+      len = len - half_len - 1;
+    }
+    else {
+      len = half_len;
+    }
+  }
+
+  const int num_triangles = kernel_data.integrator.num_distribution -
+                            kernel_data.integrator.num_all_lights;
+  if (first < num_triangles) {
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, first);
+    if (kdistribution->mesh_light.object_id == object && kdistribution->prim == prim) {
+      return first;
+    }
+  }
+
+  return -1;
+}
+
+/* Selection probability of a mesh light triangle divided by its area, the light tree
+ * counterpart of pdf_triangles. */
+ccl_device float light_tree_triangle_pdf_area(KernelGlobals *kg,
+                                              const float3 P,
+                                              int object,
+                                              int prim)
+{
+  const int index = light_tree_triangle_index(kg, object, prim);
+  if (index < 0) {
+    return 0.0f;
+  }
+
+  const float area = kernel_tex_fetch(__light_tree_emitters, index).area;
+  return (area > 0.0f) ? light_tree_pdf(kg, P, index) / area : 0.0f;
+}
+
+CCL_NAMESPACE_END
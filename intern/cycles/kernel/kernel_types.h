@@ -1389,6 +1389,12 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
+  /* light tree */
+  int use_light_tree;
+  int light_tree_num_infinite;
+  int light_tree_infinite_offset;
+  float light_tree_pdf_local;
+
   int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
@@ -1550,6 +1556,36 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+typedef struct KernelLightTreeNode {
+  /* Bounds and estimated power of the emitters in the node. */
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  /* Bounding cone of the emitter normals, and the angle light spreads out from them. */
+  float theta_o;
+  float axis[3];
+  float theta_e;
+  /* Index of the second child for interior nodes, the first child directly follows the node.
+   * For leaves the index of the first emitter in __light_tree_leaf_emitters. */
+  int child_index;
+  /* Number of emitters in a leaf, zero for interior nodes. */
+  int num_emitters;
+  int parent_index;
+  int two_sided;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  /* Leaf containing the emitter, -1 for distant and background lights and -2 for emitters
+   * that are not part of the tree. */
+  int leaf_index;
+  float energy;
+  /* Area of mesh light triangles. */
+  float area;
+  float pad;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -23,6 +23,8 @@
 #  include <nanovdb/util/SampleFromVoxels.h>
 #endif
 
+#include "render/texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -588,6 +590,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.cache_image) {
+    const float zero[2] = {0.0f, 0.0f};
+    float4 result;
+    texture_cache_lookup((const TextureCacheImage *)info.cache_image, x, y, zero, zero, &result.x);
+    return result;
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -612,6 +621,22 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Lookup with texture coordinate derivatives, for filtering of images in the texture cache. */
+ccl_device float4
+kernel_tex_image_interp_filtered(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.cache_image) {
+    float4 result;
+    texture_cache_lookup(
+        (const TextureCacheImage *)info.cache_image, x, y, &dx.x, &dy.x, &result.x);
+    return result;
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
@@ -241,6 +241,7 @@ void Geometry::compute_bvh(
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.background = params->background;
       bparams.curve_subdivisions = params->curve_subdivisions();
 
       delete bvh;
@@ -1103,26 +1104,37 @@ void GeometryManager::device_update_mesh(
                                dscene->tri_patch.need_realloc() ||
                                dscene->tri_patch_uv.need_realloc();
 
+    /* A rebuilt BVH2 reorders the triangle vertices the vertex indices point to. */
+    const bool prim_tri_index_modified = !for_displacement &&
+                                         dscene->prim_tri_index.is_modified();
+
     foreach (Geometry *geom, scene->geometry) {
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
         Mesh *mesh = static_cast<Mesh *>(geom);
 
+        /* Only the ranges of modified meshes are copied to the device again. */
         if (mesh->shader_is_modified() || mesh->smooth_is_modified() ||
             mesh->triangles_is_modified() || copy_all_data) {
           mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+          dscene->tri_shader.tag_modified(mesh->prim_offset, mesh->num_triangles());
         }
 
         if (mesh->verts_is_modified() || copy_all_data) {
           mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          dscene->tri_vnormal.tag_modified(mesh->vert_offset, mesh->verts.size());
         }
 
-        if (mesh->triangles_is_modified() || mesh->vert_patch_uv_is_modified() || copy_all_data) {
+        if (mesh->triangles_is_modified() || mesh->vert_patch_uv_is_modified() || copy_all_data ||
+            prim_tri_index_modified) {
           mesh->pack_verts(tri_prim_index,
                            &tri_vindex[mesh->prim_offset],
                            &tri_patch[mesh->prim_offset],
                            &tri_patch_uv[mesh->vert_offset],
                            mesh->vert_offset,
                            mesh->prim_offset);
+          dscene->tri_vindex.tag_modified(mesh->prim_offset, mesh->num_triangles());
+          dscene->tri_patch.tag_modified(mesh->prim_offset, mesh->num_triangles());
+          dscene->tri_patch_uv.tag_modified(mesh->vert_offset, mesh->verts.size());
         }
 
         if (progress.get_cancel())
@@ -1165,6 +1177,8 @@ void GeometryManager::device_update_mesh(
                           &curve_keys[hair->curvekey_offset],
                           &curves[hair->prim_offset],
                           hair->curvekey_offset);
+        dscene->curve_keys.tag_modified(hair->curvekey_offset, hair->get_curve_keys().size());
+        dscene->curves.tag_modified(hair->prim_offset, hair->num_curves());
         if (progress.get_cancel())
           return;
       }
@@ -1236,12 +1250,22 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.background = scene->params.background;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
+  /* The scene BVH is freed when primitives are added or removed. BVH2 and Embree are only
+   * refitted when geometry deformed, as the quality of the tree degrades too much when objects
+   * move around. Changes in visibility are not refitted by Embree. */
+  const bool deformation_only = (update_flags & (TRANSFORM_MODIFIED | VISIBILITY_MODIFIED)) == 0;
   const bool can_refit = scene->bvh != nullptr &&
-                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX);
+                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
+                          (deformation_only && (bparams.bvh_layout == BVH_LAYOUT_BVH2 ||
+                                                bparams.bvh_layout == BVH_LAYOUT_EMBREE)));
+  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
+
+  VLOG(1) << (can_refit ? "Refitting" : "Building") << " scene BVH.";
 
   PackFlags pack_flags = PackFlags::PACK_NONE;
 
@@ -1258,14 +1282,35 @@ void GeometryManager::device_update_bvh(Device *device,
     bvh = scene->bvh = BVH::create(bparams, scene->geometry, scene->objects, device);
   }
 
-  device->build_bvh(bvh, progress, can_refit);
+  if (can_refit && has_bvh2_layout) {
+    /* Take back the packed BVH handed over to the device arrays, to refit it in place. */
+    PackedBVH &bvh2_pack = static_cast<BVH2 *>(bvh)->pack;
+    dscene->bvh_nodes.give_data(bvh2_pack.nodes);
+    dscene->bvh_leaf_nodes.give_data(bvh2_pack.leaf_nodes);
+    dscene->object_node.give_data(bvh2_pack.object_node);
+    dscene->prim_tri_index.give_data(bvh2_pack.prim_tri_index);
+    dscene->prim_tri_verts.give_data(bvh2_pack.prim_tri_verts);
+    dscene->prim_type.give_data(bvh2_pack.prim_type);
+    dscene->prim_visibility.give_data(bvh2_pack.prim_visibility);
+    dscene->prim_index.give_data(bvh2_pack.prim_index);
+    dscene->prim_object.give_data(bvh2_pack.prim_object);
+    dscene->prim_time.give_data(bvh2_pack.prim_time);
+    bvh2_pack.root_index = dscene->data.bvh.root;
+  }
+
+  {
+    scoped_callback_timer timer([scene, can_refit](double time) {
+      if (scene->update_stats && can_refit) {
+        scene->update_stats->geometry.times.add_entry({"device_update (refit scene BVH)", time});
+      }
+    });
+    device->build_bvh(bvh, progress, can_refit);
+  }
 
   if (progress.get_cancel()) {
     return;
   }
 
-  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
-
   PackedBVH pack;
   if (has_bvh2_layout) {
     pack = std::move(static_cast<BVH2 *>(bvh)->pack);
@@ -1291,11 +1336,12 @@ void GeometryManager::device_update_bvh(Device *device,
 
     if (pack_flags != PackFlags::PACK_ALL) {
       /* if we do not need to recreate the BVH, then only the vertices are updated, so we can
-       * safely retake the memory */
-      dscene->prim_tri_verts.give_data(pack.prim_tri_verts);
+       * safely update the memory in place, keeping the device memory to only copy the ranges of
+       * modified geometry */
+      dscene->prim_tri_verts.lend_data(pack.prim_tri_verts);
 
       if ((pack_flags & PackFlags::PACK_VISIBILITY) != 0) {
-        dscene->prim_visibility.give_data(pack.prim_visibility);
+        dscene->prim_visibility.lend_data(pack.prim_visibility);
       }
     }
     else {
@@ -1331,6 +1377,12 @@ void GeometryManager::device_update_bvh(Device *device,
 
       if (geom->is_modified()) {
         geom_pack_flags |= PackFlags::PACK_VERTICES;
+
+        if (pack_flags != PackFlags::PACK_ALL &&
+            (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME)) {
+          Mesh *mesh = static_cast<Mesh *>(geom);
+          dscene->prim_tri_verts.tag_modified(mesh->prim_offset * 3, mesh->num_triangles() * 3);
+        }
       }
 
       if (geom_pack_flags == PACK_NONE) {
@@ -1342,6 +1394,16 @@ void GeometryManager::device_update_bvh(Device *device,
           &Geometry::pack_primitives, geom, &pack, info.first, info.second, geom_pack_flags));
     }
     pool.wait_work();
+
+    if (pack_flags != PackFlags::PACK_ALL) {
+      dscene->prim_tri_verts.take_back_data(pack.prim_tri_verts);
+      dscene->prim_tri_verts.copy_to_device_if_modified();
+
+      if ((pack_flags & PackFlags::PACK_VISIBILITY) != 0) {
+        dscene->prim_visibility.take_back_data(pack.prim_visibility);
+        dscene->prim_visibility.copy_to_device_if_modified();
+      }
+    }
   }
 
   /* copy to device */
@@ -1365,6 +1427,11 @@ void GeometryManager::device_update_bvh(Device *device,
   if (pack.prim_tri_index.size() && (dscene->prim_tri_index.need_realloc() || has_bvh2_layout)) {
     dscene->prim_tri_index.steal_data(pack.prim_tri_index);
     dscene->prim_tri_index.copy_to_device();
+
+    if (!can_refit) {
+      /* Let device_update_mesh() know the triangle vertices moved. */
+      dscene->prim_tri_index.tag_modified();
+    }
   }
   if (pack.prim_tri_verts.size()) {
     dscene->prim_tri_verts.steal_data(pack.prim_tri_verts);
@@ -1401,9 +1468,6 @@ void GeometryManager::device_update_bvh(Device *device,
 /* Set of flags used to help determining what data has been modified or needs reallocation, so we
  * can decide which device data to free or update. */
 enum {
-  DEVICE_CURVE_DATA_MODIFIED = (1 << 0),
-  DEVICE_MESH_DATA_MODIFIED = (1 << 1),
-
   ATTR_FLOAT_MODIFIED = (1 << 2),
   ATTR_FLOAT2_MODIFIED = (1 << 3),
   ATTR_FLOAT3_MODIFIED = (1 << 4),
@@ -1564,9 +1628,6 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
       if (hair->need_update_rebuild) {
         device_update_flags |= DEVICE_CURVE_DATA_NEEDS_REALLOC;
       }
-      else if (hair->is_modified()) {
-        device_update_flags |= DEVICE_CURVE_DATA_MODIFIED;
-      }
     }
 
     if (geom->is_mesh()) {
@@ -1575,9 +1636,6 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
       if (mesh->need_update_rebuild) {
         device_update_flags |= DEVICE_MESH_DATA_NEEDS_REALLOC;
       }
-      else if (mesh->is_modified()) {
-        device_update_flags |= DEVICE_MESH_DATA_MODIFIED;
-      }
     }
   }
 
@@ -1658,17 +1716,9 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->attributes_uchar4.tag_modified();
   }
 
-  if (device_update_flags & DEVICE_MESH_DATA_MODIFIED) {
-    /* if anything else than vertices or shaders are modified, we would need to reallocate, so
-     * these are the only arrays that can be updated */
-    dscene->tri_vnormal.tag_modified();
-    dscene->tri_shader.tag_modified();
-  }
-
-  if (device_update_flags & DEVICE_CURVE_DATA_MODIFIED) {
-    dscene->curve_keys.tag_modified();
-    dscene->curves.tag_modified();
-  }
+  /* If anything else than vertices or shaders of meshes and curves are modified, we would need to
+   * reallocate. Those are repacked by device_update_mesh(), which tags their ranges in the device
+   * arrays so only they are copied. */
 
   need_flags_update = false;
 }
@@ -17,6 +17,7 @@
 #include "render/graph.h"
 #include "render/attribute.h"
 #include "render/constant_fold.h"
+#include "render/image.h"
 #include "render/nodes.h"
 #include "render/scene.h"
 #include "render/shader.h"
@@ -366,6 +367,10 @@ void ShaderGraph::simplify(Scene *scene)
     clean(scene);
     refine_bump_nodes();
 
+    if (scene->image_manager->use_texture_cache() && !scene->shader_manager->use_osl()) {
+      refine_image_differentials();
+    }
+
     simplified = true;
   }
 }
@@ -954,6 +959,60 @@ void ShaderGraph::refine_bump_nodes()
   }
 }
 
+void ShaderGraph::refine_image_differentials()
+{
+  /* Image textures read through the texture cache need the derivatives of their texture
+   * coordinates for filtering and MIP level selection. Like for bump nodes, the sub-graph from
+   * the "Vector" input is copied twice with texture coordinates shifted by the ray differentials,
+   * and connected to the "VectorDX" and "VectorDY" inputs. The copies are shared by all image
+   * textures using the same texture coordinate. */
+  vector<ShaderNode *> image_nodes;
+
+  foreach (ShaderNode *node, nodes) {
+    if (node->type == ImageTextureNode::get_node_type() && node->bump == SHADER_BUMP_NONE &&
+        node->input("Vector")->link) {
+      ImageTextureNode *image_node = static_cast<ImageTextureNode *>(node);
+      if (image_node->get_projection() != NODE_IMAGE_PROJ_BOX) {
+        image_nodes.push_back(node);
+      }
+    }
+  }
+
+  map<ShaderOutput *, pair<ShaderOutput *, ShaderOutput *>> differentials;
+
+  foreach (ShaderNode *node, image_nodes) {
+    ShaderInput *vector_in = node->input("Vector");
+    ShaderOutput *out = vector_in->link;
+
+    if (differentials.find(out) == differentials.end()) {
+      ShaderNodeSet nodes_vector;
+      ShaderNodeMap nodes_dx;
+      ShaderNodeMap nodes_dy;
+
+      find_dependencies(nodes_vector, vector_in);
+
+      copy_nodes(nodes_vector, nodes_dx);
+      copy_nodes(nodes_vector, nodes_dy);
+
+      foreach (NodePair &pair, nodes_dx) {
+        pair.second->bump = SHADER_BUMP_DX;
+        add(pair.second);
+      }
+      foreach (NodePair &pair, nodes_dy) {
+        pair.second->bump = SHADER_BUMP_DY;
+        add(pair.second);
+      }
+
+      ShaderOutput *out_dx = nodes_dx[out->parent]->output(out->name());
+      ShaderOutput *out_dy = nodes_dy[out->parent]->output(out->name());
+      differentials[out] = pair<ShaderOutput *, ShaderOutput *>(out_dx, out_dy);
+    }
+
+    connect(differentials[out].first, node->input("VectorDX"));
+    connect(differentials[out].second, node->input("VectorDY"));
+  }
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
   /* generate bump mapping automatically from displacement. bump mapping is
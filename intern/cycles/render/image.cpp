@@ -21,6 +21,7 @@
 #include "render/image_vdb.h"
 #include "render/scene.h"
 #include "render/stats.h"
+#include "render/texture_cache.h"
 
 #include "util/util_foreach.h"
 #include "util/util_image.h"
@@ -318,6 +319,16 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+void ImageManager::set_texture_cache(int max_memory_mb)
+{
+  texture_cache.reset(new TextureCache(max_memory_mb));
+}
+
+bool ImageManager::use_texture_cache() const
+{
+  return (bool)texture_cache;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -444,6 +455,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_image = NULL;
 
   images[slot] = img;
 
@@ -642,6 +654,35 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+bool ImageManager::texture_cache_load_image(Image *img)
+{
+  if (!texture_cache) {
+    return false;
+  }
+
+  /* Only 2D images read from files, the texture system can not read packed or generated images.
+   * Alpha is always associated by the texture system, so images where it must be left untouched
+   * are loaded completely. */
+  const ustring filepath = img->loader->osl_filepath();
+  if (filepath.empty() || img->metadata.depth > 1 || img->metadata.channels < 1) {
+    return false;
+  }
+  /* Tiles are filtered as they are stored in the file. Images that need conversion to scene
+   * linear are loaded completely, so the conversion is done before filtering and only once. The
+   * kernel decodes sRGB images itself. */
+  if (img->metadata.colorspace != u_colorspace_raw &&
+      img->metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  const bool has_alpha = (img->metadata.channels == 2 || img->metadata.channels == 4);
+  if (has_alpha && !image_associate_alpha(img)) {
+    return false;
+  }
+
+  img->cache_image = texture_cache->add_image(filepath.string(), img->params);
+  return (img->cache_image != NULL);
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -666,6 +707,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+    img->cache_image = NULL;
+  }
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
@@ -673,7 +718,15 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache_load_image(img)) {
+    /* Pixels are read by the kernel through the texture cache, only allocate a placeholder so
+     * that the texture slot is valid. */
+    thread_scoped_lock device_lock(device_mutex);
+    void *pixels = img->mem->alloc(1, 1);
+    memset(pixels, 0, img->mem->memory_size());
+    img->mem->info.cache_image = (uint64_t)img->cache_image;
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -799,6 +852,10 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -890,6 +947,10 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    texture_cache->collect_statistics(stats);
+  }
 }
 
 void ImageManager::tag_update()
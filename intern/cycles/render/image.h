@@ -39,7 +39,9 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class TextureCache;
 class VDBImageLoader;
+struct TextureCacheImage;
 
 /* Image Parameters */
 class ImageParams {
@@ -192,6 +194,8 @@ class ImageManager {
   void device_free_builtin(Device *device);
 
   void set_osl_texture_system(void *texture_system);
+  void set_texture_cache(int max_memory_mb);
+  bool use_texture_cache() const;
   bool set_animation_frame_update(int frame);
 
   void collect_statistics(RenderStats *stats);
@@ -212,6 +216,8 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    /* Image read on demand through the texture cache, NULL when fully loaded. */
+    TextureCacheImage *cache_image;
 
     int users;
     thread_mutex mutex;
@@ -228,6 +234,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  unique_ptr<TextureCache> texture_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
@@ -237,6 +244,7 @@ class ImageManager {
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
+  bool texture_cache_load_image(Image *img);
 
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
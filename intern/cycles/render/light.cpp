@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -30,6 +31,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
@@ -256,6 +258,70 @@ void LightManager::test_enabled_lights(Scene *scene)
   }
 }
 
+bool LightManager::use_light_tree(Device *device, Scene *scene)
+{
+  Integrator *integrator = scene->integrator;
+  if (!integrator->get_use_light_tree()) {
+    return false;
+  }
+
+  /* Sampling all lights in branched path tracing relies on the distribution. */
+  const bool sample_all_lights = integrator->get_sample_all_lights_direct() ||
+                                 integrator->get_sample_all_lights_indirect();
+  return !(integrator->get_method() == Integrator::BRANCHED_PATH &&
+           device->info.has_branched_path && sample_all_lights);
+}
+
+/* Estimate of the power emitted by a shader, to importance sample the light tree. Emission that
+ * is not constant is assumed to be of unit strength. */
+static float light_tree_shader_energy(Shader *shader, unordered_map<Shader *, float> &cache)
+{
+  unordered_map<Shader *, float>::iterator it = cache.find(shader);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  float3 emission;
+  const float energy = (shader->is_constant_emission(&emission)) ? average(fabs(emission)) :
+                                                                   1.0f;
+  cache[shader] = energy;
+  return energy;
+}
+
+/* Bounds, orientation and power of a lamp with a position. */
+static LightTreeEmitter light_tree_lamp_emitter(Light *light, float shader_energy)
+{
+  LightTreeEmitter emitter;
+  const float3 co = light->get_co();
+  const float3 dir = safe_normalize(light->get_dir());
+
+  if (light->get_light_type() == LIGHT_AREA) {
+    const float3 axisu = light->get_axisu() * (light->get_sizeu() * light->get_size());
+    const float3 axisv = light->get_axisv() * (light->get_sizev() * light->get_size());
+    emitter.bbox = BoundBox::empty;
+    emitter.bbox.grow(co - 0.5f * axisu - 0.5f * axisv);
+    emitter.bbox.grow(co + 0.5f * axisu - 0.5f * axisv);
+    emitter.bbox.grow(co - 0.5f * axisu + 0.5f * axisv);
+    emitter.bbox.grow(co + 0.5f * axisu + 0.5f * axisv);
+    const float theta_e = min(0.5f * light->get_spread(), M_PI_2_F);
+    emitter.cone = LightTreeCone(dir, 0.0f, theta_e, false);
+  }
+  else {
+    const float radius = light->get_size();
+    emitter.bbox = BoundBox(co - make_float3(radius), co + make_float3(radius));
+    if (light->get_light_type() == LIGHT_SPOT) {
+      emitter.cone = LightTreeCone(dir, 0.0f, 0.5f * light->get_spot_angle(), false);
+    }
+    else {
+      emitter.cone = LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F, false);
+    }
+  }
+
+  emitter.centroid = emitter.bbox.center();
+  emitter.energy = average(fabs(light->get_strength())) * shader_energy;
+  return emitter;
+}
+
 bool LightManager::object_usable_as_light(Object *object)
 {
   Geometry *geom = object->get_geometry();
@@ -284,7 +350,7 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
@@ -338,6 +404,23 @@ void LightManager::device_update_distribution(Device *,
   KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
   float totarea = 0.0f;
 
+  /* light tree emitters, indexed like the distribution */
+  const bool use_tree = use_light_tree(device, scene) && num_distribution > 0;
+  KernelLightTreeEmitter *tree_emitters = NULL;
+  vector<LightTreeEmitter> local_emitters;
+  vector<uint> infinite_emitters;
+  unordered_map<Shader *, float> shader_energy;
+
+  if (use_tree) {
+    tree_emitters = dscene->light_tree_emitters.alloc(num_distribution);
+    for (size_t i = 0; i < num_distribution; i++) {
+      tree_emitters[i].leaf_index = -2;
+      tree_emitters[i].energy = 0.0f;
+      tree_emitters[i].area = 0.0f;
+      tree_emitters[i].pad = 0.0f;
+    }
+  }
+
   /* triangles */
   size_t offset = 0;
   int j = 0;
@@ -402,7 +485,26 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_tree) {
+          LightTreeEmitter emitter;
+          emitter.distribution_index = offset - 1;
+          emitter.bbox = BoundBox::empty;
+          emitter.bbox.grow(p1);
+          emitter.bbox.grow(p2);
+          emitter.bbox.grow(p3);
+          emitter.centroid = (p1 + p2 + p3) * (1.0f / 3.0f);
+          emitter.cone = LightTreeCone(
+              safe_normalize(cross(p2 - p1, p3 - p1)), 0.0f, M_PI_2_F, true);
+          emitter.energy = area * light_tree_shader_energy(shader, shader_energy);
+
+          tree_emitters[emitter.distribution_index].area = area;
+          if (emitter.energy > 0.0f) {
+            local_emitters.push_back(emitter);
+          }
+        }
       }
     }
 
@@ -426,6 +528,21 @@ void LightManager::device_update_distribution(Device *,
     distribution[offset].lamp.size = light->size;
     totarea += lightarea;
 
+    if (use_tree) {
+      if (light->light_type == LIGHT_DISTANT || light->light_type == LIGHT_BACKGROUND) {
+        infinite_emitters.push_back(offset);
+      }
+      else {
+        Shader *shader = (light->shader) ? light->shader : scene->default_light;
+        LightTreeEmitter emitter = light_tree_lamp_emitter(
+            light, light_tree_shader_energy(shader, shader_energy));
+        emitter.distribution_index = offset;
+        if (emitter.energy > 0.0f) {
+          local_emitters.push_back(emitter);
+        }
+      }
+    }
+
     if (light->light_type == LIGHT_DISTANT) {
       use_lamp_mis |= (light->angle > 0.0f && light->use_mis);
     }
@@ -490,6 +607,17 @@ void LightManager::device_update_distribution(Device *,
 
     kintegrator->use_lamp_mis = use_lamp_mis;
 
+    /* Light tree */
+    kintegrator->use_light_tree = use_tree;
+    kintegrator->light_tree_num_infinite = 0;
+    kintegrator->light_tree_infinite_offset = 0;
+    kintegrator->light_tree_pdf_local = 0.0f;
+
+    if (use_tree) {
+      kintegrator->use_light_tree = device_update_light_tree(
+          dscene, local_emitters, infinite_emitters, tree_emitters);
+    }
+
     /* bit of an ugly hack to compensate for emitting triangles influencing
      * amount of samples we get for this pass */
     kfilm->pass_shadow_scale = 1.0f;
@@ -520,12 +648,17 @@ void LightManager::device_update_distribution(Device *,
   }
   else {
     dscene->light_distribution.free();
+    dscene->light_tree_emitters.free();
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
+    kintegrator->light_tree_num_infinite = 0;
+    kintegrator->light_tree_infinite_offset = 0;
+    kintegrator->light_tree_pdf_local = 0.0f;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -537,6 +670,66 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+bool LightManager::device_update_light_tree(DeviceScene *dscene,
+                                            vector<LightTreeEmitter> &local_emitters,
+                                            const vector<uint> &infinite_emitters,
+                                            KernelLightTreeEmitter *tree_emitters)
+{
+  const size_t num_local = local_emitters.size();
+  const size_t num_infinite = infinite_emitters.size();
+
+  if (num_local + num_infinite == 0) {
+    /* Nothing emits light, fall back to the distribution. */
+    dscene->light_tree_emitters.free();
+    return false;
+  }
+
+  LightTree tree(local_emitters);
+  VLOG(1) << "Light tree with " << tree.nodes.size() << " nodes for " << num_local
+          << " emitters.";
+
+  /* Nodes, the kernel does not access them when there are only infinite lights. */
+  KernelLightTreeNode *nodes = dscene->light_tree_nodes.alloc(max(tree.nodes.size(), (size_t)1));
+  memset(nodes, 0, sizeof(KernelLightTreeNode));
+  if (!tree.nodes.empty()) {
+    memcpy(nodes, tree.nodes.data(), sizeof(KernelLightTreeNode) * tree.nodes.size());
+  }
+
+  /* Emitters in the order of the leaves, followed by distant and background lights. */
+  uint *leaf_emitters = dscene->light_tree_leaf_emitters.alloc(num_local + num_infinite);
+
+  for (size_t i = 0; i < num_local; i++) {
+    const LightTreeEmitter &emitter = local_emitters[i];
+    leaf_emitters[i] = emitter.distribution_index;
+    tree_emitters[emitter.distribution_index].leaf_index = tree.emitter_leaf[i];
+    tree_emitters[emitter.distribution_index].energy = emitter.energy;
+  }
+
+  for (size_t i = 0; i < num_infinite; i++) {
+    leaf_emitters[num_local + i] = infinite_emitters[i];
+    tree_emitters[infinite_emitters[i]].leaf_index = -1;
+  }
+
+  /* Infinite lights can not be placed in the tree, so half of the samples go to them when there
+   * are local lights as well. pdf_lights is the probability of selecting each of them. */
+  float pdf_local = (num_local > 0) ? 1.0f : 0.0f;
+  if (num_local > 0 && num_infinite > 0) {
+    pdf_local = 0.5f;
+  }
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->light_tree_num_infinite = num_infinite;
+  kintegrator->light_tree_infinite_offset = num_local;
+  kintegrator->light_tree_pdf_local = pdf_local;
+  kintegrator->pdf_lights = (num_infinite > 0) ? (1.0f - pdf_local) / num_infinite : 0.0f;
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_tree_leaf_emitters.copy_to_device();
+
+  return true;
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -1026,6 +1219,9 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_leaf_emitters.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -34,6 +34,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+struct LightTreeEmitter;
 class Object;
 class Progress;
 class Scene;
@@ -101,6 +102,7 @@ class LightManager {
     OBJECT_MANAGER = (1 << 5),
     SHADER_COMPILED = (1 << 6),
     SHADER_MODIFIED = (1 << 7),
+    LIGHT_TREE_MODIFIED = (1 << 8),
 
     /* tag everything in the manager for an update */
     UPDATE_ALL = ~0u,
@@ -138,6 +140,9 @@ class LightManager {
    */
   void test_enabled_lights(Scene *scene);
 
+  /* Check whether lights are selected with the light tree rather than the distribution. */
+  bool use_light_tree(Device *device, Scene *scene);
+
   void device_update_points(Device *device, DeviceScene *dscene, Scene *scene);
   void device_update_distribution(Device *device,
                                   DeviceScene *dscene,
@@ -148,6 +153,10 @@ class LightManager {
                                 Scene *scene,
                                 Progress &progress);
   void device_update_ies(DeviceScene *dscene);
+  bool device_update_light_tree(DeviceScene *dscene,
+                                vector<LightTreeEmitter> &local_emitters,
+                                const vector<uint> &infinite_emitters,
+                                KernelLightTreeEmitter *tree_emitters);
 
   /* Check whether light manager can use the object as a light-emissive. */
   bool object_usable_as_light(Object *object);
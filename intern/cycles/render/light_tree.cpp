@@ -0,0 +1,297 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Emitters with coincident centroids are kept in a single leaf up to this number. */
+static const int LIGHT_TREE_MAX_LEAF_SIZE = 8;
+/* Beyond this depth nodes are split at the median, to bound the recursion. */
+static const int LIGHT_TREE_MAX_DEPTH = 64;
+static const int LIGHT_TREE_NUM_BINS = 12;
+
+/* Cone */
+
+float LightTreeCone::measure() const
+{
+  /* Measure of the directions the emitters can send light into, from "Importance Sampling of
+   * Many Lights with Adaptive Tree Splitting". */
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_o = cosf(theta_o);
+  const float sin_o = sinf(theta_o);
+  const float m = M_2PI_F * (1.0f - cos_o) +
+                  M_PI_2_F * (2.0f * theta_w * sin_o - cosf(theta_o - 2.0f * theta_w) -
+                              2.0f * theta_o * sin_o + cos_o);
+  return (two_sided) ? 2.0f * m : m;
+}
+
+LightTreeCone merge(const LightTreeCone &cone_a, const LightTreeCone &cone_b)
+{
+  if (cone_a.is_empty) {
+    return cone_b;
+  }
+  if (cone_b.is_empty) {
+    return cone_a;
+  }
+
+  LightTreeCone a = cone_a;
+  LightTreeCone b = cone_b;
+  const bool two_sided = a.two_sided || b.two_sided;
+
+  /* Two sided cones may as well point into the same hemisphere. */
+  if (two_sided && dot(a.axis, b.axis) < 0.0f) {
+    b.axis = -b.axis;
+  }
+  if (b.theta_o > a.theta_o) {
+    swap(a, b);
+  }
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  const float theta_e = max(a.theta_e, b.theta_e);
+  const float max_theta_o = (two_sided) ? M_PI_2_F : M_PI_F;
+
+  /* Cone a contains cone b. */
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeCone(a.axis, min(a.theta_o, max_theta_o), theta_e, two_sided);
+  }
+
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  if (theta_o >= max_theta_o) {
+    return LightTreeCone(a.axis, max_theta_o, theta_e, two_sided);
+  }
+
+  /* Rotate the axis of a towards b, to the middle of the merged cone. */
+  const float theta_r = theta_o - a.theta_o;
+  float3 ortho = b.axis - dot(a.axis, b.axis) * a.axis;
+  if (len_squared(ortho) < 1e-12f) {
+    float3 unused;
+    make_orthonormals(a.axis, &ortho, &unused);
+  }
+  const float3 axis = normalize(cosf(theta_r) * a.axis + sinf(theta_r) * normalize(ortho));
+
+  return LightTreeCone(axis, theta_o, theta_e, two_sided);
+}
+
+/* Split cost */
+
+namespace {
+
+struct LightTreeBin {
+  BoundBox bbox;
+  LightTreeCone cone;
+  float energy;
+  int num_emitters;
+
+  LightTreeBin() : bbox(BoundBox::empty), energy(0.0f), num_emitters(0)
+  {
+  }
+
+  void grow(const LightTreeEmitter &emitter)
+  {
+    bbox.grow(emitter.bbox);
+    cone = merge(cone, emitter.cone);
+    energy += emitter.energy;
+    num_emitters++;
+  }
+
+  void grow(const LightTreeBin &other)
+  {
+    bbox.grow(other.bbox);
+    cone = merge(cone, other.cone);
+    energy += other.energy;
+    num_emitters += other.num_emitters;
+  }
+
+  /* Surface area heuristic weighted by energy and orientation. The squared diagonal stands in
+   * for the surface area, as bounds of point lights are often flat or degenerate. */
+  float cost() const
+  {
+    return energy * len_squared(bbox.size()) * cone.measure();
+  }
+};
+
+}  // namespace
+
+/* Light Tree */
+
+LightTree::LightTree(vector<LightTreeEmitter> &emitters)
+{
+  if (emitters.empty()) {
+    return;
+  }
+
+  nodes.reserve(2 * emitters.size());
+  emitter_leaf.resize(emitters.size());
+  recursive_build(emitters, 0, emitters.size(), -1, 0);
+}
+
+int LightTree::recursive_build(
+    vector<LightTreeEmitter> &emitters, int start, int end, int parent_index, int depth)
+{
+  BoundBox bbox = BoundBox::empty;
+  BoundBox centroid_bbox = BoundBox::empty;
+  LightTreeCone cone;
+  float energy = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    bbox.grow(emitters[i].bbox);
+    centroid_bbox.grow(emitters[i].centroid);
+    cone = merge(cone, emitters[i].cone);
+    energy += emitters[i].energy;
+  }
+
+  const int node_index = nodes.size();
+  KernelLightTreeNode knode = {};
+  knode.bbox_min[0] = bbox.min.x;
+  knode.bbox_min[1] = bbox.min.y;
+  knode.bbox_min[2] = bbox.min.z;
+  knode.energy = energy;
+  knode.bbox_max[0] = bbox.max.x;
+  knode.bbox_max[1] = bbox.max.y;
+  knode.bbox_max[2] = bbox.max.z;
+  knode.theta_o = cone.theta_o;
+  knode.axis[0] = cone.axis.x;
+  knode.axis[1] = cone.axis.y;
+  knode.axis[2] = cone.axis.z;
+  knode.theta_e = cone.theta_e;
+  knode.parent_index = parent_index;
+  knode.two_sided = cone.two_sided;
+  nodes.push_back(knode);
+
+  const int split = (end - start > 1) ?
+                        find_split(emitters, start, end, bbox, centroid_bbox, depth) :
+                        -1;
+
+  if (split == -1) {
+    nodes[node_index].child_index = start;
+    nodes[node_index].num_emitters = end - start;
+    for (int i = start; i < end; i++) {
+      emitter_leaf[i] = node_index;
+    }
+  }
+  else {
+    recursive_build(emitters, start, split, node_index, depth + 1);
+    const int right_index = recursive_build(emitters, split, end, node_index, depth + 1);
+    nodes[node_index].child_index = right_index;
+  }
+
+  return node_index;
+}
+
+int LightTree::find_split(vector<LightTreeEmitter> &emitters,
+                          int start,
+                          int end,
+                          const BoundBox &bbox,
+                          const BoundBox &centroid_bbox,
+                          int depth)
+{
+  const int num_emitters = end - start;
+  const float3 centroid_extent = centroid_bbox.size();
+  const int middle = start + num_emitters / 2;
+
+  /* Emitters at the same position can not be told apart by splitting. */
+  if (max3(centroid_extent) == 0.0f) {
+    return (num_emitters <= LIGHT_TREE_MAX_LEAF_SIZE) ? -1 : middle;
+  }
+
+  if (depth >= LIGHT_TREE_MAX_DEPTH) {
+    const int axis = (centroid_extent.x >= centroid_extent.y) ?
+                         ((centroid_extent.x >= centroid_extent.z) ? 0 : 2) :
+                         ((centroid_extent.y >= centroid_extent.z) ? 1 : 2);
+    std::nth_element(emitters.begin() + start,
+                     emitters.begin() + middle,
+                     emitters.begin() + end,
+                     [axis](const LightTreeEmitter &a, const LightTreeEmitter &b) {
+                       return a.centroid[axis] < b.centroid[axis];
+                     });
+    return middle;
+  }
+
+  /* Binned split along each axis, minimizing the cost of both sides. */
+  const float max_extent = max3(bbox.size());
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  int best_bin = -1;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (centroid_extent[axis] == 0.0f) {
+      continue;
+    }
+
+    const float inv_extent = LIGHT_TREE_NUM_BINS / centroid_extent[axis];
+    LightTreeBin bins[LIGHT_TREE_NUM_BINS];
+
+    for (int i = start; i < end; i++) {
+      const int bin = clamp(
+          (int)((emitters[i].centroid[axis] - centroid_bbox.min[axis]) * inv_extent),
+          0,
+          LIGHT_TREE_NUM_BINS - 1);
+      bins[bin].grow(emitters[i]);
+    }
+
+    float right_cost[LIGHT_TREE_NUM_BINS];
+    int right_num_emitters[LIGHT_TREE_NUM_BINS];
+    LightTreeBin right;
+    for (int bin = LIGHT_TREE_NUM_BINS - 1; bin > 0; bin--) {
+      right.grow(bins[bin]);
+      right_cost[bin] = right.cost();
+      right_num_emitters[bin] = right.num_emitters;
+    }
+
+    /* Favor splitting along the longest axis of the bounds. */
+    const float regularization = max_extent / max(bbox.size()[axis], 1e-12f);
+
+    LightTreeBin left;
+    for (int bin = 0; bin < LIGHT_TREE_NUM_BINS - 1; bin++) {
+      left.grow(bins[bin]);
+      if (left.num_emitters == 0 || right_num_emitters[bin + 1] == 0) {
+        continue;
+      }
+
+      const float cost = regularization * (left.cost() + right_cost[bin + 1]);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = bin;
+      }
+    }
+  }
+
+  if (best_axis == -1) {
+    return middle;
+  }
+
+  const float inv_extent = LIGHT_TREE_NUM_BINS / centroid_extent[best_axis];
+  const float min_centroid = centroid_bbox.min[best_axis];
+  vector<LightTreeEmitter>::iterator split = std::partition(
+      emitters.begin() + start,
+      emitters.begin() + end,
+      [best_axis, best_bin, inv_extent, min_centroid](const LightTreeEmitter &emitter) {
+        const int bin = clamp((int)((emitter.centroid[best_axis] - min_centroid) * inv_extent),
+                              0,
+                              LIGHT_TREE_NUM_BINS - 1);
+        return bin <= best_bin;
+      });
+
+  const int split_index = split - emitters.begin();
+  return (split_index == start || split_index == end) ? middle : split_index;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone bounding the normals of emitters, and the angle around the normals light is emitted in.
+ * Two sided cones also bound the flipped normals. */
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+  bool two_sided;
+  bool is_empty;
+
+  LightTreeCone()
+      : axis(make_float3(0.0f, 0.0f, 1.0f)),
+        theta_o(0.0f),
+        theta_e(0.0f),
+        two_sided(false),
+        is_empty(true)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, float theta_o, float theta_e, bool two_sided)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e), two_sided(two_sided), is_empty(false)
+  {
+  }
+
+  /* Orientation measure used in the split cost. */
+  float measure() const;
+};
+
+LightTreeCone merge(const LightTreeCone &a, const LightTreeCone &b);
+
+/* Mesh light triangle or lamp to be placed in the tree. */
+struct LightTreeEmitter {
+  /* Index in the light distribution. */
+  int distribution_index;
+  BoundBox bbox;
+  float3 centroid;
+  LightTreeCone cone;
+  float energy;
+};
+
+/* Bounding volume hierarchy over the emitters, for importance sampling of many lights in the
+ * kernel. Distant and background lights have no position and are not part of it. */
+class LightTree {
+ public:
+  /* Builds the tree, reordering the emitters so that those in a leaf are contiguous. */
+  explicit LightTree(vector<LightTreeEmitter> &emitters);
+
+  /* Nodes in depth first order, the first child of an interior node directly follows it. */
+  vector<KernelLightTreeNode> nodes;
+  /* Leaf containing each emitter, in the order of the reordered emitters. */
+  vector<int> emitter_leaf;
+
+ protected:
+  int recursive_build(
+      vector<LightTreeEmitter> &emitters, int start, int end, int parent_index, int depth);
+  int find_split(vector<LightTreeEmitter> &emitters,
+                 int start,
+                 int end,
+                 const BoundBox &bbox,
+                 const BoundBox &centroid_bbox,
+                 int depth);
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
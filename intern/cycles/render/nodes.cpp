@@ -251,6 +251,9 @@ NODE_DEFINE(ImageTextureNode)
   SOCKET_BOOLEAN(animated, "Animated", false);
 
   SOCKET_IN_POINT(vector, "Vector", zero_float3(), SocketType::LINK_TEXTURE_UV);
+  /* Texture coordinates shifted by ray differentials, for the texture cache. */
+  SOCKET_IN_POINT(vector_dx, "VectorDX", zero_float3(), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_dy, "VectorDY", zero_float3(), SocketType::SVM_INTERNAL);
 
   SOCKET_OUT_COLOR(color, "Color");
   SOCKET_OUT_FLOAT(alpha, "Alpha");
@@ -363,6 +366,8 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
+  ShaderInput *vector_dx_in = input("VectorDX");
+  ShaderInput *vector_dy_in = input("VectorDY");
   ShaderOutput *color_out = output("Color");
   ShaderOutput *alpha_out = output("Alpha");
 
@@ -393,6 +398,17 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
     }
   }
 
+  /* Texture coordinate differentials, see ShaderGraph::refine_image_differentials(). */
+  const bool use_differentials = (projection != NODE_IMAGE_PROJ_BOX && vector_dx_in->link &&
+                                  vector_dy_in->link);
+  int vector_dx_offset = SVM_STACK_INVALID;
+  int vector_dy_offset = SVM_STACK_INVALID;
+  if (use_differentials) {
+    flags |= NODE_IMAGE_USE_DIFFERENTIALS;
+    vector_dx_offset = tex_mapping.compile_begin(compiler, vector_dx_in);
+    vector_dy_offset = tex_mapping.compile_begin(compiler, vector_dy_in);
+  }
+
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
     int num_nodes;
@@ -411,6 +427,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                              flags),
                       projection);
 
+    if (use_differentials) {
+      compiler.add_node(vector_dx_offset, vector_dy_offset, 0, 0);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
@@ -439,6 +459,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                       __float_as_int(projection_blend));
   }
 
+  if (use_differentials) {
+    tex_mapping.compile_end(compiler, vector_dy_in, vector_dy_offset);
+    tex_mapping.compile_end(compiler, vector_dx_in, vector_dx_offset);
+  }
   tex_mapping.compile_end(compiler, vector_in, vector_offset);
 }
 
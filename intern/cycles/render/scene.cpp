@@ -79,6 +79,9 @@ DeviceScene::DeviceScene(Device *device)
       lights(device, "__lights", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_GLOBAL),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_GLOBAL),
+      light_tree_emitters(device, "__light_tree_emitters", MEM_GLOBAL),
+      light_tree_leaf_emitters(device, "__light_tree_leaf_emitters", MEM_GLOBAL),
       particles(device, "__particles", MEM_GLOBAL),
       svm_nodes(device, "__svm_nodes", MEM_GLOBAL),
       shaders(device, "__shaders", MEM_GLOBAL),
@@ -117,6 +120,10 @@ Scene::Scene(const SceneParams &params_, Device *device)
   geometry_manager = new GeometryManager();
   object_manager = new ObjectManager();
   image_manager = new ImageManager(device->info);
+  /* The texture cache is only supported by SVM on the CPU. */
+  if (params.use_texture_cache && device->info.type == DEVICE_CPU && !shader_manager->use_osl()) {
+    image_manager->set_texture_cache(params.texture_cache_size);
+  }
   particle_system_manager = new ParticleSystemManager();
   bake_manager = new BakeManager();
   procedural_manager = new ProceduralManager();
@@ -237,6 +244,8 @@ void Scene::device_update(Device *device_, Progress &progress)
   }
 
   scoped_callback_timer timer([this, print_stats](double time) {
+    VLOG(1) << "Scene updated in " << time << " seconds.";
+
     if (update_stats) {
       update_stats->scene.times.add_entry({"device_update", time});
 
@@ -238,6 +238,30 @@ string MeshStats::full_report(int indent_level)
   return result;
 }
 
+/* Texture cache statistics. */
+
+TextureCacheStats::TextureCacheStats()
+    : used(false), lookups(0), tile_requests(0), tile_misses(0), bytes_read(0), memory_used(0)
+{
+}
+
+string TextureCacheStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const double hit_rate = (tile_requests > 0) ?
+                              100.0 * (tile_requests - tile_misses) / tile_requests :
+                              100.0;
+  string result = "";
+  result += indent + "Lookups: " + string_human_readable_number(lookups) + "\n";
+  result += indent + string_printf("Tile hit rate: %.2f%% (%s misses of %s requests)\n",
+                                   hit_rate,
+                                   string_human_readable_number(tile_misses).c_str(),
+                                   string_human_readable_number(tile_requests).c_str());
+  result += indent + "Read from disk: " + string_human_readable_size(bytes_read) + "\n";
+  result += indent + "Memory used: " + string_human_readable_size(memory_used) + "\n";
+  return result;
+}
+
 /* Image statistics. */
 
 ImageStats::ImageStats()
@@ -249,6 +273,9 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (texture_cache.used) {
+    result += indent + "Texture cache:\n" + texture_cache.full_report(indent_level + 1);
+  }
   return result;
 }
 
@@ -334,6 +361,9 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  if (!sync.entries.empty()) {
+    result += "Sync statistics:\n" + sync.full_report(1);
+  }
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
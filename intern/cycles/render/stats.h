@@ -162,6 +162,23 @@ class MeshStats {
   NamedSizeStats geometry;
 };
 
+/* Statistics about images read on demand through the texture cache. */
+class TextureCacheStats {
+ public:
+  TextureCacheStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  bool used;
+  uint64_t lookups;
+  /* Tiles requested by lookups, and how many of those were not in the cache. */
+  uint64_t tile_requests;
+  uint64_t tile_misses;
+  size_t bytes_read;
+  size_t memory_used;
+};
+
 /* Statistics about images held in memory. */
 class ImageStats {
  public:
@@ -171,6 +188,7 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+  TextureCacheStats texture_cache;
 };
 
 /* Render process statistics. */
@@ -191,6 +209,8 @@ class RenderStats {
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
+  /* Time spent synchronizing the scene from Blender, per stage. */
+  NamedTimeStats sync;
 };
 
 class UpdateTimeStats {
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/texture_cache.h"
+#include "render/image.h"
+#include "render/stats.h"
+
+#include "util/util_logging.h"
+#include "util/util_texture.h"
+
+#include <OpenImageIO/texture.h>
+
+CCL_NAMESPACE_BEGIN
+
+struct TextureCacheImage {
+  OIIO::TextureSystem *texture_system;
+  OIIO::TextureSystem::TextureHandle *handle;
+  OIIO::TextureOpt options;
+  ustring filepath;
+};
+
+static OIIO::TextureOpt::Wrap texture_cache_wrap(const ExtensionType extension)
+{
+  switch (extension) {
+    case EXTENSION_REPEAT:
+      return OIIO::TextureOpt::WrapPeriodic;
+    case EXTENSION_EXTEND:
+      return OIIO::TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+    default:
+      return OIIO::TextureOpt::WrapBlack;
+  }
+}
+
+static OIIO::TextureOpt::InterpMode texture_cache_interpolation(
+    const InterpolationType interpolation)
+{
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      return OIIO::TextureOpt::InterpClosest;
+    case INTERPOLATION_CUBIC:
+    case INTERPOLATION_SMART:
+      return OIIO::TextureOpt::InterpBicubic;
+    case INTERPOLATION_LINEAR:
+    default:
+      return OIIO::TextureOpt::InterpBilinear;
+  }
+}
+
+static uint64_t texture_cache_stat(OIIO::TextureSystem *ts, const char *name)
+{
+  /* Depending on the OpenImageIO version, counters are 32 or 64 bit. */
+  long long value64 = 0;
+  if (ts->getattribute(name, OIIO::TypeDesc::INT64, &value64)) {
+    return (uint64_t)value64;
+  }
+  int value = 0;
+  if (ts->getattribute(name, OIIO::TypeDesc::INT, &value)) {
+    return (uint64_t)value;
+  }
+  return 0;
+}
+
+TextureCache::TextureCache(int max_memory_mb)
+{
+  /* Not shared with OSL, so the memory budget only applies to the images in this cache. */
+  OIIO::TextureSystem *ts = OIIO::TextureSystem::create(false);
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("gray_to_rgb", 1);
+  ts->attribute("max_memory_MB", (float)max_memory_mb);
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache created with " << max_memory_mb << " MB memory budget.";
+}
+
+TextureCache::~TextureCache()
+{
+  OIIO::TextureSystem::destroy((OIIO::TextureSystem *)texture_system);
+}
+
+TextureCacheImage *TextureCache::add_image(const string &filepath, const ImageParams &params)
+{
+  OIIO::TextureSystem *ts = (OIIO::TextureSystem *)texture_system;
+  OIIO::TextureSystem::TextureHandle *handle = ts->get_texture_handle(ustring(filepath));
+
+  if (handle == NULL || !ts->good(handle)) {
+    VLOG(1) << "Texture cache failed to open " << filepath << ": " << ts->geterror();
+    return NULL;
+  }
+
+  TextureCacheImage *image = new TextureCacheImage();
+  image->texture_system = ts;
+  image->handle = handle;
+  image->filepath = ustring(filepath);
+
+  image->options.swrap = texture_cache_wrap(params.extension);
+  image->options.twrap = image->options.swrap;
+  image->options.interpmode = texture_cache_interpolation(params.interpolation);
+  /* Opaque alpha for images without an alpha channel. */
+  image->options.fill = 1.0f;
+
+  return image;
+}
+
+void TextureCache::remove_image(TextureCacheImage *image)
+{
+  /* Release tiles so that a modified file is read again next time. */
+  image->texture_system->invalidate(image->filepath);
+  delete image;
+}
+
+void TextureCache::collect_statistics(RenderStats *stats)
+{
+  OIIO::TextureSystem *ts = (OIIO::TextureSystem *)texture_system;
+  TextureCacheStats &cache_stats = stats->image.texture_cache;
+
+  cache_stats.used = true;
+  cache_stats.lookups = texture_cache_stat(ts, "stat:texture_queries");
+  cache_stats.tile_requests = texture_cache_stat(ts, "stat:find_tile_calls");
+  cache_stats.tile_misses = texture_cache_stat(ts, "stat:find_tile_cache_misses");
+  cache_stats.bytes_read = texture_cache_stat(ts, "stat:bytes_read");
+  cache_stats.memory_used = texture_cache_stat(ts, "stat:cache_memory_used");
+}
+
+void texture_cache_lookup(const TextureCacheImage *image,
+                          float x,
+                          float y,
+                          const float dx[2],
+                          const float dy[2],
+                          float result[4])
+{
+  OIIO::TextureOpt options = image->options;
+
+  /* Image rows are stored bottom to top in Cycles, top to bottom in OpenImageIO. */
+  if (!image->texture_system->texture(
+          image->handle, NULL, options, x, 1.0f - y, dx[0], -dx[1], dy[0], -dy[1], 4, result)) {
+    image->texture_system->geterror();
+    result[0] = TEX_IMAGE_MISSING_R;
+    result[1] = TEX_IMAGE_MISSING_G;
+    result[2] = TEX_IMAGE_MISSING_B;
+    result[3] = TEX_IMAGE_MISSING_A;
+  }
+}
+
+CCL_NAMESPACE_END
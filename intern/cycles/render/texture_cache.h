@@ -0,0 +1,68 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TEXTURE_CACHE_H__
+#define __TEXTURE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ImageParams;
+class RenderStats;
+struct TextureCacheImage;
+
+/* Texture Cache
+ *
+ * Image textures that are read on demand by the CPU kernel through the OpenImageIO texture
+ * system, instead of being loaded into memory completely before rendering. Only the tiles and
+ * MIP levels needed for the ray footprints are read, within a fixed memory budget, so that scenes
+ * with more texture data than fits in memory can still be rendered.
+ *
+ * Tiled and MIP-mapped files, for example as generated with `maketx`, work best. Other files are
+ * tiled and MIP-mapped by the texture system when they are opened. */
+class TextureCache {
+ public:
+  explicit TextureCache(int max_memory_mb);
+  ~TextureCache();
+
+  /* Returns NULL when the file can not be read by the texture system. */
+  TextureCacheImage *add_image(const string &filepath, const ImageParams &params);
+  void remove_image(TextureCacheImage *image);
+
+  void collect_statistics(RenderStats *stats);
+
+ private:
+  /* OIIO::TextureSystem, not exposed here to keep OpenImageIO out of the kernel headers. */
+  void *texture_system;
+};
+
+/* Texture lookup for the CPU kernel. The derivatives of the texture coordinates are used for
+ * filtering and MIP level selection, when they are zero the full resolution image is sampled.
+ *
+ * Vector types are passed as pointers since their layout and calling convention differ between
+ * the kernels compiled for different instruction sets and this file. */
+void texture_cache_lookup(const TextureCacheImage *image,
+                          float x,
+                          float y,
+                          const float dx[2],
+                          const float dy[2],
+                          float result[4]);
+
+CCL_NAMESPACE_END
+
+#endif /* __TEXTURE_CACHE_H__ */
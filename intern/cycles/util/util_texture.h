@@ -94,6 +94,8 @@ typedef struct TextureInfo {
   /* Transform for 3D textures. */
   uint use_transform_3d;
   Transform transform_3d;
+  /* Texture cache image to read from on the CPU instead of data, zero when fully loaded. */
+  uint64_t cache_image;
 } TextureInfo;
 
 CCL_NAMESPACE_END
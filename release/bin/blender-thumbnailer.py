@@ -84,6 +84,26 @@ def open_wrapper_get():
         return open_local_url
 
 
+def zstd_open_wrapper(fileobj):
+    """ decompress a Zstd stream, returns None when no Zstd module is available
+    """
+    try:
+        # Python 3.14 and newer.
+        from compression import zstd
+        return zstd.ZstdFile(fileobj, 'rb')
+    except ImportError:
+        pass
+
+    try:
+        import zstandard
+    except ImportError:
+        fileobj.close()
+        return None
+
+    # Blender writes a series of frames, keep reading past the end of the first one.
+    return zstandard.ZstdDecompressor().stream_reader(fileobj, read_across_frames=True)
+
+
 def blend_extract_thumb(path):
     import os
     open_wrapper = open_wrapper_get()
@@ -100,6 +120,12 @@ def blend_extract_thumb(path):
         blendfile.close()
         blendfile = gzip.GzipFile('', 'rb', 0, open_wrapper(path, 'rb'))
         head = blendfile.read(12)
+    elif head[0:4] == b'\x28\xb5\x2f\xfd':  # zstd magic
+        blendfile.close()
+        blendfile = zstd_open_wrapper(open_wrapper(path, 'rb'))
+        if blendfile is None:
+            return None, 0, 0
+        head = blendfile.read(12)
 
     if not head.startswith(b'BLENDER'):
         blendfile.close()
@@ -45,6 +45,16 @@ def read_blend_rend_chunk(path):
         blendfile.seek(0)
         blendfile = gzip.open(blendfile, "rb")
         head = blendfile.read(7)
+    elif head[0:4] == b'\x28\xb5\x2f\xfd':  # zstd magic
+        try:
+            import zstandard
+        except ImportError:
+            print("zstandard module required to read compressed blend file:", path)
+            blendfile.close()
+            return []
+        blendfile.seek(0)
+        blendfile = zstandard.ZstdDecompressor().stream_reader(blendfile, read_across_frames=True)
+        head = blendfile.read(7)
 
     if head != b'BLENDER':
         print("not a blend file:", path)
@@ -661,14 +661,21 @@ class NODE_PT_quality(bpy.types.Panel):
         snode = context.space_data
         tree = snode.node_tree
 
+        use_tiled = tree.execution_mode == 'TILED'
+
         col = layout.column()
+        col.prop(tree, "execution_mode")
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
-        col.prop(tree, "chunk_size")
+        sub = col.column()
+        sub.active = use_tiled
+        sub.prop(tree, "chunk_size")
 
         col = layout.column()
-        col.prop(tree, "use_opencl")
-        col.prop(tree, "use_groupnode_buffer")
+        sub = col.column()
+        sub.active = use_tiled
+        sub.prop(tree, "use_opencl")
+        sub.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
         col.separator()
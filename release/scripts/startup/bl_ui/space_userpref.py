@@ -620,6 +620,11 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
 
         layout.separator()
 
+        col = layout.column()
+        col.prop(system, "geometry_nodes_cache_limit", text="Geometry Nodes Cache Limit")
+
+        layout.separator()
+
         col = layout.column()
         col.prop(system, "scrollback", text="Console Scrollback Lines")
 
@@ -1409,6 +1414,9 @@ class USERPREF_PT_saveload_blend(SaveLoadPanel, CenterAlignMixIn, Panel):
         col = layout.column(heading="Default To")
         col.prop(paths, "use_relative_paths")
         col.prop(paths, "use_file_compression")
+        sub = col.column()
+        sub.active = paths.use_file_compression
+        sub.prop(paths, "use_file_compression_zstd")
         col.prop(paths, "use_load_ui")
 
         col = layout.column(heading="Text Files")
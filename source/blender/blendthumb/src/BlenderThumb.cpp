@@ -97,7 +97,11 @@ IFACEMETHODIMP CBlendThumb::Initialize(IStream *pStream, DWORD)
 #include "Wincodec.h"
 #include <math.h>
 #include <zlib.h>
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
 const unsigned char gzip_magic[3] = {0x1f, 0x8b, 0x08};
+const unsigned char zstd_magic[4] = {0x28, 0xb5, 0x2f, 0xfd};
 
 // IThumbnailProvider
 IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE *pdwAlpha)
@@ -107,14 +111,19 @@ IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE
   LARGE_INTEGER SeekPos;
 
   // Compressed?
-  unsigned char in_magic[3];
-  _pStream->Read(&in_magic, 3, &BytesRead);
+  unsigned char in_magic[4];
+  _pStream->Read(&in_magic, 4, &BytesRead);
   bool gzipped = true;
   for (int i = 0; i < 3; i++)
     if (in_magic[i] != gzip_magic[i]) {
       gzipped = false;
       break;
     }
+  bool zstd_compressed = (BytesRead == 4);
+  for (int i = 0; i < 4 && zstd_compressed; i++)
+    if (in_magic[i] != zstd_magic[i]) {
+      zstd_compressed = false;
+    }
 
   if (gzipped) {
     // Zlib inflate
@@ -167,6 +176,47 @@ IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE
     delete[] src;
     delete[] dest;
   }
+  else if (zstd_compressed) {
+#ifdef WITH_ZSTD
+    // The file is a series of independent frames, the thumbnail is inside the first one. Only
+    // decompress as much as fits in the output buffer, like for gzip above.
+    size_t dest_size = 1024 * 70;
+    Bytef *dest = new Bytef[dest_size];
+    ZSTD_outBuffer output = {dest, dest_size, 0};
+
+    size_t src_size = ZSTD_DStreamInSize();
+    Bytef *src = new Bytef[src_size];
+
+    SeekPos.QuadPart = 0;
+    _pStream->Seek(SeekPos, STREAM_SEEK_SET, NULL);
+
+    ZSTD_DStream *dstream = ZSTD_createDStream();
+    ZSTD_initDStream(dstream);
+    bool error = false;
+    while (!error && output.pos < output.size) {
+      if (_pStream->Read(src, (ULONG)src_size, &BytesRead) != S_OK || BytesRead == 0) {
+        break;
+      }
+      ZSTD_inBuffer input = {src, BytesRead, 0};
+      while (input.pos < input.size && output.pos < output.size) {
+        if (ZSTD_isError(ZSTD_decompressStream(dstream, &output, &input))) {
+          error = true;
+          break;
+        }
+      }
+    }
+    ZSTD_freeDStream(dstream);
+
+    // Replace the IStream, which is read-only
+    _pStream->Release();
+    _pStream = SHCreateMemStream(dest, (UINT)output.pos);
+
+    delete[] src;
+    delete[] dest;
+#else
+    return S_FALSE;
+#endif
+  }
 
   // Blender version, early out if sub 2.5
   SeekPos.QuadPart = 9;
@@ -155,6 +155,9 @@ enum {
   G_DEBUG_XR_TIME = (1 << 20),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 21), /* Debug GHOST module. */
+
+  /* Validate incrementally updated depsgraph relations against a full rebuild. */
+  G_DEBUG_DEPSGRAPH_VALIDATE = (1 << 22),
 };
 
 #define G_DEBUG_ALL \
@@ -165,6 +168,11 @@ enum {
 enum {
   G_FILE_AUTOPACK = (1 << 0),
   G_FILE_COMPRESS = (1 << 1),
+  /**
+   * Use Zstd instead of gzip when #G_FILE_COMPRESS is set. On read this is set from the format
+   * of the file on disk, so stale values of this (previously unused) bit are never used.
+   */
+  G_FILE_COMPRESS_ZSTD = (1 << 2),
 
   // G_FILE_DEPRECATED_9 = (1 << 9),
   G_FILE_NO_UI = (1 << 10),
@@ -188,6 +196,11 @@ enum {
    * As users/developers may not want their paths exposed in publicly distributed files.
    */
   G_FILE_RECOVER_WRITE = (1 << 24),
+  /**
+   * On read, only read the data-blocks used by the active scene, others are read when they are
+   * looked up (see #BLO_READ_LAZY_IDS). Only used in background mode.
+   */
+  G_FILE_LAZY_READ = (1 << 25),
   /** BMesh option to save as older mesh format */
   /* #define G_FILE_MESH_COMPAT       (1 << 26) */
   /* #define G_FILE_GLSL_NO_ENV_LIGHTING (1 << 28) */ /* deprecated */
@@ -197,7 +210,8 @@ enum {
  * Run-time only #G.fileflags which are never read or written to/from Blend files.
  * This means we can change the values without worrying about do-versions.
  */
-#define G_FILE_FLAG_ALL_RUNTIME (G_FILE_NO_UI | G_FILE_RECOVER_READ | G_FILE_RECOVER_WRITE)
+#define G_FILE_FLAG_ALL_RUNTIME \
+  (G_FILE_NO_UI | G_FILE_RECOVER_READ | G_FILE_RECOVER_WRITE | G_FILE_LAZY_READ)
 
 /** ENDIAN_ORDER: indicates what endianness the platform where the file was written had. */
 #if !defined(__BIG_ENDIAN__) && !defined(__LITTLE_ENDIAN__)
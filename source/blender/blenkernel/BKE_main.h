@@ -191,6 +191,12 @@ typedef struct Main {
    */
   struct MainIDRelations *relations;
 
+  /**
+   * File the data-blocks not read yet come from, when the file was read with
+   * #BLO_READ_LAZY_IDS. Owned by the blend-loader, see #BLO_lazy_id_load.
+   */
+  struct FileData *lazy_filedata;
+
   struct MainLock *lock;
 } Main;
 
@@ -325,6 +325,9 @@ typedef struct bNodeType {
 
   /* Execute a geometry node. */
   NodeGeometryExecFunction geometry_node_execute;
+  /* The geometry node requests its inputs on demand with `lazy_require_input`, and may be executed
+   * more than once until all of its outputs are computed. */
+  bool geometry_node_execute_supports_laziness;
 
   /* RNA integration */
   ExtensionRNA rna_ext;
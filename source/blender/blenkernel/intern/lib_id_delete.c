@@ -45,6 +45,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "BLO_readfile.h"
+
 #ifdef WITH_PYTHON
 #  include "BPY_extern.h"
 #endif
@@ -136,6 +138,11 @@ void BKE_id_free_ex(Main *bmain, void *idv, int flag, const bool use_flag_from_i
 
   const short type = GS(id->name);
 
+  if (bmain && bmain->lazy_filedata != NULL) {
+    /* Data-blocks read from the file later on must not link to this one. */
+    BLO_lazy_id_deleted(bmain, id);
+  }
+
   if (bmain && (flag & LIB_ID_FREE_NO_DEG_TAG) == 0) {
     BLI_assert(bmain->is_locked_for_linking == false);
 
@@ -39,6 +39,8 @@
 #include "BKE_lib_query.h"
 #include "BKE_main.h"
 
+#include "BLO_readfile.h"
+
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
@@ -194,6 +196,10 @@ void BKE_main_free(Main *mainvar)
     BKE_main_relations_free(mainvar);
   }
 
+  if (mainvar->lazy_filedata) {
+    BLO_lazy_id_free(mainvar);
+  }
+
   BLI_spin_end((SpinLock *)mainvar->lock);
   MEM_freeN(mainvar->lock);
   MEM_freeN(mainvar);
@@ -26,6 +26,7 @@
  */
 
 #include "BLI_math_inline.h"
+#include "BLI_sys_types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,11 @@ extern "C" {
 #define BLI_YUV_ITU_BT601 0
 #define BLI_YUV_ITU_BT709 1
 
+/* Transfer functions for #rgb_transform_buffer. */
+#define BLI_COLOR_TRANSFER_NONE 0
+#define BLI_COLOR_TRANSFER_SRGB_TO_LINEAR 1
+#define BLI_COLOR_TRANSFER_LINEAR_TO_SRGB 2
+
 /******************* Conversion to RGB ********************/
 
 void hsv_to_rgb(float h, float s, float v, float *r_r, float *r_g, float *r_b);
@@ -90,6 +96,15 @@ MINLINE void linearrgb_to_srgb_uchar4(unsigned char srgb[4], const float linear[
 
 void BLI_init_srgb_conversion(void);
 
+float rgb_transfer_evaluate(const int transfer, const float value);
+void rgb_transform_buffer(float *buffer,
+                          const size_t num_pixels,
+                          const int channels,
+                          const int transfer_in,
+                          const float matrix[3][3],
+                          const int transfer_out,
+                          const bool predivide);
+
 /**************** Alpha Transformations *****************/
 
 MINLINE void premul_to_straight_v4_v4(float straight[4], const float premul[4]);
@@ -21,6 +21,8 @@
  *  Functions to compute Murmur2A hash key.
  *
  * A very fast hash generating int32 result, with few collisions and good repartition.
+ * #BLI_hash_mm2_64 is the 64 bits variant (MurmurHash64A), for large amounts of data where
+ * collisions of a 32 bits hash would be too frequent.
  *
  * See also:
  * reference implementation:
@@ -31,6 +33,8 @@
  * so you should only use it for temporary data.
  */
 
+#include <string.h>
+
 #include "BLI_compiler_attrs.h"
 
 #include "BLI_hash_mm2a.h" /* own include */
@@ -141,3 +145,56 @@ uint32_t BLI_hash_mm2(const unsigned char *data, size_t len, uint32_t seed)
 
   return h;
 }
+
+#define MM2_64_M 0xc6a4a7935bd1e995ULL
+#define MM2_64_R 47
+
+/* Non-incremental 64 bits version (MurmurHash64A). */
+uint64_t BLI_hash_mm2_64(const unsigned char *data, size_t len, uint64_t seed)
+{
+  uint64_t h = seed ^ ((uint64_t)len * MM2_64_M);
+
+  /* Mix 8 bytes at a time into the hash, data may not be aligned. */
+  for (; len >= 8; data += 8, len -= 8) {
+    uint64_t k;
+    memcpy(&k, data, sizeof(k));
+
+    k *= MM2_64_M;
+    k ^= k >> MM2_64_R;
+    k *= MM2_64_M;
+
+    h ^= k;
+    h *= MM2_64_M;
+  }
+
+  /* Handle the last few bytes of the input array */
+  switch (len) {
+    case 7:
+      h ^= (uint64_t)data[6] << 48;
+      ATTR_FALLTHROUGH;
+    case 6:
+      h ^= (uint64_t)data[5] << 40;
+      ATTR_FALLTHROUGH;
+    case 5:
+      h ^= (uint64_t)data[4] << 32;
+      ATTR_FALLTHROUGH;
+    case 4:
+      h ^= (uint64_t)data[3] << 24;
+      ATTR_FALLTHROUGH;
+    case 3:
+      h ^= (uint64_t)data[2] << 16;
+      ATTR_FALLTHROUGH;
+    case 2:
+      h ^= (uint64_t)data[1] << 8;
+      ATTR_FALLTHROUGH;
+    case 1:
+      h ^= (uint64_t)data[0];
+      h *= MM2_64_M;
+  }
+
+  h ^= h >> MM2_64_R;
+  h *= MM2_64_M;
+  h ^= h >> MM2_64_R;
+
+  return h;
+}
@@ -72,3 +72,30 @@ TEST(hash_mm2a, MM2AIntegers)
 #endif
   EXPECT_EQ(BLI_hash_mm2a_end(&mm2), hash);
 }
+
+/* Note: Reference results are taken from reference implementation
+ * (MurmurHash64A variant, same source as above). */
+TEST(hash_mm2a, MM2_64Basic)
+{
+  const char *data = "Blender";
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, strlen(data), 0),
+            9643588805810197421ULL);
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, 0, 0), 0ULL);
+}
+
+TEST(hash_mm2a, MM2_64Blocks)
+{
+  /* Longer than 8 bytes, so that full blocks are mixed. */
+  const char *data = "Blender is FaNtAsTiC";
+#ifdef __LITTLE_ENDIAN__
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, strlen(data), 0),
+            8175486628693766140ULL);
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, strlen(data), 42),
+            5690813530507185393ULL);
+#else
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, strlen(data), 0),
+            15955638738239336621ULL);
+  EXPECT_EQ(BLI_hash_mm2_64((const unsigned char *)data, strlen(data), 42),
+            14556501857199086577ULL);
+#endif
+}
@@ -74,3 +74,48 @@ TEST(math_color, LinearRGBTosRGBRoundtrip)
     EXPECT_NEAR(orig_linear_color, linear_color, 1e-5);
   }
 }
+
+TEST(math_color, RGBTransformBuffer)
+{
+  const float matrix[3][3] = {
+      {0.4124f, 0.2126f, 0.0193f}, {0.3576f, 0.7152f, 0.1192f}, {0.1805f, 0.0722f, 0.9505f}};
+  const int N = 100;
+  float buffer[N][4], expected[N][4];
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < 3; j++) {
+      buffer[i][j] = (float)((i * 7 + j * 13) % N) / N * 1.5f;
+    }
+    buffer[i][3] = (float)(i % 5) / 4.0f;
+  }
+
+  for (int i = 0; i < N; i++) {
+    copy_v4_v4(expected[i], buffer[i]);
+    const float alpha = expected[i][3];
+    const bool use_alpha = alpha != 0.0f && alpha != 1.0f;
+    if (use_alpha) {
+      mul_v3_fl(expected[i], 1.0f / alpha);
+    }
+    for (int j = 0; j < 3; j++) {
+      expected[i][j] = srgb_to_linearrgb(expected[i][j]);
+    }
+    mul_m3_v3(matrix, expected[i]);
+    for (int j = 0; j < 3; j++) {
+      expected[i][j] = linearrgb_to_srgb(expected[i][j]);
+    }
+    if (use_alpha) {
+      mul_v3_fl(expected[i], alpha);
+    }
+  }
+
+  rgb_transform_buffer(&buffer[0][0],
+                       N,
+                       4,
+                       BLI_COLOR_TRANSFER_SRGB_TO_LINEAR,
+                       matrix,
+                       BLI_COLOR_TRANSFER_LINEAR_TO_SRGB,
+                       true);
+
+  for (int i = 0; i < N; i++) {
+    EXPECT_V4_NEAR(expected[i], buffer[i], 1e-5);
+  }
+}
@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_color.h"
+#include "BLI_task.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 5
+
+/* 8K UHD RGBA image. */
+#define IMAGE_WIDTH 7680
+#define IMAGE_HEIGHT 4320
+
+struct TransformData {
+  float *buffer;
+  bool use_simd;
+};
+
+static void transform_row_func(void *__restrict userdata,
+                               const int y,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  TransformData *data = (TransformData *)userdata;
+  float *row = data->buffer + (size_t)y * IMAGE_WIDTH * 4;
+
+  if (data->use_simd) {
+    rgb_transform_buffer(row,
+                         IMAGE_WIDTH,
+                         4,
+                         BLI_COLOR_TRANSFER_NONE,
+                         nullptr,
+                         BLI_COLOR_TRANSFER_LINEAR_TO_SRGB,
+                         true);
+  }
+  else {
+    /* Scalar conversion of every value, comparable to a generic transform. */
+    for (int x = 0; x < IMAGE_WIDTH; x++) {
+      float *pixel = row + x * 4;
+      const float alpha = pixel[3];
+      const bool use_alpha = alpha != 0.0f && alpha != 1.0f;
+      for (int j = 0; j < 3; j++) {
+        const float value = use_alpha ? pixel[j] / alpha : pixel[j];
+        pixel[j] = use_alpha ? linearrgb_to_srgb(value) * alpha : linearrgb_to_srgb(value);
+      }
+    }
+  }
+}
+
+static void color_transform_test(const char *id, const bool use_simd, const bool use_threads)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  const size_t num_values = (size_t)IMAGE_WIDTH * IMAGE_HEIGHT * 4;
+  float *buffer = (float *)MEM_mallocN(sizeof(float) * num_values, __func__);
+
+  TransformData data;
+  data.buffer = buffer;
+  data.use_simd = use_simd;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threads;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    for (size_t j = 0; j < num_values; j++) {
+      buffer[j] = (float)(j % 1024) / 1023.0f;
+    }
+
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, IMAGE_HEIGHT, &data, transform_row_func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  MEM_freeN(buffer);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(math_color, LinearToSRGBScalarNoThread)
+{
+  color_transform_test("LinearToSRGBScalarNoThread", false, false);
+}
+
+TEST(math_color, LinearToSRGBBufferNoThread)
+{
+  color_transform_test("LinearToSRGBBufferNoThread", true, false);
+}
+
+TEST(math_color, LinearToSRGBScalar)
+{
+  color_transform_test("LinearToSRGBScalar", false, true);
+}
+
+TEST(math_color, LinearToSRGBBuffer)
+{
+  color_transform_test("LinearToSRGBBuffer", true, true);
+}
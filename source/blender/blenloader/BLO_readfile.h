@@ -96,6 +96,11 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Only read the data-blocks used by the active scene (and the UI), the others are read when
+   * explicitly requested with #BLO_lazy_id_load. Ignored for files that need versioning.
+   */
+  BLO_READ_LAZY_IDS = (1 << 3),
 } eBLOReadSkip;
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
@@ -116,6 +121,19 @@ void BLO_blendfiledata_free(BlendFileData *bfd);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLO Lazy ID Loading API
+ *
+ * Data-blocks skipped when reading with #BLO_READ_LAZY_IDS.
+ * \{ */
+
+struct ID *BLO_lazy_id_load(struct Main *bmain, const short idcode, const char *name);
+void BLO_lazy_id_load_all(struct Main *bmain);
+void BLO_lazy_id_deleted(struct Main *bmain, const struct ID *id);
+void BLO_lazy_id_free(struct Main *bmain);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLO Blend File Handle API
  * \{ */
@@ -24,6 +24,10 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
 struct Scene;
 
@@ -32,7 +36,9 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, the data is the same as in the matching chunk of the previous #MemFile.
+   * Note that the memory itself is never owned by the chunk, it is shared through a global
+   * content-addressed store (see `undofile.c`). */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -45,9 +51,23 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the chunk data that was not stored before this memfile was written. */
   size_t size;
 } MemFile;
 
+typedef struct MemFileChunkStoreStats {
+  /** Number of unique chunk buffers currently stored. */
+  size_t chunks_num;
+  /** Memory used by the unique chunk buffers, in bytes. */
+  size_t stored_size;
+  /** Size of the chunks of all memfiles, as it would be without any sharing, in bytes. */
+  size_t referenced_size;
+  /** Number of chunks that were found identical to the matching chunk of the previous step. */
+  size_t positional_dedup_num;
+  /** Number of chunks that were found elsewhere in the store, by their content. */
+  size_t content_dedup_num;
+} MemFileChunkStoreStats;
+
 typedef struct MemFileWriteData {
   MemFile *written_memfile;
   MemFile *reference_memfile;
@@ -74,6 +94,8 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
 
+void BLO_memfile_chunk_store_stats_get(MemFileChunkStoreStats *r_stats);
+
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
@@ -84,3 +106,7 @@ extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
@@ -376,7 +376,13 @@ BlendFileData *BLO_read_from_file(const char *filepath,
     fd->reports = reports;
     fd->skip_flags = skip_flags;
     bfd = blo_read_file_internal(fd, filepath);
-    blo_filedata_free(fd);
+    if (bfd != NULL && bfd->main->lazy_filedata == fd) {
+      /* Kept alive to read the skipped data-blocks, see #BLO_READ_LAZY_IDS. */
+      fd->reports = NULL;
+    }
+    else {
+      blo_filedata_free(fd);
+    }
   }
 
   return bfd;
@@ -69,6 +69,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -76,6 +77,7 @@
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
 #include "BKE_asset.h"
+#include "BKE_blender_version.h"
 #include "BKE_collection.h"
 #include "BKE_global.h" /* for G */
 #include "BKE_idprop.h"
@@ -117,6 +119,10 @@
 
 #include <errno.h>
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 /* Make preferences read-only. */
 #define U (*((const UserDef *)&U))
 
@@ -210,6 +216,9 @@ typedef struct BHeadN {
   bool has_data;
 #endif
   bool is_memchunk_identical;
+  /** Result of #read_struct computed ahead of time by #read_structs_prepare_parallel,
+   * owned by the #BHeadN until it is read. */
+  void *data_prepared;
   struct BHead bhead;
 } BHeadN;
 
@@ -841,6 +850,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
           new_bhead->is_memchunk_identical = false;
+          new_bhead->data_prepared = NULL;
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -864,6 +874,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->has_data = true;
 #endif
           new_bhead->is_memchunk_identical = false;
+          new_bhead->data_prepared = NULL;
           new_bhead->bhead = bhead;
 
           readsize = fd->read(
@@ -976,6 +987,7 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
+  new_bhead_data->data_prepared = NULL;
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1185,6 +1197,323 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+#ifdef WITH_ZSTD
+/* Zstd file reading.
+ * Compressed files consist of independently compressed frames followed by a seek table, see
+ * #ww_open_zstd. Only the frames that are actually accessed are decompressed, which makes seeking
+ * cheap. Sequential reads decompress a growing window of frames ahead, in parallel. */
+
+/** Maximum number of frames that are decompressed at once. */
+#  define ZSTD_READ_AHEAD_MAX 16
+
+typedef struct ZstdReadFrame {
+  size_t compressed_offset;
+  size_t uncompressed_offset;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZstdReadFrame;
+
+typedef struct ZstdReadData {
+  ZstdReadFrame *frames;
+  int num_frames;
+  size_t uncompressed_size;
+
+  /** Used to read the compressed data when available, otherwise the file is read directly. */
+  BLI_mmap_file *mmap_file;
+
+  /** Compressed data of the frames that are being decompressed. */
+  char *compressed_buffer;
+  size_t compressed_buffer_size;
+
+  /** Decompressed data of the frames in the window, stored contiguously. */
+  char *window;
+  size_t window_size;
+  int window_start;
+  int window_len;
+  /** Number of frames to decompress when the window is moved forward sequentially. */
+  int read_ahead;
+} ZstdReadData;
+
+static uint32_t zstd_read_u32_le(const char *ptr)
+{
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_uint32(&value);
+  }
+  return value;
+}
+
+static bool zstd_read_file_range(int file, void *buffer, off64_t offset, size_t size)
+{
+  if (BLI_lseek(file, offset, SEEK_SET) != offset) {
+    return false;
+  }
+  char *ptr = buffer;
+  while (size > 0) {
+    const ssize_t readsize = read(file, ptr, size);
+    if (readsize <= 0) {
+      return false;
+    }
+    ptr += readsize;
+    size -= (size_t)readsize;
+  }
+  return true;
+}
+
+static void zstd_read_data_free(ZstdReadData *zd)
+{
+  if (zd->mmap_file) {
+    BLI_mmap_free(zd->mmap_file);
+  }
+  MEM_SAFE_FREE(zd->frames);
+  MEM_SAFE_FREE(zd->compressed_buffer);
+  MEM_SAFE_FREE(zd->window);
+  MEM_freeN(zd);
+}
+
+/**
+ * Parse the seek table at the end of the file.
+ * \return NULL when the file has no valid seek table.
+ */
+static ZstdReadData *zstd_read_data_open(int file)
+{
+  const off64_t file_size = BLI_lseek(file, 0, SEEK_END);
+
+  /* Footer: number of frames, seek table descriptor and magic number. */
+  char footer[9];
+  if (file_size < (off64_t)(8 + sizeof(footer)) ||
+      !zstd_read_file_range(file, footer, file_size - sizeof(footer), sizeof(footer))) {
+    return NULL;
+  }
+  if (zstd_read_u32_le(footer + 5) != BLO_ZSTD_SEEKABLE_MAGIC) {
+    return NULL;
+  }
+  const uint32_t num_frames = zstd_read_u32_le(footer);
+  const uint8_t descriptor = (uint8_t)footer[4];
+  /* Reserved bits must be zero. */
+  if (descriptor & 0x7c) {
+    return NULL;
+  }
+  const size_t entry_size = (descriptor & 0x80) ? 12 : 8;
+  const size_t table_size = 8 + (size_t)num_frames * entry_size + sizeof(footer);
+  if (num_frames == 0 || table_size > (size_t)file_size) {
+    return NULL;
+  }
+
+  char *table = MEM_mallocN(table_size, __func__);
+  if (!zstd_read_file_range(file, table, file_size - (off64_t)table_size, table_size) ||
+      zstd_read_u32_le(table) != BLO_ZSTD_SKIPPABLE_MAGIC ||
+      zstd_read_u32_le(table + 4) != table_size - 8) {
+    MEM_freeN(table);
+    return NULL;
+  }
+
+  ZstdReadData *zd = MEM_callocN(sizeof(ZstdReadData), __func__);
+  zd->frames = MEM_malloc_arrayN(num_frames, sizeof(ZstdReadFrame), __func__);
+  zd->num_frames = (int)num_frames;
+  zd->read_ahead = 1;
+
+  size_t compressed_offset = 0;
+  size_t uncompressed_offset = 0;
+  for (int i = 0; i < zd->num_frames; i++) {
+    const char *entry = table + 8 + (size_t)i * entry_size;
+    ZstdReadFrame *frame = &zd->frames[i];
+    frame->compressed_offset = compressed_offset;
+    frame->uncompressed_offset = uncompressed_offset;
+    frame->compressed_size = zstd_read_u32_le(entry);
+    frame->uncompressed_size = zstd_read_u32_le(entry + 4);
+    compressed_offset += frame->compressed_size;
+    uncompressed_offset += frame->uncompressed_size;
+  }
+  MEM_freeN(table);
+
+  /* The frames must exactly cover the file up to the seek table. */
+  if (compressed_offset != (size_t)file_size - table_size) {
+    zstd_read_data_free(zd);
+    return NULL;
+  }
+  zd->uncompressed_size = uncompressed_offset;
+
+  zd->mmap_file = BLI_mmap_open(file);
+
+  return zd;
+}
+
+static int zstd_find_frame(const ZstdReadData *zd, size_t offset)
+{
+  int low = 0;
+  int high = zd->num_frames - 1;
+  while (low < high) {
+    const int mid = (low + high + 1) / 2;
+    if (zd->frames[mid].uncompressed_offset <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+typedef struct ZstdDecompressData {
+  ZstdReadData *zd;
+  bool error;
+} ZstdDecompressData;
+
+static void zstd_decompress_frame_cb(void *__restrict userdata,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZstdDecompressData *data = userdata;
+  ZstdReadData *zd = data->zd;
+  const ZstdReadFrame *first = &zd->frames[zd->window_start];
+  const ZstdReadFrame *frame = &zd->frames[zd->window_start + iter];
+
+  const size_t size = ZSTD_decompress(
+      zd->window + (frame->uncompressed_offset - first->uncompressed_offset),
+      frame->uncompressed_size,
+      zd->compressed_buffer + (frame->compressed_offset - first->compressed_offset),
+      frame->compressed_size);
+  if (ZSTD_isError(size) || size != frame->uncompressed_size) {
+    data->error = true;
+  }
+}
+
+/**
+ * Decompress at least \a min_frames frames starting at \a frame_index into the window.
+ */
+static bool zstd_load_window(FileData *fd, int frame_index, int min_frames)
+{
+  ZstdReadData *zd = fd->zstd_data;
+
+  /* Read further ahead while the file is accessed sequentially. */
+  if (frame_index == zd->window_start + zd->window_len) {
+    zd->read_ahead = min_ii(zd->read_ahead * 2, ZSTD_READ_AHEAD_MAX);
+  }
+  else {
+    zd->read_ahead = 1;
+  }
+
+  const int len = min_ii(max_ii(min_frames, zd->read_ahead), zd->num_frames - frame_index);
+  const ZstdReadFrame *first = &zd->frames[frame_index];
+  const ZstdReadFrame *last = &zd->frames[frame_index + len - 1];
+  const size_t compressed_size = last->compressed_offset + last->compressed_size -
+                                 first->compressed_offset;
+  const size_t uncompressed_size = last->uncompressed_offset + last->uncompressed_size -
+                                   first->uncompressed_offset;
+
+  if (compressed_size > zd->compressed_buffer_size) {
+    MEM_SAFE_FREE(zd->compressed_buffer);
+    zd->compressed_buffer = MEM_mallocN(compressed_size, __func__);
+    zd->compressed_buffer_size = compressed_size;
+  }
+  if (uncompressed_size > zd->window_size) {
+    MEM_SAFE_FREE(zd->window);
+    zd->window = MEM_mallocN(uncompressed_size, __func__);
+    zd->window_size = uncompressed_size;
+  }
+
+  zd->window_start = frame_index;
+  zd->window_len = 0;
+
+  const bool read_ok = (zd->mmap_file != NULL) ?
+                           BLI_mmap_read(zd->mmap_file,
+                                         zd->compressed_buffer,
+                                         first->compressed_offset,
+                                         compressed_size) :
+                           zstd_read_file_range(fd->filedes,
+                                                zd->compressed_buffer,
+                                                (off64_t)first->compressed_offset,
+                                                compressed_size);
+  if (!read_ok) {
+    return false;
+  }
+
+  ZstdDecompressData data = {.zd = zd, .error = false};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, len, &data, zstd_decompress_frame_cb, &settings);
+  if (data.error) {
+    return false;
+  }
+
+  zd->window_len = len;
+  return true;
+}
+
+static ssize_t fd_read_zstd_from_file(FileData *filedata,
+                                      void *buffer,
+                                      size_t size,
+                                      bool *UNUSED(r_is_memchunck_identical))
+{
+  ZstdReadData *zd = filedata->zstd_data;
+  size_t offset = (size_t)filedata->file_offset;
+
+  if (offset >= zd->uncompressed_size) {
+    return 0;
+  }
+  size = MIN2(size, zd->uncompressed_size - offset);
+
+  char *dst = buffer;
+  size_t readsize = 0;
+  while (readsize < size) {
+    const ZstdReadFrame *window_first = &zd->frames[zd->window_start];
+    const size_t window_begin = window_first->uncompressed_offset;
+    size_t window_end = window_begin;
+    if (zd->window_len > 0) {
+      const ZstdReadFrame *window_last = &zd->frames[zd->window_start + zd->window_len - 1];
+      window_end = window_last->uncompressed_offset + window_last->uncompressed_size;
+    }
+
+    if (offset < window_begin || offset >= window_end) {
+      const int frame_index = zstd_find_frame(zd, offset);
+      const int last_index = zstd_find_frame(zd, offset + (size - readsize) - 1);
+      if (!zstd_load_window(filedata, frame_index, last_index - frame_index + 1)) {
+        return EOF;
+      }
+      continue;
+    }
+
+    const size_t len = MIN2(size - readsize, window_end - offset);
+    memcpy(dst, zd->window + (offset - window_begin), len);
+    dst += len;
+    offset += len;
+    readsize += len;
+  }
+
+  filedata->file_offset += (off64_t)readsize;
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_zstd_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const off64_t size = (off64_t)filedata->zstd_data->uncompressed_size;
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = size + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > size) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return filedata->file_offset;
+}
+#endif /* WITH_ZSTD */
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1379,6 +1708,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   BLI_mmap_file *mmap_file = NULL;
 
   gzFile gzfile = (gzFile)Z_NULL;
+  struct ZstdReadData *zstd_data = NULL;
 
   char header[7];
 
@@ -1429,6 +1759,26 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
     file = -1;
   }
 
+#ifdef WITH_ZSTD
+  /* Zstd file. */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (zstd_read_u32_le(header) == ZSTD_MAGICNUMBER)) {
+    zstd_data = zstd_read_data_open(file);
+    if (zstd_data == NULL) {
+      BKE_reportf(reports,
+                  RPT_WARNING,
+                  "Unable to read '%s': %s",
+                  filepath,
+                  TIP_("compressed file without seek table"));
+      return NULL;
+    }
+
+    read_fn = fd_read_zstd_from_file;
+    seek_fn = fd_seek_zstd_from_file;
+  }
+#endif
+
   if (read_fn == NULL) {
     BKE_reportf(reports, RPT_WARNING, "Unrecognized file format '%s'", filepath);
     return NULL;
@@ -1438,6 +1788,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->zstd_data = zstd_data;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1600,6 +1951,13 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+#ifdef WITH_ZSTD
+    if (fd->zstd_data != NULL) {
+      zstd_read_data_free(fd->zstd_data);
+      fd->zstd_data = NULL;
+    }
+#endif
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1616,6 +1974,13 @@ void blo_filedata_free(FileData *fd)
       fd->mmap_file = NULL;
     }
 
+    /* Prepared data of blocks that ended up not being read. */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      if (new_bhead->data_prepared != NULL) {
+        MEM_freeN(new_bhead->data_prepared);
+      }
+    }
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1665,6 +2030,10 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
 
+    if (fd->lazy_deleted_ids) {
+      BLI_gset_free(fd->lazy_deleted_ids, NULL);
+    }
+
     MEM_freeN(fd);
   }
 }
@@ -2175,6 +2544,13 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
 
+  /* Already read by #read_structs_prepare_parallel. */
+  if (BHEADN_FROM_BHEAD(bh)->data_prepared != NULL) {
+    temp = BHEADN_FROM_BHEAD(bh)->data_prepared;
+    BHEADN_FROM_BHEAD(bh)->data_prepared = NULL;
+    return temp;
+  }
+
   if (bh->len) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
@@ -2239,6 +2615,129 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Struct Reading
+ *
+ * Reading the data of the blocks (possibly from a memory-mapped file), switching its endianness
+ * and reconstructing it for the current SDNA only depends on the block itself. When loading a
+ * whole file, this is done for all blocks in parallel before the ID blocks are read one by one.
+ * The results are consumed by #read_struct.
+ *
+ * Everything that depends on other blocks or on the #Main database (direct linking, library
+ * linking and versioning) still happens afterwards, on a single thread.
+ * \{ */
+
+typedef struct ReadStructsPrepareData {
+  FileData *fd;
+  BHeadN **bheads;
+} ReadStructsPrepareData;
+
+static void read_structs_prepare_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadStructsPrepareData *data = userdata;
+  FileData *fd = data->fd;
+  BHeadN *new_bhead = data->bheads[index];
+  BHead *bh = &new_bhead->bhead;
+  const bool switch_endian = (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN));
+  const bool reconstruct = (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL);
+
+  /* Data that is not in memory yet can only be read concurrently from a memory-mapped file. */
+  BHeadN *new_bhead_data = NULL;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (new_bhead->has_data == false) {
+    if (fd->mmap_file == NULL) {
+      return;
+    }
+
+    if (!(switch_endian || reconstruct)) {
+      /* Read the data directly into its final memory. */
+      void *temp = MEM_mallocN((size_t)bh->len, "read_struct");
+      if (BLI_mmap_read(fd->mmap_file, temp, (size_t)new_bhead->file_offset, (size_t)bh->len)) {
+        new_bhead->data_prepared = temp;
+      }
+      else {
+        /* The error is reported when reading the block again from #read_struct. */
+        MEM_freeN(temp);
+      }
+      return;
+    }
+
+    new_bhead_data = MEM_mallocN(sizeof(BHeadN) + (size_t)bh->len, __func__);
+    new_bhead_data->bhead = *bh;
+    if (!BLI_mmap_read(
+            fd->mmap_file, new_bhead_data + 1, (size_t)new_bhead->file_offset, (size_t)bh->len)) {
+      MEM_freeN(new_bhead_data);
+      return;
+    }
+    bh = &new_bhead_data->bhead;
+  }
+#endif
+
+  if (switch_endian) {
+    switch_endian_structs(fd->filesdna, bh);
+  }
+
+  void *temp;
+  if (reconstruct) {
+    temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+  }
+  else {
+    temp = MEM_mallocN((size_t)bh->len, "read_struct");
+    memcpy(temp, (bh + 1), (size_t)bh->len);
+  }
+
+  if (new_bhead_data != NULL) {
+    MEM_freeN(new_bhead_data);
+  }
+  else if (temp == NULL && switch_endian) {
+    /* Leave the block as it was, so #read_struct can switch it again. */
+    switch_endian_structs(fd->filesdna, bh);
+  }
+
+  new_bhead->data_prepared = temp;
+}
+
+/**
+ * Compute the result of #read_struct for all blocks that are read when loading a whole file, using
+ * multiple threads.
+ */
+static void read_structs_prepare_parallel(FileData *fd)
+{
+  /* Reading all blocks also builds the full #BHead list. */
+  int bheads_len = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    bheads_len++;
+  }
+
+  BHeadN **bheads = MEM_malloc_arrayN((size_t)bheads_len, sizeof(*bheads), __func__);
+  int prepare_len = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    /* Only ID blocks and their data, other blocks are read differently. */
+    if (ELEM(bhead->code, DNA1, TEST, REND, GLOB, USER, ENDB)) {
+      continue;
+    }
+    if (bhead->len == 0 || fd->compflags[bhead->SDNAnr] == SDNA_CMP_REMOVED) {
+      continue;
+    }
+    bheads[prepare_len++] = BHEADN_FROM_BHEAD(bhead);
+  }
+
+  ReadStructsPrepareData data = {
+      .fd = fd,
+      .bheads = bheads,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  BLI_task_parallel_range(0, prepare_len, &data, read_structs_prepare_cb, &settings);
+
+  MEM_freeN(bheads);
+}
+
+/** \} */
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -3772,6 +4271,9 @@ static BHead *read_global(BlendFileData *bfd, FileData *fd, BHead *bhead)
   BLI_strncpy(bfd->main->build_hash, fg->build_hash, sizeof(bfd->main->build_hash));
 
   bfd->fileflags = fg->fileflags;
+  /* Keep the compression method of the file on disk when it's saved again. Memory files used for
+   * undo don't have one, their file flags are restored by the caller. */
+  SET_FLAG_FROM_TEST(bfd->fileflags, fd->zstd_data != NULL, G_FILE_COMPRESS_ZSTD);
   bfd->globalf = fg->globalf;
   BLI_strncpy(bfd->filename, fg->filename, sizeof(bfd->filename));
 
@@ -4097,12 +4599,19 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 /** \name Read File (Internal)
  * \{ */
 
+static bool lazy_id_code_is_always_read(const int code);
+static void lazy_ids_read_used(FileData *fd, BlendFileData *bfd);
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
   BlendFileData *bfd;
   ListBase mainlist = {NULL, NULL};
 
+  /* Skipped data-blocks are read from the file later on, so this requires read-on-demand. */
+  bool use_lazy_ids = (fd->skip_flags & BLO_READ_LAZY_IDS) && fd->mmap_file != NULL &&
+                      fd->memfile == NULL && (fd->skip_flags & BLO_READ_SKIP_DATA) == 0;
+
   if (fd->memfile != NULL) {
     DEBUG_PRINTF("\nUNDO: read step\n");
   }
@@ -4142,6 +4651,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  /* Not for undo, where the data does not need any conversion and is only peeked at. */
+  if (fd->memfile == NULL && (fd->skip_flags & BLO_READ_SKIP_DATA) == 0 && !use_lazy_ids) {
+    read_structs_prepare_parallel(fd);
+  }
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4152,6 +4666,10 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         break;
       case GLOB:
         bhead = read_global(bfd, fd, bhead);
+        /* Versioning may need any data-block, so read everything for older files. */
+        if (MAIN_VERSION_OLDER(bfd->main, BLENDER_FILE_VERSION, BLENDER_FILE_SUBVERSION)) {
+          use_lazy_ids = false;
+        }
         break;
       case USER:
         if (fd->skip_flags & BLO_READ_SKIP_USERDEF) {
@@ -4187,12 +4705,25 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         if (fd->skip_flags & BLO_READ_SKIP_DATA) {
           bhead = blo_bhead_next(fd, bhead);
         }
+        else if (use_lazy_ids) {
+          if (lazy_id_code_is_always_read(bhead->code)) {
+            bhead = read_libblock(
+                fd, bfd->main, bhead, LIB_TAG_LOCAL | LIB_TAG_NEED_EXPAND, false, NULL);
+          }
+          else {
+            bhead = blo_bhead_next(fd, bhead);
+          }
+        }
         else {
           bhead = read_libblock(fd, bfd->main, bhead, LIB_TAG_LOCAL, false, NULL);
         }
     }
   }
 
+  if (use_lazy_ids) {
+    lazy_ids_read_used(fd, bfd);
+  }
+
   /* do before read_libraries, but skip undo case */
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -4258,6 +4789,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     fix_relpaths_library(fd->relabase, bfd->main);
 
     link_global(fd, bfd); /* as last */
+
+    if (use_lazy_ids) {
+      /* Ownership is transferred to the main database, see #BLO_read_from_file. */
+      bfd->main->lazy_filedata = fd;
+    }
   }
 
   fd->mainlist = NULL; /* Safety, this is local variable, shall not be used afterward. */
@@ -4623,6 +5159,224 @@ void BLO_expand_main(void *fdhandle, Main *mainvar)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Lazy ID Loading
+ *
+ * With #BLO_READ_LAZY_IDS only the data-blocks used by the active scene, by the scenes shown in
+ * windows and by the UI are read with the file. The #FileData is then kept in
+ * #Main.lazy_filedata, and since it reads on demand from a memory mapped file, the skipped
+ * data-blocks cost nothing until they are requested with #BLO_lazy_id_load.
+ *
+ * Lookups by name never read data-blocks implicitly, callers that may need a skipped data-block
+ * use #BLO_lazy_id_load. Anything that accesses all data (Python scripts, writing files) uses
+ * #BLO_lazy_id_load_all first.
+ * \{ */
+
+/** Data-blocks not used by scenes, which are needed for the file to be usable. */
+static bool lazy_id_code_is_always_read(const int code)
+{
+  switch (code) {
+    case ID_LI:
+    case ID_WM:
+    case ID_WS:
+    case ID_SCR:
+    /* Registered scripts are executed when the file is loaded. */
+    case ID_TXT:
+      return true;
+  }
+  return false;
+}
+
+static void expand_doit_lazy(void *fdhandle, Main *mainvar, void *old)
+{
+  FileData *fd = fdhandle;
+
+  BHead *bhead = find_bhead(fd, old);
+  if (bhead == NULL || bhead->code == ID_LINK_PLACEHOLDER || !blo_bhead_is_id_valid_type(bhead)) {
+    /* Linked data-blocks are handled by #read_libraries as usual. */
+    return;
+  }
+
+  if (oldnewmap_lookup_entry(fd->libmap, bhead->old) != NULL) {
+    /* Already read (and possibly deleted since then). */
+    return;
+  }
+
+  read_libblock(fd, mainvar, bhead, LIB_TAG_LOCAL | LIB_TAG_NEED_EXPAND, false, NULL);
+}
+
+/** Read all local data-blocks used by the ones read so far. */
+static void lazy_ids_read_used(FileData *fd, BlendFileData *bfd)
+{
+  Main *bmain = bfd->main;
+
+  BLO_main_expander(expand_doit_lazy);
+
+  /* Nothing is lib-linked yet, so these are still the addresses stored in the file. */
+  expand_doit_lazy(fd, bmain, bfd->curscene);
+  LISTBASE_FOREACH (wmWindowManager *, wm, &bmain->wm) {
+    LISTBASE_FOREACH (wmWindow *, win, &wm->windows) {
+      expand_doit_lazy(fd, bmain, win->scene);
+    }
+  }
+
+  BLO_expand_main(fd, bmain);
+}
+
+/**
+ * Called for every data-block freed while #Main.lazy_filedata is set, see
+ * #lazy_ids_libmap_clear_deleted.
+ */
+void BLO_lazy_id_deleted(Main *bmain, const ID *id)
+{
+  FileData *fd = bmain->lazy_filedata;
+  if (fd->lazy_deleted_ids == NULL) {
+    fd->lazy_deleted_ids = BLI_gset_ptr_new(__func__);
+  }
+  BLI_gset_add(fd->lazy_deleted_ids, (void *)id);
+}
+
+/**
+ * The library map keeps pointers to all data-blocks read from the file,
+ * clear the ones that have been deleted since then so they are not used by new data-blocks.
+ *
+ * Must run before reading anything, since the addresses of deleted data-blocks may be re-used by
+ * the ones read next.
+ */
+static void lazy_ids_libmap_clear_deleted(FileData *fd)
+{
+  if (fd->lazy_deleted_ids == NULL) {
+    return;
+  }
+
+  OldNewMap *onm = fd->libmap;
+  for (int i = 0; i < onm->nentries; i++) {
+    OldNew *entry = &onm->entries[i];
+    if (entry->newp != NULL && BLI_gset_haskey(fd->lazy_deleted_ids, entry->newp)) {
+      entry->newp = NULL;
+    }
+  }
+
+  BLI_gset_free(fd->lazy_deleted_ids, NULL);
+  fd->lazy_deleted_ids = NULL;
+}
+
+/**
+ * Data-blocks created or renamed after the file was read may use the names of the ones read now.
+ * Those are at the end of the lists, so they are the ones that get renamed.
+ */
+static void lazy_ids_names_ensure_unique(Main *bmain)
+{
+  ListBase *lbarray[INDEX_ID_MAX];
+  int a = set_listbasepointers(bmain, lbarray);
+  while (a--) {
+    ListBase *lb = lbarray[a];
+    LISTBASE_FOREACH (ID *, id, lb) {
+      if (id->tag & LIB_TAG_NEW) {
+        BKE_main_id_repair_duplicate_names_listbase(lb);
+        break;
+      }
+    }
+  }
+}
+
+/** Link data-blocks read into an already loaded (joined) main database. */
+static void lazy_ids_link(FileData *fd, Main *bmain)
+{
+  lazy_ids_names_ensure_unique(bmain);
+
+  lib_link_all(fd, bmain);
+  after_liblink_merged_bmain_process(bmain);
+
+  BKE_main_id_refcount_recompute(bmain, false);
+  ntreeUpdateAllNew(bmain);
+  BKE_main_id_tag_all(bmain, LIB_TAG_NEW, false);
+
+  BKE_collections_after_lib_link(bmain);
+}
+
+/**
+ * Read a data-block that was skipped when reading the file with #BLO_READ_LAZY_IDS,
+ * along with all the data-blocks it uses.
+ *
+ * \return The new data-block, or NULL when there is no such data-block in the file or when it
+ * was read already.
+ */
+ID *BLO_lazy_id_load(Main *bmain, const short idcode, const char *name)
+{
+  FileData *fd = bmain->lazy_filedata;
+  if (fd == NULL) {
+    return NULL;
+  }
+
+#ifdef USE_GHASH_BHEAD
+  if (fd->bhead_idname_hash == NULL) {
+    read_file_bhead_idname_map_create(fd);
+  }
+#endif
+
+  BHead *bhead = find_bhead_from_code_name(fd, idcode, name);
+  if (bhead == NULL) {
+    return NULL;
+  }
+
+  lazy_ids_libmap_clear_deleted(fd);
+  if (oldnewmap_lookup_entry(fd->libmap, bhead->old) != NULL) {
+    /* Renamed or deleted since it was read, do not bring it back. */
+    return NULL;
+  }
+
+  /* Linking code may look up data-blocks by name, do not recurse. */
+  bmain->lazy_filedata = NULL;
+
+  ID *id;
+  BLO_main_expander(expand_doit_lazy);
+  read_libblock(fd, bmain, bhead, LIB_TAG_LOCAL | LIB_TAG_NEED_EXPAND, false, &id);
+  BLO_expand_main(fd, bmain);
+  lazy_ids_link(fd, bmain);
+
+  bmain->lazy_filedata = fd;
+
+  return id;
+}
+
+/**
+ * Read all data-blocks that were skipped when reading the file, needed before writing it.
+ */
+void BLO_lazy_id_load_all(Main *bmain)
+{
+  FileData *fd = bmain->lazy_filedata;
+  if (fd == NULL) {
+    return;
+  }
+  bmain->lazy_filedata = NULL;
+
+  lazy_ids_libmap_clear_deleted(fd);
+
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == ID_LINK_PLACEHOLDER || !blo_bhead_is_id_valid_type(bhead)) {
+      continue;
+    }
+    if (oldnewmap_lookup_entry(fd->libmap, bhead->old) == NULL) {
+      read_libblock(fd, bmain, bhead, LIB_TAG_LOCAL, false, NULL);
+    }
+  }
+
+  lazy_ids_link(fd, bmain);
+
+  blo_filedata_free(fd);
+}
+
+void BLO_lazy_id_free(Main *bmain)
+{
+  if (bmain->lazy_filedata != NULL) {
+    blo_filedata_free(bmain->lazy_filedata);
+    bmain->lazy_filedata = NULL;
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Library Linking (helper functions)
  * \{ */
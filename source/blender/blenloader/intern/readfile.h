@@ -42,6 +42,7 @@ struct Object;
 struct OldNewMap;
 struct ReportList;
 struct UserDef;
+struct ZstdReadData;
 
 typedef struct IDNameLib_Map IDNameLib_Map;
 
@@ -64,6 +65,14 @@ enum eFileDataFlag {
 typedef int64_t off64_t;
 #endif
 
+/**
+ * Compressed files are written as independent Zstd frames of this (uncompressed) size,
+ * followed by a seek table in the "Zstandard Seekable Format".
+ */
+#define BLO_ZSTD_FRAME_SIZE (1 << 20)
+#define BLO_ZSTD_SKIPPABLE_MAGIC 0x184D2A5E
+#define BLO_ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+
 typedef ssize_t(FileDataReadFn)(struct FileData *filedata,
                                 void *buffer,
                                 size_t size,
@@ -97,6 +106,8 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Seekable Zstd file reading, see #fd_read_zstd_from_file. */
+  struct ZstdReadData *zstd_data;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -140,6 +151,9 @@ typedef struct FileData {
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
+  /** Data-blocks deleted since the file was read with #BLO_READ_LAZY_IDS. */
+  struct GSet *lazy_deleted_ids;
+
   ListBase *mainlist;
   /** Used for undo. */
   ListBase *old_mainlist;
@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -54,15 +55,143 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Store
+ *
+ * The buffers of all #MemFileChunk are content-addressed: they are stored once in a global
+ * store shared by all undo steps, identified by a 64 bits hash of their content, and freed when
+ * the last chunk using them is freed. So data that is moved around between undo steps (e.g.
+ * because IDs got re-ordered, or data got inserted before it) is not stored again.
+ *
+ * Buffers are allocated with a #MemFileStoredChunk header in front of the data, so that
+ * #MemFileChunk.buf can still be used as a regular pointer to the data.
+ *
+ * \note Undo steps are only written and freed from the main thread, so the store is not locked.
+ * \{ */
+
+typedef struct MemFileStoredChunk {
+  /** Points to the data following this header, or to external data for lookup keys. */
+  const char *data;
+  size_t size;
+  uint64_t hash;
+  /** Number of #MemFileChunk using this buffer. */
+  int users;
+  /** Padding, keeps the data aligned like any other allocation. */
+  int _pad;
+} MemFileStoredChunk;
+
+static struct {
+  /** Set of #MemFileStoredChunk. */
+  GSet *chunks;
+  MemFileChunkStoreStats stats;
+} memfile_store = {NULL};
+
+#define STORED_CHUNK_FROM_BUF(buf) (((MemFileStoredChunk *)(buf)) - 1)
+
+static uint memfile_stored_chunk_hash(const void *key)
+{
+  const MemFileStoredChunk *chunk = key;
+  return (uint)(chunk->hash ^ (chunk->hash >> 32));
+}
+
+static bool memfile_stored_chunk_cmp(const void *a, const void *b)
+{
+  const MemFileStoredChunk *chunk_a = a;
+  const MemFileStoredChunk *chunk_b = b;
+  if (chunk_a->hash != chunk_b->hash || chunk_a->size != chunk_b->size) {
+    return true;
+  }
+  return memcmp(chunk_a->data, chunk_b->data, chunk_a->size) != 0;
+}
+
+static void memfile_store_buf_add_user(const char *buf)
+{
+  MemFileStoredChunk *stored = STORED_CHUNK_FROM_BUF(buf);
+  stored->users++;
+  memfile_store.stats.referenced_size += stored->size;
+}
+
+/**
+ * Find a buffer with the same content in the store, or add a copy of the data to it.
+ * \param r_is_new: Set when the data was not in the store yet.
+ */
+static const char *memfile_store_buf_ensure(const char *data, size_t size, bool *r_is_new)
+{
+  if (memfile_store.chunks == NULL) {
+    memfile_store.chunks = BLI_gset_new(
+        memfile_stored_chunk_hash, memfile_stored_chunk_cmp, "MemFile chunk store");
+  }
+
+  MemFileStoredChunk key = {
+      .data = data,
+      .size = size,
+      .hash = BLI_hash_mm2_64((const unsigned char *)data, size, 0),
+  };
+
+  void **r_key;
+  if (BLI_gset_ensure_p_ex(memfile_store.chunks, &key, &r_key)) {
+    MemFileStoredChunk *stored = *r_key;
+    memfile_store_buf_add_user(stored->data);
+    memfile_store.stats.content_dedup_num++;
+    *r_is_new = false;
+    return stored->data;
+  }
+
+  MemFileStoredChunk *stored = MEM_mallocN(sizeof(MemFileStoredChunk) + size, "Chunk buffer");
+  char *buf = (char *)(stored + 1);
+  memcpy(buf, data, size);
+  stored->data = buf;
+  stored->size = size;
+  stored->hash = key.hash;
+  stored->users = 0;
+  *r_key = stored;
+
+  memfile_store.stats.chunks_num++;
+  memfile_store.stats.stored_size += size;
+  memfile_store_buf_add_user(buf);
+  *r_is_new = true;
+  return buf;
+}
+
+static void memfile_store_buf_remove_user(const char *buf)
+{
+  MemFileStoredChunk *stored = STORED_CHUNK_FROM_BUF(buf);
+  BLI_assert(stored->users > 0);
+  memfile_store.stats.referenced_size -= stored->size;
+
+  if (--stored->users > 0) {
+    return;
+  }
+
+  BLI_gset_remove(memfile_store.chunks, stored, NULL);
+  memfile_store.stats.chunks_num--;
+  memfile_store.stats.stored_size -= stored->size;
+  MEM_freeN(stored);
+
+  /* Free the store with the last chunk, so no explicit exit call is needed. */
+  if (BLI_gset_len(memfile_store.chunks) == 0) {
+    BLI_gset_free(memfile_store.chunks, NULL);
+    memfile_store.chunks = NULL;
+  }
+}
+
+/**
+ * Statistics of the chunk store, shared by all #MemFile.
+ */
+void BLO_memfile_chunk_store_stats_get(MemFileChunkStoreStats *r_stats)
+{
+  *r_stats = memfile_store.stats;
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_store_buf_remove_user(chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
@@ -72,35 +201,25 @@ void BLO_memfile_free(MemFile *memfile)
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
+  /* Buffers are shared through the chunk store, so only the `is_identical` flags of the second
+   * memfile need to be updated: they were relative to the first memfile, which is going away. A
+   * chunk of the second memfile can only keep that flag when its data was not changed in the first
+   * memfile either, otherwise it may be different in the step before the first one. */
+  GSet *changed_buffers = BLI_gset_ptr_new(__func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
+    if (!fc->is_identical) {
+      BLI_gset_add(changed_buffers, (void *)fc->buf);
     }
   }
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
+    if (sc->is_identical && BLI_gset_haskey(changed_buffers, sc->buf)) {
+      sc->is_identical = false;
     }
   }
 
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
+  BLI_gset_free(changed_buffers, NULL);
 
   BLO_memfile_free(first);
 }
@@ -170,25 +289,34 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
   BLI_addtail(&memfile->chunks, curchunk);
 
-  /* we compare compchunk with buf */
-  if (*compchunk_step != NULL) {
-    MemFileChunk *compchunk = *compchunk_step;
+  /* Compare with the matching chunk of the previous step first, this avoids hashing the data
+   * in the common case where it did not change. */
+  MemFileChunk *compchunk = *compchunk_step;
+  if (compchunk != NULL) {
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
-        curchunk->is_identical = true;
-        compchunk->is_identical_future = true;
+        memfile_store_buf_add_user(curchunk->buf);
+        memfile_store.stats.positional_dedup_num++;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* Not equal, look for the same data anywhere in the store. */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = memfile_store_buf_ensure(buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
+  }
+
+  /* Buffers are unique per content, so comparing pointers is enough to know whether the data is
+   * the same as in the previous step. */
+  if (compchunk != NULL && compchunk->buf == curchunk->buf) {
+    curchunk->is_identical = true;
+    compchunk->is_identical_future = true;
   }
 }
 
@@ -100,7 +100,9 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_endian_switch.h"
 #include "BLI_mempool.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -128,6 +130,10 @@
 
 #include <errno.h>
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 /* Make preferences read-only. */
 #define U (*((const UserDef *)&U))
 
@@ -147,6 +153,9 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+#ifdef WITH_ZSTD
+  WW_WRAP_ZSTD,
+#endif
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -163,6 +172,7 @@ struct WriteWrap {
   union {
     int file_handle;
     gzFile gz_handle;
+    struct ZstdWriteWrap *zstd_handle;
   } _user_data;
 };
 
@@ -218,6 +228,228 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+#ifdef WITH_ZSTD
+/* zstd */
+#  define FILE_HANDLE(ww) (ww)->_user_data.zstd_handle
+
+/**
+ * The data is split into frames of #BLO_ZSTD_FRAME_SIZE that are compressed independently of each
+ * other (in parallel), followed by a seek table that is stored in a skippable frame as described
+ * by the "Zstandard Seekable Format". Regular Zstd decoders can still decompress the file, while
+ * #fd_read_zstd_from_file is able to decompress only the frames it needs.
+ */
+#  define ZSTD_COMPRESSION_LEVEL 3
+
+typedef struct ZstdFrame {
+  struct ZstdFrame *next, *prev;
+
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZstdFrame;
+
+typedef struct ZstdWriteBlock {
+  struct ZstdWriteBlock *next, *prev;
+
+  struct ZstdWriteWrap *zww;
+  /** Uncompressed data, owned by the block until it is compressed. */
+  void *data;
+  size_t size;
+  int frame_number;
+} ZstdWriteBlock;
+
+typedef struct ZstdWriteWrap {
+  int file_handle;
+
+  /** Uncompressed data of the frame that is currently being filled. */
+  char *buffer;
+  size_t buffer_used;
+
+  /** Compression threads, one #ZstdWriteBlock each. */
+  ListBase threads;
+  /** Blocks that have been passed to a thread, oldest first. */
+  ListBase blocks;
+  int num_frames;
+
+  /** Frames are compressed in any order but written to the file in order. */
+  ThreadMutex mutex;
+  ThreadCondition condition;
+  int next_frame;
+  /** #ZstdFrame for every frame written so far, used for the seek table. */
+  ListBase frames;
+  bool write_error;
+} ZstdWriteWrap;
+
+static void *zstd_write_task(void *userdata)
+{
+  ZstdWriteBlock *block = userdata;
+  ZstdWriteWrap *zww = block->zww;
+
+  const size_t out_buf_len = ZSTD_compressBound(block->size);
+  void *out_buf = MEM_mallocN(out_buf_len, "zstd_write_task");
+  const size_t out_size = ZSTD_compress(
+      out_buf, out_buf_len, block->data, block->size, ZSTD_COMPRESSION_LEVEL);
+
+  MEM_freeN(block->data);
+  block->data = NULL;
+
+  BLI_mutex_lock(&zww->mutex);
+  while (zww->next_frame != block->frame_number) {
+    BLI_condition_wait(&zww->condition, &zww->mutex);
+  }
+
+  if (ZSTD_isError(out_size)) {
+    zww->write_error = true;
+  }
+  else if (!zww->write_error) {
+    if (write(zww->file_handle, out_buf, out_size) == (ssize_t)out_size) {
+      ZstdFrame *frame = MEM_mallocN(sizeof(ZstdFrame), "ZstdFrame");
+      frame->compressed_size = (uint32_t)out_size;
+      frame->uncompressed_size = (uint32_t)block->size;
+      BLI_addtail(&zww->frames, frame);
+    }
+    else {
+      zww->write_error = true;
+    }
+  }
+
+  zww->next_frame++;
+  BLI_condition_notify_all(&zww->condition);
+  BLI_mutex_unlock(&zww->mutex);
+
+  MEM_freeN(out_buf);
+  return NULL;
+}
+
+static void zstd_write_dispatch_frame(ZstdWriteWrap *zww)
+{
+  if (zww->buffer_used == 0) {
+    return;
+  }
+
+  /* When all threads are busy, wait for the oldest block. It is always able to finish, since all
+   * the frames before it have been dispatched already. */
+  if (BLI_available_threads(&zww->threads) == 0) {
+    ZstdWriteBlock *oldest = zww->blocks.first;
+    BLI_threadpool_remove(&zww->threads, oldest);
+    BLI_freelinkN(&zww->blocks, oldest);
+  }
+
+  ZstdWriteBlock *block = MEM_callocN(sizeof(ZstdWriteBlock), __func__);
+  block->zww = zww;
+  block->data = zww->buffer;
+  block->size = zww->buffer_used;
+  block->frame_number = zww->num_frames++;
+  BLI_addtail(&zww->blocks, block);
+
+  BLI_threadpool_insert(&zww->threads, block);
+
+  zww->buffer = MEM_mallocN(BLO_ZSTD_FRAME_SIZE, __func__);
+  zww->buffer_used = 0;
+}
+
+static void zstd_write_u32_le(char **r_ptr, uint32_t value)
+{
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_uint32(&value);
+  }
+  memcpy(*r_ptr, &value, sizeof(value));
+  *r_ptr += sizeof(value);
+}
+
+static bool zstd_write_seek_table(ZstdWriteWrap *zww)
+{
+  const int num_frames = BLI_listbase_count(&zww->frames);
+  /* Skippable frame header, one entry per frame and the seek table footer. */
+  const size_t table_size = 8 + (size_t)num_frames * 8 + 9;
+  char *table = MEM_mallocN(table_size, __func__);
+  char *ptr = table;
+
+  zstd_write_u32_le(&ptr, BLO_ZSTD_SKIPPABLE_MAGIC);
+  zstd_write_u32_le(&ptr, (uint32_t)(table_size - 8));
+  LISTBASE_FOREACH (ZstdFrame *, frame, &zww->frames) {
+    zstd_write_u32_le(&ptr, frame->compressed_size);
+    zstd_write_u32_le(&ptr, frame->uncompressed_size);
+  }
+  zstd_write_u32_le(&ptr, (uint32_t)num_frames);
+  /* Seek table descriptor, no checksums are stored. */
+  *ptr++ = 0;
+  zstd_write_u32_le(&ptr, BLO_ZSTD_SEEKABLE_MAGIC);
+  BLI_assert((size_t)(ptr - table) == table_size);
+
+  const bool ok = (write(zww->file_handle, table, table_size) == (ssize_t)table_size);
+  MEM_freeN(table);
+  return ok;
+}
+
+static bool ww_open_zstd(WriteWrap *ww, const char *filepath)
+{
+  int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
+    return false;
+  }
+
+  ZstdWriteWrap *zww = MEM_callocN(sizeof(ZstdWriteWrap), __func__);
+  zww->file_handle = file;
+  zww->buffer = MEM_mallocN(BLO_ZSTD_FRAME_SIZE, __func__);
+  BLI_threadpool_init(&zww->threads, zstd_write_task, BLI_system_thread_count());
+  BLI_mutex_init(&zww->mutex);
+  BLI_condition_init(&zww->condition);
+
+  FILE_HANDLE(ww) = zww;
+  return true;
+}
+static bool ww_close_zstd(WriteWrap *ww)
+{
+  ZstdWriteWrap *zww = FILE_HANDLE(ww);
+
+  zstd_write_dispatch_frame(zww);
+  BLI_threadpool_end(&zww->threads);
+  BLI_freelistN(&zww->blocks);
+
+  bool ok = !zww->write_error && zstd_write_seek_table(zww);
+  if (close(zww->file_handle) == -1) {
+    ok = false;
+  }
+
+  BLI_freelistN(&zww->frames);
+  BLI_condition_end(&zww->condition);
+  BLI_mutex_end(&zww->mutex);
+  MEM_freeN(zww->buffer);
+  MEM_freeN(zww);
+
+  return ok;
+}
+static size_t ww_write_zstd(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  ZstdWriteWrap *zww = FILE_HANDLE(ww);
+
+  /* Compression threads set the error flag, only read it under the lock. */
+  BLI_mutex_lock(&zww->mutex);
+  const bool write_error = zww->write_error;
+  BLI_mutex_unlock(&zww->mutex);
+  if (write_error) {
+    return 0;
+  }
+
+  size_t remaining = buf_len;
+  while (remaining > 0) {
+    const size_t len = MIN2(remaining, BLO_ZSTD_FRAME_SIZE - zww->buffer_used);
+    memcpy(zww->buffer + zww->buffer_used, buf, len);
+    zww->buffer_used += len;
+    buf += len;
+    remaining -= len;
+
+    if (zww->buffer_used == BLO_ZSTD_FRAME_SIZE) {
+      zstd_write_dispatch_frame(zww);
+    }
+  }
+
+  return buf_len;
+}
+#  undef FILE_HANDLE
+#endif /* WITH_ZSTD */
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -232,6 +464,15 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+#ifdef WITH_ZSTD
+    case WW_WRAP_ZSTD: {
+      r_ww->open = ww_open_zstd;
+      r_ww->close = ww_close_zstd;
+      r_ww->write = ww_write_zstd;
+      r_ww->use_buf = false;
+      break;
+    }
+#endif
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -926,6 +1167,9 @@ static bool write_file_handle(Main *mainvar,
   char buf[16];
   WriteData *wd;
 
+  /* Data-blocks skipped when reading the file would be lost otherwise. */
+  BLO_lazy_id_load_all(mainvar);
+
   blo_split_main(&mainlist, mainvar);
 
   wd = mywrite_begin(ww, compare, current);
@@ -1152,7 +1396,18 @@ bool BLO_write_file(Main *mainvar,
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
   if (write_flags & G_FILE_COMPRESS) {
-    ww_type = WW_WRAP_ZLIB;
+    if (write_flags & G_FILE_COMPRESS_ZSTD) {
+#ifdef WITH_ZSTD
+      ww_type = WW_WRAP_ZSTD;
+#else
+      /* Never fall back to another format, the file would not be what was asked for. */
+      BKE_report(reports, RPT_ERROR, "Zstd compression is not supported by this build");
+      return 0;
+#endif
+    }
+    else {
+      ww_type = WW_WRAP_ZLIB;
+    }
   }
   else {
     ww_type = WW_WRAP_NONE;
@@ -1228,9 +1483,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressing writers may only report errors once all data has been flushed. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_writefile.h"
+
+class BlendfileCompressionTest : public BlendfileLoadingBaseTest {
+ protected:
+  /* Enough vertices to span several compressed frames, so reading them needs seeking. */
+  static constexpr int big_mesh_totvert = 200000;
+
+  void big_mesh_add(Main *bmain)
+  {
+    Mesh *me = BKE_mesh_add(bmain, "BigMesh");
+    id_fake_user_set(&me->id);
+    me->totvert = big_mesh_totvert;
+    CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, nullptr, me->totvert);
+    BKE_mesh_update_customdata_pointers(me, false);
+    for (int i = 0; i < me->totvert; i++) {
+      me->mvert[i].co[0] = float(i);
+      me->mvert[i].co[1] = float(i % 7);
+      me->mvert[i].co[2] = -float(i);
+    }
+  }
+
+  void big_mesh_check(Main *bmain)
+  {
+    Mesh *me = reinterpret_cast<Mesh *>(BKE_libblock_find_name(bmain, ID_ME, "BigMesh"));
+    ASSERT_NE(me, nullptr);
+    ASSERT_EQ(me->totvert, big_mesh_totvert);
+    ASSERT_NE(me->mvert, nullptr);
+    for (int i = 0; i < me->totvert; i++) {
+      ASSERT_EQ(me->mvert[i].co[0], float(i));
+      ASSERT_EQ(me->mvert[i].co[1], float(i % 7));
+      ASSERT_EQ(me->mvert[i].co[2], -float(i));
+    }
+  }
+
+  void temp_filepath(const char *filename, char *r_filepath, const size_t filepath_len)
+  {
+    BLI_path_join(r_filepath, filepath_len, BKE_tempdir_session(), filename, nullptr);
+  }
+
+  bool blendfile_write(const char *filepath, const int write_flags)
+  {
+    BlendFileWriteParams params = {};
+    params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+    return BLO_write_file(bfile->main, filepath, write_flags, &params, nullptr);
+  }
+
+  /* Replace #bfile with the file read from `filepath`. */
+  bool blendfile_reload(const char *filepath)
+  {
+    blendfile_free();
+    bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+    return bfile != nullptr;
+  }
+
+  bool file_has_magic(const char *filepath, const unsigned char *magic, const int magic_len)
+  {
+    unsigned char header[4] = {0};
+    FILE *file = BLI_fopen(filepath, "rb");
+    if (file == nullptr) {
+      return false;
+    }
+    const size_t len = fread(header, 1, magic_len, file);
+    fclose(file);
+    return len == size_t(magic_len) && memcmp(header, magic, magic_len) == 0;
+  }
+};
+
+static const unsigned char zstd_magic[4] = {0x28, 0xb5, 0x2f, 0xfd};
+static const unsigned char gzip_magic[2] = {0x1f, 0x8b};
+
+TEST_F(BlendfileCompressionTest, GzipRoundTrip)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  big_mesh_add(bfile->main);
+
+  char filepath[FILE_MAX];
+  temp_filepath("compression_gzip.blend", filepath, sizeof(filepath));
+  /* The Zstd flag alone doesn't compress. */
+  ASSERT_TRUE(blendfile_write(filepath, G_FILE_COMPRESS_ZSTD));
+  EXPECT_FALSE(file_has_magic(filepath, zstd_magic, sizeof(zstd_magic)));
+
+  ASSERT_TRUE(blendfile_write(filepath, G_FILE_COMPRESS));
+  EXPECT_TRUE(file_has_magic(filepath, gzip_magic, sizeof(gzip_magic)));
+
+  ASSERT_TRUE(blendfile_reload(filepath));
+  EXPECT_TRUE(bfile->fileflags & G_FILE_COMPRESS);
+  EXPECT_FALSE(bfile->fileflags & G_FILE_COMPRESS_ZSTD);
+  big_mesh_check(bfile->main);
+
+  BLI_delete(filepath, false, false);
+}
+
+#ifdef WITH_ZSTD
+
+TEST_F(BlendfileCompressionTest, ZstdRoundTrip)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  big_mesh_add(bfile->main);
+
+  char filepath[FILE_MAX];
+  temp_filepath("compression_zstd.blend", filepath, sizeof(filepath));
+  ASSERT_TRUE(blendfile_write(filepath, G_FILE_COMPRESS | G_FILE_COMPRESS_ZSTD));
+  EXPECT_TRUE(file_has_magic(filepath, zstd_magic, sizeof(zstd_magic)));
+
+  /* Large data is read on demand, which seeks back and forth across frames. */
+  ASSERT_TRUE(blendfile_reload(filepath));
+  EXPECT_TRUE(bfile->fileflags & G_FILE_COMPRESS);
+  EXPECT_TRUE(bfile->fileflags & G_FILE_COMPRESS_ZSTD);
+  big_mesh_check(bfile->main);
+
+  /* Saving again keeps the format, reading it back gives the same data. */
+  ASSERT_TRUE(blendfile_write(filepath, bfile->fileflags));
+  EXPECT_TRUE(file_has_magic(filepath, zstd_magic, sizeof(zstd_magic)));
+  ASSERT_TRUE(blendfile_reload(filepath));
+  big_mesh_check(bfile->main);
+
+  BLI_delete(filepath, false, false);
+}
+
+TEST_F(BlendfileCompressionTest, ZstdMissingSeekTable)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  char filepath[FILE_MAX];
+  temp_filepath("compression_zstd_full.blend", filepath, sizeof(filepath));
+  ASSERT_TRUE(blendfile_write(filepath, G_FILE_COMPRESS | G_FILE_COMPRESS_ZSTD));
+
+  size_t size = 0;
+  void *data = BLI_file_read_binary_as_mem(filepath, 0, &size);
+  ASSERT_NE(data, nullptr);
+  BLI_delete(filepath, false, false);
+
+  /* Cut off the seek table footer, the file can not be read without it. */
+  char filepath_truncated[FILE_MAX];
+  temp_filepath(
+      "compression_zstd_truncated.blend", filepath_truncated, sizeof(filepath_truncated));
+  FILE *file = BLI_fopen(filepath_truncated, "wb");
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(fwrite(data, 1, size - 9, file), size - 9);
+  fclose(file);
+  MEM_freeN(data);
+
+  blendfile_free();
+  EXPECT_EQ(BLO_read_from_file(filepath_truncated, BLO_READ_SKIP_NONE, nullptr), nullptr);
+
+  BLI_delete(filepath_truncated, false, false);
+}
+
+#else
+
+TEST_F(BlendfileCompressionTest, ZstdUnsupported)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  /* Never silently written in another format. */
+  char filepath[FILE_MAX];
+  temp_filepath("compression_zstd.blend", filepath, sizeof(filepath));
+  EXPECT_FALSE(blendfile_write(filepath, G_FILE_COMPRESS | G_FILE_COMPRESS_ZSTD));
+  EXPECT_FALSE(BLI_exists(filepath));
+}
+
+#endif /* WITH_ZSTD */
@@ -0,0 +1,193 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "DNA_ID.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_writefile.h"
+
+class BlendfileLazyLoadTest : public BlendfileLoadingBaseTest {
+ protected:
+  char filepath[FILE_MAX] = "";
+
+  static Object *object_add(Main *bmain, Scene *scene, const char *name, Mesh *me)
+  {
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+    ob->data = me;
+    id_us_plus(&me->id);
+    BKE_collection_object_add(bmain, scene->master_collection, ob);
+    return ob;
+  }
+
+  /**
+   * Write a file with a scene that is not active. It uses a mesh of its own, and one that is
+   * shared with the active scene.
+   */
+  bool lazy_file_write()
+  {
+    if (!blendfile_load("modifier_stack/array_test.blend")) {
+      return false;
+    }
+    Main *bmain = bfile->main;
+
+    Mesh *shared_mesh = BKE_mesh_add(bmain, "SharedMesh");
+    object_add(bmain, bfile->curscene, "ActiveObject", shared_mesh);
+
+    Scene *scene = BKE_scene_add(bmain, "OtherScene");
+    object_add(bmain, scene, "OtherObject", BKE_mesh_add(bmain, "OtherMesh"));
+    object_add(bmain, scene, "SharedObject", shared_mesh);
+
+    BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_session(), "lazy_load.blend", nullptr);
+    BlendFileWriteParams params = {};
+    params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+    const bool ok = BLO_write_file(bmain, filepath, 0, &params, nullptr);
+    blendfile_free();
+    return ok;
+  }
+
+  bool lazy_file_read()
+  {
+    bfile = BLO_read_from_file(filepath, BLO_READ_LAZY_IDS, nullptr);
+    return bfile != nullptr && bfile->main->lazy_filedata != nullptr;
+  }
+
+  void TearDown() override
+  {
+    BlendfileLoadingBaseTest::TearDown();
+    if (filepath[0] != '\0') {
+      BLI_delete(filepath, false, false);
+    }
+  }
+
+  ID *find(const short type, const char *name)
+  {
+    return BKE_libblock_find_name(bfile->main, type, name);
+  }
+};
+
+TEST_F(BlendfileLazyLoadTest, SkipAndLoad)
+{
+  if (!lazy_file_write()) {
+    return;
+  }
+  ASSERT_TRUE(lazy_file_read());
+
+  /* Only the data used by the active scene is read, lookups don't read anything. */
+  EXPECT_NE(find(ID_OB, "ActiveObject"), nullptr);
+  EXPECT_NE(find(ID_ME, "SharedMesh"), nullptr);
+  EXPECT_EQ(find(ID_SCE, "OtherScene"), nullptr);
+  EXPECT_EQ(find(ID_OB, "OtherObject"), nullptr);
+  EXPECT_EQ(find(ID_ME, "OtherMesh"), nullptr);
+
+  /* Loading a scene reads everything it uses and links it to the data read before. */
+  Scene *scene = reinterpret_cast<Scene *>(BLO_lazy_id_load(bfile->main, ID_SCE, "OtherScene"));
+  ASSERT_NE(scene, nullptr);
+  EXPECT_EQ(find(ID_SCE, "OtherScene"), &scene->id);
+
+  Object *ob = reinterpret_cast<Object *>(find(ID_OB, "OtherObject"));
+  ASSERT_NE(ob, nullptr);
+  EXPECT_EQ(ob->data, find(ID_ME, "OtherMesh"));
+  EXPECT_NE(ob->data, nullptr);
+  EXPECT_TRUE(BKE_collection_has_object(scene->master_collection, ob));
+
+  Object *ob_shared = reinterpret_cast<Object *>(find(ID_OB, "SharedObject"));
+  ASSERT_NE(ob_shared, nullptr);
+  EXPECT_EQ(ob_shared->data, find(ID_ME, "SharedMesh"));
+  EXPECT_EQ(reinterpret_cast<ID *>(ob_shared->data)->us, 2);
+
+  /* Already read, or not in the file at all. */
+  EXPECT_EQ(BLO_lazy_id_load(bfile->main, ID_SCE, "OtherScene"), nullptr);
+  EXPECT_EQ(BLO_lazy_id_load(bfile->main, ID_SCE, "NoSuchScene"), nullptr);
+}
+
+TEST_F(BlendfileLazyLoadTest, SaveReadsAll)
+{
+  if (!lazy_file_write()) {
+    return;
+  }
+  ASSERT_TRUE(lazy_file_read());
+
+  BlendFileWriteParams params = {};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+  ASSERT_TRUE(BLO_write_file(bfile->main, filepath, 0, &params, nullptr));
+  EXPECT_EQ(bfile->main->lazy_filedata, nullptr);
+  blendfile_free();
+
+  /* Nothing was lost when saving the partially read file. */
+  bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+  ASSERT_NE(bfile, nullptr);
+  EXPECT_NE(find(ID_SCE, "OtherScene"), nullptr);
+  Object *ob = reinterpret_cast<Object *>(find(ID_OB, "OtherObject"));
+  ASSERT_NE(ob, nullptr);
+  EXPECT_EQ(ob->data, find(ID_ME, "OtherMesh"));
+  EXPECT_NE(ob->data, nullptr);
+}
+
+TEST_F(BlendfileLazyLoadTest, NameCollision)
+{
+  if (!lazy_file_write()) {
+    return;
+  }
+  ASSERT_TRUE(lazy_file_read());
+
+  /* The name of a data-block that was skipped is still free. */
+  Mesh *me_local = BKE_mesh_add(bfile->main, "OtherMesh");
+  EXPECT_STREQ(me_local->id.name + 2, "OtherMesh");
+
+  /* The data-block read from the file gets renamed, the existing one keeps its name. */
+  BLO_lazy_id_load_all(bfile->main);
+  EXPECT_STREQ(me_local->id.name + 2, "OtherMesh");
+
+  Object *ob = reinterpret_cast<Object *>(find(ID_OB, "OtherObject"));
+  ASSERT_NE(ob, nullptr);
+  ASSERT_NE(ob->data, nullptr);
+  EXPECT_NE(ob->data, me_local);
+  EXPECT_STREQ(reinterpret_cast<ID *>(ob->data)->name + 2, "OtherMesh.001");
+}
+
+TEST_F(BlendfileLazyLoadTest, DeletedNotRestored)
+{
+  if (!lazy_file_write()) {
+    return;
+  }
+  ASSERT_TRUE(lazy_file_read());
+
+  /* Data-blocks read later must not link to data-blocks deleted in the meantime. */
+  BKE_id_delete(bfile->main, find(ID_ME, "SharedMesh"));
+  ASSERT_NE(BLO_lazy_id_load(bfile->main, ID_SCE, "OtherScene"), nullptr);
+  EXPECT_EQ(find(ID_ME, "SharedMesh"), nullptr);
+
+  Object *ob_shared = reinterpret_cast<Object *>(find(ID_OB, "SharedObject"));
+  ASSERT_NE(ob_shared, nullptr);
+  EXPECT_EQ(ob_shared->data, nullptr);
+}
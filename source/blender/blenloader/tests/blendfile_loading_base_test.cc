@@ -64,6 +64,7 @@ void BlendfileLoadingBaseTest::SetUpTestCase()
 
   BKE_idtype_init();
   BKE_appdir_init();
+  BKE_tempdir_init(nullptr);
   IMB_init();
   BKE_images_init();
   BKE_modifier_init();
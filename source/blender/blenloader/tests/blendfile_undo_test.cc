@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_undo_system.h" /* For #eUndoStepDir. */
+
+#include "BKE_blender_undo.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+
+#include "PIL_time.h"
+
+static void memfile_write(MemFile *memfile, MemFile *reference, const char *const *chunks, int len)
+{
+  MemFileWriteData mem_data = {};
+  if (reference != nullptr) {
+    BLO_memfile_clear_future(reference);
+  }
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  for (int i = 0; i < len; i++) {
+    BLO_memfile_chunk_add(&mem_data, chunks[i], strlen(chunks[i]));
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+TEST(memfile_chunk_store, SharedAcrossSteps)
+{
+  const char *step1[] = {"object A", "object B", "object C"};
+  /* Data inserted at the start shifts all the following chunks. */
+  const char *step2[] = {"object 0", "object A", "object B", "object C"};
+  /* Re-ordered data. */
+  const char *step3[] = {"object 0", "object C", "object B", "object A"};
+
+  MemFile memfile1 = {};
+  MemFile memfile2 = {};
+  MemFile memfile3 = {};
+  memfile_write(&memfile1, nullptr, step1, ARRAY_SIZE(step1));
+  memfile_write(&memfile2, &memfile1, step2, ARRAY_SIZE(step2));
+  memfile_write(&memfile3, &memfile2, step3, ARRAY_SIZE(step3));
+
+  /* Only the new chunk is stored for the later steps. */
+  EXPECT_EQ(memfile1.size, 3 * strlen("object A"));
+  EXPECT_EQ(memfile2.size, strlen("object 0"));
+  EXPECT_EQ(memfile3.size, 0u);
+
+  MemFileChunkStoreStats stats;
+  BLO_memfile_chunk_store_stats_get(&stats);
+  EXPECT_EQ(stats.chunks_num, 4u);
+  EXPECT_EQ(stats.stored_size, 4 * strlen("object A"));
+  EXPECT_EQ(stats.referenced_size, 11 * strlen("object A"));
+
+  /* `is_identical` only tells whether a chunk matches the chunk at the same position in the
+   * previous step, since that is what reading the undo step relies on. */
+  MemFileChunk *chunk1 = static_cast<MemFileChunk *>(memfile3.chunks.first);
+  MemFileChunk *chunk2 = static_cast<MemFileChunk *>(chunk1->next);
+  MemFileChunk *chunk3 = static_cast<MemFileChunk *>(chunk2->next);
+  EXPECT_TRUE(chunk1->is_identical);
+  EXPECT_FALSE(chunk2->is_identical);
+  EXPECT_TRUE(chunk3->is_identical);
+  EXPECT_EQ(chunk2->buf, static_cast<MemFileChunk *>(memfile1.chunks.last)->buf);
+
+  BLO_memfile_merge(&memfile1, &memfile2);
+  BLO_memfile_free(&memfile3);
+  BLO_memfile_chunk_store_stats_get(&stats);
+  EXPECT_EQ(stats.chunks_num, 4u);
+  EXPECT_EQ(stats.referenced_size, 4 * strlen("object A"));
+
+  BLO_memfile_free(&memfile2);
+  BLO_memfile_chunk_store_stats_get(&stats);
+  EXPECT_EQ(stats.chunks_num, 0u);
+  EXPECT_EQ(stats.stored_size, 0u);
+}
+
+class BlendfileUndoTest : public BlendfileLoadingBaseTest {
+};
+
+/* Edits of a recorded editing session, each of them is followed by a global undo push. */
+enum class SessionEdit {
+  MoveObject,
+  EditMesh,
+  RenameObject,
+  AddObject,
+  DeleteObject,
+};
+
+static void session_edit_apply(Main *bmain, const SessionEdit edit, const int step)
+{
+  Object *ob = static_cast<Object *>(bmain->objects.first);
+  switch (edit) {
+    case SessionEdit::MoveObject:
+      ob->loc[0] += 1.0f;
+      break;
+    case SessionEdit::EditMesh: {
+      Mesh *me = static_cast<Mesh *>(bmain->meshes.first);
+      if (me != nullptr) {
+        for (int i = 0; i < me->totvert; i++) {
+          me->mvert[i].co[2] += 0.1f;
+        }
+      }
+      break;
+    }
+    case SessionEdit::RenameObject: {
+      /* Objects are sorted by name, so this re-orders them. */
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Renamed.%03d", step);
+      BKE_libblock_rename(bmain, &ob->id, name);
+      break;
+    }
+    case SessionEdit::AddObject: {
+      /* Inserted before the other objects, shifting the data that follows it. */
+      char name[MAX_ID_NAME - 2];
+      BLI_snprintf(name, sizeof(name), "Added.%03d", step);
+      BKE_object_add_only_object(bmain, OB_EMPTY, name);
+      break;
+    }
+    case SessionEdit::DeleteObject:
+      if (ob->id.next != nullptr) {
+        BKE_id_delete(bmain, ob);
+      }
+      break;
+  }
+}
+
+TEST_F(BlendfileUndoTest, ReplayEditingSession)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  Main *bmain = bfile->main;
+
+  const SessionEdit session[] = {
+      SessionEdit::MoveObject,
+      SessionEdit::EditMesh,
+      SessionEdit::AddObject,
+      SessionEdit::MoveObject,
+      SessionEdit::RenameObject,
+      SessionEdit::EditMesh,
+      SessionEdit::AddObject,
+      SessionEdit::DeleteObject,
+      SessionEdit::MoveObject,
+      SessionEdit::RenameObject,
+  };
+  const int repeat = 10;
+
+  const double time_start = PIL_check_seconds_timer();
+
+  blender::Vector<MemFileUndoData *> steps;
+  steps.append(BKE_memfile_undo_encode(bmain, nullptr));
+  size_t undo_size = steps.last()->undo_size;
+  size_t written_size = steps.last()->memfile.size;
+  for (int i = 0; i < repeat; i++) {
+    for (const SessionEdit edit : session) {
+      session_edit_apply(bmain, edit, int(steps.size()));
+      steps.append(BKE_memfile_undo_encode(bmain, steps.last()));
+      undo_size += steps.last()->undo_size;
+      LISTBASE_FOREACH (MemFileChunk *, chunk, &steps.last()->memfile.chunks) {
+        written_size += chunk->size;
+      }
+    }
+  }
+
+  const double time_end = PIL_check_seconds_timer();
+
+  MemFileChunkStoreStats stats;
+  BLO_memfile_chunk_store_stats_get(&stats);
+  printf("Replayed %d undo steps in %.3f sec\n", int(steps.size()), time_end - time_start);
+  printf("  written: %zu bytes, stored: %zu bytes in %zu chunks, dedup ratio: %.2f\n",
+         stats.referenced_size,
+         stats.stored_size,
+         stats.chunks_num,
+         double(stats.referenced_size) / double(stats.stored_size));
+  printf("  positional hits: %zu, content hits: %zu\n",
+         stats.positional_dedup_num,
+         stats.content_dedup_num);
+
+  EXPECT_EQ(stats.referenced_size, written_size);
+  EXPECT_EQ(stats.stored_size, undo_size);
+  EXPECT_GT(stats.content_dedup_num, 0u);
+  EXPECT_LT(stats.stored_size, stats.referenced_size);
+
+  /* Free oldest first, like the undo system does when the stack is full. */
+  for (int i = 0; i < steps.size() - 1; i++) {
+    BLO_memfile_merge(&steps[i]->memfile, &steps[i + 1]->memfile);
+    MEM_freeN(steps[i]);
+  }
+  BKE_memfile_undo_free(steps.last());
+
+  BLO_memfile_chunk_store_stats_get(&stats);
+  EXPECT_EQ(stats.chunks_num, 0u);
+}
@@ -0,0 +1,180 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_BufferCache.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+
+#include "BLI_hash_mm2a.h"
+
+namespace blender::compositor {
+
+BufferCacheKeyBuilder::BufferCacheKeyBuilder(ParamsFn params_fn)
+    : m_params_fn(std::move(params_fn))
+{
+}
+
+const BufferCacheKey *BufferCacheKeyBuilder::get_key(NodeOperation *op)
+{
+  const std::unique_ptr<BufferCacheKey> *cached_key = m_keys.lookup_ptr(op);
+  if (cached_key) {
+    return cached_key->get();
+  }
+
+  std::unique_ptr<BufferCacheKey> key;
+  Vector<uint64_t> words;
+  Map<NodeOperation *, uint64_t> record_indices;
+  if (append_records(op, words, record_indices)) {
+    key = std::make_unique<BufferCacheKey>();
+    key->hash = BLI_hash_mm2_64(reinterpret_cast<const unsigned char *>(words.data()),
+                                words.size() * sizeof(uint64_t),
+                                0);
+    key->words = std::move(words);
+  }
+
+  const BufferCacheKey *result = key.get();
+  m_keys.add_new(op, std::move(key));
+  return result;
+}
+
+/** The returned pointer is only valid until parameters of another operation are requested. */
+const Vector<uint64_t> *BufferCacheKeyBuilder::get_params(NodeOperation *op)
+{
+  const std::optional<Vector<uint64_t>> *params = m_params.lookup_ptr(op);
+  if (params == nullptr) {
+    m_params.add_new(op, m_params_fn(op));
+    params = m_params.lookup_ptr(op);
+  }
+  return *params ? &**params : nullptr;
+}
+
+/**
+ * Append the records of given operation and of the operations it depends on that haven't been
+ * described yet. Returns false when one of them can't be identified.
+ */
+bool BufferCacheKeyBuilder::append_records(NodeOperation *op,
+                                           Vector<uint64_t> &words,
+                                           Map<NodeOperation *, uint64_t> &record_indices)
+{
+  if (record_indices.contains(op)) {
+    return true;
+  }
+
+  const int num_inputs = op->getNumberOfInputSockets();
+  for (int i = 0; i < num_inputs; i++) {
+    NodeOperation *input_op = op->getInputSocket(i)->getReader();
+    if (input_op == nullptr || !append_records(input_op, words, record_indices)) {
+      return false;
+    }
+  }
+
+  const Vector<uint64_t> *params = get_params(op);
+  if (params == nullptr) {
+    return false;
+  }
+
+  words.append(num_inputs);
+  for (int i = 0; i < num_inputs; i++) {
+    words.append(record_indices.lookup(op->getInputSocket(i)->getReader()));
+  }
+  words.append(params->size());
+  words.extend(*params);
+
+  record_indices.add_new(op, record_indices.size());
+  return true;
+}
+
+BufferCache::BufferCache()
+{
+  m_limiter = new_MEM_CacheLimiter(entry_destructor, entry_size);
+}
+
+BufferCache::~BufferCache()
+{
+  clear();
+  delete_MEM_CacheLimiter(m_limiter);
+}
+
+const MemoryBuffer *BufferCache::lookup(const BufferCacheKey &key, const rcti &render_area)
+{
+  Entry *entry = m_entries.lookup_default(key.hash, nullptr);
+  if (entry == nullptr || entry->key.words.as_span() != key.words.as_span() ||
+      !BLI_rcti_inside_rcti(&entry->render_area, &render_area)) {
+    return nullptr;
+  }
+  MEM_CacheLimiter_touch(entry->handle);
+  return entry->buffer.get();
+}
+
+void BufferCache::add(const BufferCacheKey &key,
+                      const rcti &render_area,
+                      const MemoryBuffer &buffer)
+{
+  Entry *previous_entry = m_entries.lookup_default(key.hash, nullptr);
+  if (previous_entry) {
+    remove_entry(previous_entry);
+  }
+
+  Entry *entry = new Entry();
+  entry->cache = this;
+  entry->key = key;
+  entry->render_area = render_area;
+  entry->buffer = std::make_unique<MemoryBuffer>(buffer);
+  m_entries.add_new(key.hash, entry);
+
+  /* Keep the new entry while freeing older ones. */
+  entry->handle = MEM_CacheLimiter_insert(m_limiter, entry);
+  MEM_CacheLimiter_ref(entry->handle);
+  MEM_CacheLimiter_enforce_limits(m_limiter);
+  MEM_CacheLimiter_unref(entry->handle);
+}
+
+void BufferCache::clear()
+{
+  Vector<Entry *> entries;
+  for (Entry *entry : m_entries.values()) {
+    entries.append(entry);
+  }
+  for (Entry *entry : entries) {
+    remove_entry(entry);
+  }
+}
+
+void BufferCache::remove_entry(Entry *entry)
+{
+  MEM_CacheLimiter_unmanage(entry->handle);
+  m_entries.remove(entry->key.hash);
+  delete entry;
+}
+
+/** Called by the cache limiter when freeing an entry to meet the memory limit. */
+void BufferCache::entry_destructor(void *data)
+{
+  Entry *entry = static_cast<Entry *>(data);
+  entry->cache->m_entries.remove(entry->key.hash);
+  delete entry;
+}
+
+size_t BufferCache::entry_size(void *data)
+{
+  const Entry *entry = static_cast<const Entry *>(data);
+  return sizeof(Entry) + entry->key.words.size() * sizeof(uint64_t) +
+         entry->buffer->get_memory_size();
+}
+
+}  // namespace blender::compositor
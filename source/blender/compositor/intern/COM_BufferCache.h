@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include "BLI_map.hh"
+#include "BLI_rect.h"
+#include "BLI_vector.hh"
+
+#include "MEM_CacheLimiterC-Api.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+class NodeOperation;
+
+/**
+ * Identifies the buffer rendered by an operation. The words describe the operation and all the
+ * operations it depends on, see #BufferCacheKeyBuilder. They are compared in full on lookup, the
+ * hash is only used to find the buffer.
+ */
+struct BufferCacheKey {
+  Vector<uint64_t> words;
+  uint64_t hash;
+};
+
+/**
+ * Builds the keys of operations. A key has a record for each operation the operation depends on,
+ * inputs before their readers, ending with the record of the operation itself:
+ * - The number of inputs, followed by the index of the record of each input.
+ * - The number of parameter words, followed by the words, see #NodeOperation::generate_params_key.
+ *
+ * Referring to inputs by index keeps their order, and an operation read more than once is
+ * described once, so swapped or duplicated inputs give different keys.
+ */
+class BufferCacheKeyBuilder {
+ public:
+  /** Parameter words of an operation, empty when its output can't be identified. */
+  using ParamsFn = std::function<std::optional<Vector<uint64_t>>(NodeOperation *)>;
+
+ private:
+  ParamsFn m_params_fn;
+  Map<NodeOperation *, std::optional<Vector<uint64_t>>> m_params;
+  /** Null for operations that can't be identified. */
+  Map<NodeOperation *, std::unique_ptr<BufferCacheKey>> m_keys;
+
+ public:
+  explicit BufferCacheKeyBuilder(ParamsFn params_fn);
+
+  /**
+   * Get the key of the output of given operation, null when the operation or one of its
+   * dependencies has no parameter words or an unconnected input.
+   */
+  const BufferCacheKey *get_key(NodeOperation *op);
+
+ private:
+  const Vector<uint64_t> *get_params(NodeOperation *op);
+  bool append_records(NodeOperation *op,
+                      Vector<uint64_t> &words,
+                      Map<NodeOperation *, uint64_t> &record_indices);
+};
+
+/**
+ * Keeps buffers rendered by the full frame execution model between executions of the
+ * compositor, so that operations whose inputs and parameters didn't change don't have to be
+ * rendered again. Buffers are identified by the key of the operation that rendered them, see
+ * #BufferCacheKeyBuilder.
+ *
+ * Memory usage is limited by #MEM_CacheLimiter (the memory cache limit of the user preferences),
+ * the least recently used buffers are freed first.
+ */
+class BufferCache {
+ private:
+  struct Entry {
+    BufferCache *cache;
+    BufferCacheKey key;
+    /** Area of the buffer that has been rendered, the rest is black. */
+    rcti render_area;
+    std::unique_ptr<MemoryBuffer> buffer;
+    MEM_CacheLimiterHandleC *handle;
+  };
+
+  MEM_CacheLimiterC *m_limiter;
+  Map<uint64_t, Entry *> m_entries;
+
+ public:
+  BufferCache();
+  ~BufferCache();
+
+  /**
+   * Get the cached buffer rendered by an operation with given key, or null when there is none
+   * or its rendered area doesn't contain \a render_area.
+   */
+  const MemoryBuffer *lookup(const BufferCacheKey &key, const rcti &render_area);
+
+  /**
+   * Add a copy of \a buffer, replacing a previous buffer with the same key hash.
+   */
+  void add(const BufferCacheKey &key, const rcti &render_area, const MemoryBuffer &buffer);
+
+  void clear();
+
+ private:
+  void remove_entry(Entry *entry);
+
+  static void entry_destructor(void *data);
+  static size_t entry_size(void *data);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:BufferCache")
+#endif
+};
+
+}  // namespace blender::compositor
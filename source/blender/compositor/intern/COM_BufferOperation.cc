@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_BufferOperation.h"
+
+namespace blender::compositor {
+
+BufferOperation::BufferOperation(MemoryBuffer *buffer, DataType data_type)
+{
+  m_buffer = buffer;
+  m_inflated_buffer = nullptr;
+  unsigned int resolution[2];
+  resolution[0] = buffer->getWidth();
+  resolution[1] = buffer->getHeight();
+  setResolution(resolution);
+  addOutputSocket(data_type);
+  initMutex();
+}
+
+BufferOperation::~BufferOperation()
+{
+  deinitMutex();
+  delete m_inflated_buffer;
+}
+
+void *BufferOperation::initializeTileData(rcti * /*rect*/)
+{
+  if (!m_buffer->is_a_single_elem()) {
+    return m_buffer;
+  }
+
+  /* Complex operations read tile data buffers directly, inflate single element buffers. */
+  lockMutex();
+  if (m_inflated_buffer == nullptr) {
+    m_inflated_buffer = m_buffer->inflate();
+  }
+  unlockMutex();
+  return m_inflated_buffer;
+}
+
+void BufferOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+  if (m_buffer->is_a_single_elem()) {
+    /* Same value for any coordinates, as set operations return. */
+    memcpy(output, m_buffer->getBuffer(), sizeof(float) * m_buffer->get_num_channels());
+    return;
+  }
+
+  switch (sampler) {
+    case PixelSampler::Nearest:
+      m_buffer->read(output, x, y);
+      break;
+    case PixelSampler::Bilinear:
+    default:
+      m_buffer->readBilinear(output, x, y);
+      break;
+    case PixelSampler::Bicubic:
+      /* No bicubic. Same implementation as ReadBufferOperation. */
+      m_buffer->readBilinear(output, x, y);
+      break;
+  }
+}
+
+void BufferOperation::executePixelFiltered(
+    float output[4], float x, float y, float dx[2], float dy[2])
+{
+  if (m_buffer->is_a_single_elem()) {
+    memcpy(output, m_buffer->getBuffer(), sizeof(float) * m_buffer->get_num_channels());
+    return;
+  }
+
+  const float uv[2] = {x, y};
+  const float deriv[2][2] = {{dx[0], dx[1]}, {dy[0], dy[1]}};
+  m_buffer->readEWA(output, uv, deriv);
+}
+
+}  // namespace blender::compositor
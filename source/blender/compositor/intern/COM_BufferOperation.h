@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include "COM_NodeOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * Reads an already rendered memory buffer. Used by the full frame execution model to feed
+ * the rendered inputs buffers to operations rendered with their tiled implementation.
+ */
+class BufferOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+  /** Full size copy of single element buffers, created when a tile of it is requested. */
+  MemoryBuffer *m_inflated_buffer;
+
+ public:
+  BufferOperation(MemoryBuffer *buffer, DataType data_type);
+  ~BufferOperation();
+
+  void *initializeTileData(rcti *rect) override;
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+  void executePixelFiltered(float output[4], float x, float y, float dx[2], float dy[2]) override;
+};
+
+}  // namespace blender::compositor
@@ -28,6 +28,7 @@ CompositorContext::CompositorContext()
 {
   this->m_scene = nullptr;
   this->m_rd = nullptr;
+  this->m_bnodetree = nullptr;
   this->m_quality = eCompositorQuality::High;
   this->m_hasActiveOpenCLDevices = false;
   this->m_fastCalculation = false;
@@ -41,4 +42,19 @@ int CompositorContext::getFramenumber() const
   return m_rd->cfra;
 }
 
+eExecutionModel CompositorContext::get_execution_model() const
+{
+  if (this->m_bnodetree != nullptr) {
+    switch (this->m_bnodetree->execution_mode) {
+      case NTREE_EXECUTION_MODE_TILED:
+        return eExecutionModel::Tiled;
+      case NTREE_EXECUTION_MODE_FULL_FRAME:
+        return eExecutionModel::FullFrame;
+      default:
+        BLI_assert(!"Invalid execution mode");
+    }
+  }
+  return eExecutionModel::Tiled;
+}
+
 }  // namespace blender::compositor
@@ -270,9 +270,16 @@ class CompositorContext {
   }
   bool isGroupnodeBufferEnabled() const
   {
-    return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
+    /* Group node buffers only make sense when operations are rendered in tiles. */
+    return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0 &&
+           this->get_execution_model() == eExecutionModel::Tiled;
   }
 
+  /**
+   * \brief get the execution model of the compositor, set by the editing tree.
+   */
+  eExecutionModel get_execution_model() const;
+
   /**
    * \brief Get the render percentage as a factor.
    * The compositor uses a factor i.o. a percentage.
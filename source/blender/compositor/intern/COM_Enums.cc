@@ -58,4 +58,19 @@ std::ostream &operator<<(std::ostream &os, const eWorkPackageState &execution_st
   return os;
 }
 
+std::ostream &operator<<(std::ostream &os, const eExecutionModel &execution_model)
+{
+  switch (execution_model) {
+    case eExecutionModel::Tiled: {
+      os << "ExecutionModel::Tiled";
+      break;
+    }
+    case eExecutionModel::FullFrame: {
+      os << "ExecutionModel::FullFrame";
+      break;
+    }
+  }
+  return os;
+}
+
 }  // namespace blender::compositor
@@ -51,6 +51,39 @@ enum class eCompositorPriority {
   Low = 0,
 };
 
+/**
+ * \brief Possible execution models of the compositor
+ * \see CompositorContext.get_execution_model
+ * \ingroup Execution
+ */
+enum class eExecutionModel {
+  /**
+   * \brief Operations are executed from outputs to inputs grouped in execution groups and
+   * rendered in tiles.
+   */
+  Tiled,
+  /**
+   * \brief Operations are fully rendered in order from inputs to outputs, each one storing its
+   * whole result in a memory buffer.
+   */
+  FullFrame,
+};
+
+/**
+ * \brief the type of a WorkPackage
+ * \ingroup Execution
+ */
+enum class eWorkPackageType {
+  /**
+   * \brief Executes a chunk of the output operation of an ExecutionGroup.
+   */
+  Tile = 0,
+  /**
+   * \brief Executes the custom function of the WorkPackage.
+   */
+  CustomFunction = 1,
+};
+
 /**
  * \brief the execution state of a chunk in an ExecutionGroup
  * \ingroup Execution
@@ -72,5 +105,6 @@ enum class eWorkPackageState {
 
 std::ostream &operator<<(std::ostream &os, const eCompositorPriority &priority);
 std::ostream &operator<<(std::ostream &os, const eWorkPackageState &execution_state);
+std::ostream &operator<<(std::ostream &os, const eExecutionModel &execution_model);
 
 }  // namespace blender::compositor
@@ -23,14 +23,14 @@
 
 #include "BKE_node.h"
 
-#include "BLT_translation.h"
-
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
-#include "COM_ReadBufferOperation.h"
+#include "COM_TiledExecutionModel.h"
+#include "COM_WorkPackage.h"
 #include "COM_WorkScheduler.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -46,7 +46,8 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
                                  bool fastcalculation,
                                  const ColorManagedViewSettings *viewSettings,
                                  const ColorManagedDisplaySettings *displaySettings,
-                                 const char *viewName)
+                                 const char *viewName,
+                                 BufferCache *buffer_cache)
 {
   this->m_context.setViewName(viewName);
   this->m_context.setScene(scene);
@@ -61,8 +62,10 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     this->m_context.setQuality((eCompositorQuality)editingtree->edit_quality);
   }
   this->m_context.setRendering(rendering);
-  this->m_context.setHasActiveOpenCLDevices(WorkScheduler::has_gpu_devices() &&
-                                            (editingtree->flag & NTREE_COM_OPENCL));
+  /* OpenCL is only supported when rendering in tiles. */
+  this->m_context.setHasActiveOpenCLDevices(
+      WorkScheduler::has_gpu_devices() && (editingtree->flag & NTREE_COM_OPENCL) &&
+      m_context.get_execution_model() == eExecutionModel::Tiled);
 
   this->m_context.setRenderData(rd);
   this->m_context.setViewSettings(viewSettings);
@@ -73,41 +76,31 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     builder.convertToOperations(this);
   }
 
-  unsigned int resolution[2];
-
-  rctf *viewer_border = &editingtree->viewer_border;
-  bool use_viewer_border = (editingtree->flag & NTREE_VIEWER_BORDER) &&
-                           viewer_border->xmin < viewer_border->xmax &&
-                           viewer_border->ymin < viewer_border->ymax;
-
-  editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Determining resolution"));
-
-  for (ExecutionGroup *executionGroup : m_groups) {
-    resolution[0] = 0;
-    resolution[1] = 0;
-    executionGroup->determineResolution(resolution);
-
-    if (rendering) {
-      /* case when cropping to render border happens is handled in
-       * compositor output and render layer nodes
-       */
-      if ((rd->mode & R_BORDER) && !(rd->mode & R_CROP)) {
-        executionGroup->setRenderBorder(
-            rd->border.xmin, rd->border.xmax, rd->border.ymin, rd->border.ymax);
-      }
-    }
-
-    if (use_viewer_border) {
-      executionGroup->setViewerBorder(
-          viewer_border->xmin, viewer_border->xmax, viewer_border->ymin, viewer_border->ymax);
-    }
+  switch (m_context.get_execution_model()) {
+    case eExecutionModel::Tiled:
+      m_execution_model = new TiledExecutionModel(m_context, m_operations, m_groups);
+      break;
+    case eExecutionModel::FullFrame:
+      m_execution_model = new FullFrameExecutionModel(m_context, m_operations, buffer_cache);
+      break;
+    default:
+      BLI_assert(!"Non implemented execution model");
+      break;
   }
 
+  BLI_mutex_init(&m_work_mutex);
+  BLI_condition_init(&m_work_finished_cond);
+
   //  DebugInfo::graphviz(this);
 }
 
 ExecutionSystem::~ExecutionSystem()
 {
+  BLI_condition_end(&m_work_finished_cond);
+  BLI_mutex_end(&m_work_mutex);
+
+  delete m_execution_model;
+
   for (NodeOperation *operation : m_operations) {
     delete operation;
   }
@@ -126,100 +119,78 @@ void ExecutionSystem::set_operations(const Vector<NodeOperation *> &operations,
   m_groups = groups;
 }
 
-static void update_read_buffer_offset(Vector<NodeOperation *> &operations)
-{
-  unsigned int order = 0;
-  for (NodeOperation *operation : operations) {
-    if (operation->get_flags().is_read_buffer_operation) {
-      ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
-      readOperation->setOffset(order);
-      order++;
-    }
-  }
-}
-
-static void init_write_operations_for_execution(Vector<NodeOperation *> &operations,
-                                                const bNodeTree *bTree)
-{
-  for (NodeOperation *operation : operations) {
-    if (operation->get_flags().is_write_buffer_operation) {
-      operation->setbNodeTree(bTree);
-      operation->initExecution();
-    }
-  }
-}
-
-static void link_write_buffers(Vector<NodeOperation *> &operations)
+void ExecutionSystem::execute()
 {
-  for (NodeOperation *operation : operations) {
-    if (operation->get_flags().is_read_buffer_operation) {
-      ReadBufferOperation *readOperation = static_cast<ReadBufferOperation *>(operation);
-      readOperation->updateMemoryBuffer();
-    }
-  }
+  DebugInfo::execute_started(this);
+  m_execution_model->execute(*this);
 }
 
-static void init_non_write_operations_for_execution(Vector<NodeOperation *> &operations,
-                                                    const bNodeTree *bTree)
+void ExecutionSystem::execute_work(const rcti &work_rect,
+                                   std::function<void(const rcti &split_rect)> work_func)
 {
-  for (NodeOperation *operation : operations) {
-    if (!operation->get_flags().is_write_buffer_operation) {
-      operation->setbNodeTree(bTree);
-      operation->initExecution();
-    }
+  if (is_breaked()) {
+    return;
   }
-}
 
-static void init_execution_groups_for_execution(Vector<ExecutionGroup *> &groups,
-                                                const int chunk_size)
-{
-  for (ExecutionGroup *execution_group : groups) {
-    execution_group->setChunksize(chunk_size);
-    execution_group->initExecution();
+  /* Split work vertically to maximize continuous memory. */
+  const int work_height = BLI_rcti_size_y(&work_rect);
+  const int num_sub_works = MIN2(WorkScheduler::get_num_cpu_threads(), work_height);
+  if (num_sub_works <= 0) {
+    return;
   }
-}
 
-void ExecutionSystem::execute()
-{
-  const bNodeTree *editingtree = this->m_context.getbNodeTree();
-  editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Initializing execution"));
+  const int split_height = work_height / num_sub_works;
+  int remaining_height = work_height - split_height * num_sub_works;
 
-  DebugInfo::execute_started(this);
-  update_read_buffer_offset(m_operations);
-
-  init_write_operations_for_execution(m_operations, m_context.getbNodeTree());
-  link_write_buffers(m_operations);
-  init_non_write_operations_for_execution(m_operations, m_context.getbNodeTree());
-  init_execution_groups_for_execution(m_groups, m_context.getChunksize());
-
-  WorkScheduler::start(this->m_context);
-  execute_groups(eCompositorPriority::High);
-  if (!this->getContext().isFastCalculation()) {
-    execute_groups(eCompositorPriority::Medium);
-    execute_groups(eCompositorPriority::Low);
-  }
-  WorkScheduler::finish();
-  WorkScheduler::stop();
+  Vector<WorkPackage> sub_works(num_sub_works);
+  int sub_work_y = work_rect.ymin;
+  int num_sub_works_finished = 0;
+  for (int i = 0; i < num_sub_works; i++) {
+    int sub_work_height = split_height;
 
-  editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
+    /* Distribute remaining height between sub-works. */
+    if (remaining_height > 0) {
+      sub_work_height++;
+      remaining_height--;
+    }
 
-  for (NodeOperation *operation : m_operations) {
-    operation->deinitExecution();
+    WorkPackage &sub_work = sub_works[i];
+    sub_work.type = eWorkPackageType::CustomFunction;
+    BLI_rcti_init(&sub_work.rect,
+                  work_rect.xmin,
+                  work_rect.xmax,
+                  sub_work_y,
+                  sub_work_y + sub_work_height);
+    sub_work.execute_fn = [this, &work_func, &sub_work]() {
+      if (!is_breaked()) {
+        work_func(sub_work.rect);
+      }
+    };
+    sub_work.executed_fn = [this, &num_sub_works_finished, num_sub_works]() {
+      BLI_mutex_lock(&m_work_mutex);
+      num_sub_works_finished++;
+      if (num_sub_works_finished == num_sub_works) {
+        BLI_condition_notify_one(&m_work_finished_cond);
+      }
+      BLI_mutex_unlock(&m_work_mutex);
+    };
+    WorkScheduler::schedule(&sub_work);
+    sub_work_y += sub_work_height;
   }
+  BLI_assert(sub_work_y == work_rect.ymax);
 
-  for (ExecutionGroup *execution_group : m_groups) {
-    execution_group->deinitExecution();
+  /* Wait for all sub-works to finish. */
+  BLI_mutex_lock(&m_work_mutex);
+  while (num_sub_works_finished < num_sub_works) {
+    BLI_condition_wait(&m_work_finished_cond, &m_work_mutex);
   }
+  BLI_mutex_unlock(&m_work_mutex);
 }
 
-void ExecutionSystem::execute_groups(eCompositorPriority priority)
+bool ExecutionSystem::is_breaked() const
 {
-  for (ExecutionGroup *execution_group : m_groups) {
-    if (execution_group->get_flags().is_output &&
-        execution_group->getRenderPriority() == priority) {
-      execution_group->execute(this);
-    }
-  }
+  const bNodeTree *btree = m_context.getbNodeTree();
+  return btree->test_break && btree->test_break(btree->tbh);
 }
 
 }  // namespace blender::compositor
@@ -23,16 +23,22 @@ class ExecutionGroup;
 #include "BKE_text.h"
 
 #include "COM_ExecutionGroup.h"
+#include "COM_ExecutionModel.h"
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
 
 #include "DNA_color_types.h"
 #include "DNA_node_types.h"
 
+#include "BLI_threads.h"
 #include "BLI_vector.hh"
 
+#include <functional>
+
 namespace blender::compositor {
 
+class BufferCache;
+
 /**
  * \page execution Execution model
  * In order to get to an efficient model for execution, several steps are being done. these steps
@@ -136,6 +142,17 @@ class ExecutionSystem {
    */
   Vector<ExecutionGroup *> m_groups;
 
+  /**
+   * Active execution model implementation.
+   */
+  ExecutionModel *m_execution_model;
+
+  /**
+   * Used to wait for the work executed by #execute_work.
+   */
+  ThreadMutex m_work_mutex;
+  ThreadCondition m_work_finished_cond;
+
  private:  // methods
  public:
   /**
@@ -144,6 +161,7 @@ class ExecutionSystem {
    *
    * \param editingtree: [bNodeTree *]
    * \param rendering: [true false]
+   * \param buffer_cache: buffers of previous executions to reuse, may be null.
    */
   ExecutionSystem(RenderData *rd,
                   Scene *scene,
@@ -152,7 +170,8 @@ class ExecutionSystem {
                   bool fastcalculation,
                   const ColorManagedViewSettings *viewSettings,
                   const ColorManagedDisplaySettings *displaySettings,
-                  const char *viewName);
+                  const char *viewName,
+                  BufferCache *buffer_cache = nullptr);
 
   /**
    * Destructor
@@ -163,13 +182,20 @@ class ExecutionSystem {
                       const Vector<ExecutionGroup *> &groups);
 
   /**
-   * \brief execute this system
-   * - initialize the NodeOperation's and ExecutionGroup's
-   * - schedule the output ExecutionGroup's based on their priority
-   * - deinitialize the ExecutionGroup's and NodeOperation's
+   * \brief execute this system using the execution model of the editing tree
+   * \see TiledExecutionModel
+   * \see FullFrameExecutionModel
    */
   void execute();
 
+  /**
+   * Multi-threadedly execute given work function passing work_rect splits as argument. Waits
+   * until all splits have been executed.
+   */
+  void execute_work(const rcti &work_rect, std::function<void(const rcti &split_rect)> work_func);
+
+  bool is_breaked() const;
+
   /**
    * \brief get the reference to the compositor context
    */
@@ -179,8 +205,6 @@ class ExecutionSystem {
   }
 
  private:
-  void execute_groups(eCompositorPriority priority);
-
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -0,0 +1,387 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_FullFrameExecutionModel.h"
+#include "COM_BufferCache.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_WorkScheduler.h"
+
+#include "BLI_hash_mm2a.h"
+#include "BLI_set.hh"
+#include "BLI_string.h"
+
+#include "BLT_translation.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
+                                                 Span<NodeOperation *> operations,
+                                                 BufferCache *buffer_cache)
+    : ExecutionModel(context, operations),
+      m_num_operations_finished(0),
+      m_buffer_cache(buffer_cache),
+      m_operation_keys([this](NodeOperation *op) { return get_operation_params_key(op); })
+{
+  m_priorities.append(eCompositorPriority::High);
+  if (!context.isFastCalculation()) {
+    m_priorities.append(eCompositorPriority::Medium);
+    m_priorities.append(eCompositorPriority::Low);
+  }
+}
+
+void FullFrameExecutionModel::execute(ExecutionSystem &exec_system)
+{
+  const bNodeTree *node_tree = this->m_context.getbNodeTree();
+  node_tree->stats_draw(node_tree->sdh, TIP_("Compositing | Initializing execution"));
+
+  for (NodeOperation *op : m_operations) {
+    op->setbNodeTree(node_tree);
+    op->set_execution_system(&exec_system);
+  }
+
+  determine_areas_to_render_and_reads();
+
+  WorkScheduler::start(this->m_context);
+  render_operations(exec_system);
+  WorkScheduler::stop();
+}
+
+void FullFrameExecutionModel::determine_areas_to_render_and_reads()
+{
+  const bool is_rendering = m_context.isRendering();
+  for (eCompositorPriority priority : m_priorities) {
+    for (NodeOperation *op : m_operations) {
+      if (op->isOutputOperation(is_rendering) && op->getRenderPriority() == priority) {
+        rcti area;
+        get_output_render_area(op, area);
+        determine_areas_to_render(op, area);
+        determine_reads(op);
+      }
+    }
+  }
+}
+
+void FullFrameExecutionModel::render_operations(ExecutionSystem &exec_system)
+{
+  const bool is_rendering = m_context.isRendering();
+  for (eCompositorPriority priority : m_priorities) {
+    for (NodeOperation *op : m_operations) {
+      if (op->isOutputOperation(is_rendering) && op->getRenderPriority() == priority) {
+        render_output_dependencies(op, exec_system);
+      }
+    }
+  }
+}
+
+/**
+ * Returns all dependencies of given operation, including itself, in the order they have to be
+ * rendered: inputs before the operations reading them. Operations already rendered or loaded from
+ * the cache are not included, nor are their inputs.
+ */
+Vector<NodeOperation *> FullFrameExecutionModel::get_operation_dependencies(
+    NodeOperation *operation)
+{
+  Vector<NodeOperation *> dependencies;
+  Set<NodeOperation *> visited;
+  /* Each stack item is an operation and the index of the next input to visit. */
+  Vector<std::pair<NodeOperation *, int>> stack;
+  stack.append({operation, 0});
+  visited.add(operation);
+  while (!stack.is_empty()) {
+    std::pair<NodeOperation *, int> &item = stack.last();
+    NodeOperation *op = item.first;
+    if (item.second < (int)op->getNumberOfInputSockets()) {
+      NodeOperation *input_op = op->getInputSocket(item.second)->getReader();
+      item.second++;
+      if (input_op && visited.add(input_op) && !load_cached_buffer(input_op)) {
+        stack.append({input_op, 0});
+      }
+    }
+    else {
+      dependencies.append(op);
+      stack.remove_last();
+    }
+  }
+  return dependencies;
+}
+
+void FullFrameExecutionModel::render_output_dependencies(NodeOperation *output_op,
+                                                         ExecutionSystem &exec_system)
+{
+  BLI_assert(output_op->isOutputOperation(m_context.isRendering()));
+  Vector<NodeOperation *> dependencies = get_operation_dependencies(output_op);
+  for (NodeOperation *op : dependencies) {
+    if (exec_system.is_breaked()) {
+      return;
+    }
+    if (!m_active_buffers.is_operation_rendered(op)) {
+      render_operation(op);
+      if (!exec_system.is_breaked()) {
+        cache_operation_buffer(op);
+      }
+    }
+  }
+}
+
+void FullFrameExecutionModel::render_operation(NodeOperation *op)
+{
+  const bool has_outputs = op->getNumberOfOutputSockets() > 0;
+  MemoryBuffer *op_buf = has_outputs ? create_operation_buffer(op) : nullptr;
+  const rcti &render_area = m_active_buffers.get_render_area(op);
+  if (has_outputs && !BLI_rcti_compare(&render_area, &op_buf->get_rect())) {
+    /* Areas out of the render area may be read by interpolation, keep them black. */
+    op_buf->clear();
+  }
+
+  Vector<MemoryBuffer *> input_bufs = get_input_buffers(op);
+  op->render(op_buf, render_area, input_bufs);
+
+  m_active_buffers.set_rendered_buffer(op, std::unique_ptr<MemoryBuffer>(op_buf));
+  operation_finished(op);
+}
+
+/**
+ * Returns the parameter words identifying given operation in its #BufferCacheKey, empty when
+ * the operation can't be identified. Operations without inputs that don't output a constant are
+ * rendered to hash their buffer.
+ */
+std::optional<Vector<uint64_t>> FullFrameExecutionModel::get_operation_params_key(
+    NodeOperation *op)
+{
+  if (op->getNumberOfInputSockets() > 0 || op->get_flags().is_set_operation) {
+    return op->generate_params_key();
+  }
+
+  /* The data of these operations comes from outside the compositor and may change without any
+   * of their parameters changing. They are cheap to render, hash the result instead. */
+  if (!m_active_buffers.is_operation_rendered(op)) {
+    render_operation(op);
+  }
+  MemoryBuffer *buf = m_active_buffers.get_rendered_buffer(op);
+  const uint64_t content_hash = BLI_hash_mm2_64(
+      reinterpret_cast<const unsigned char *>(buf->getBuffer()), buf->get_memory_size(), 0);
+  Vector<uint64_t> params_key;
+  params_key.append(content_hash);
+  params_key.append(buf->getWidth());
+  params_key.append(buf->getHeight());
+  params_key.append(buf->get_num_channels());
+  return params_key;
+}
+
+bool FullFrameExecutionModel::is_operation_cacheable(NodeOperation *op)
+{
+  /* Operations without inputs are rendered anyway to be hashed, constants are cheap. A cache hit
+   * skips the execution initialization, which other operations may depend on. */
+  return m_buffer_cache && op->getNumberOfInputSockets() > 0 &&
+         op->getNumberOfOutputSockets() > 0 && !op->get_flags().is_set_operation &&
+         !op->get_flags().has_init_side_effects;
+}
+
+/**
+ * Use the buffer of a previous execution when there is one for the given operation.
+ * Returns true when the operation doesn't have to be rendered.
+ */
+bool FullFrameExecutionModel::load_cached_buffer(NodeOperation *op)
+{
+  if (m_active_buffers.is_operation_rendered(op)) {
+    return true;
+  }
+  if (!is_operation_cacheable(op)) {
+    return false;
+  }
+
+  const BufferCacheKey *key = m_operation_keys.get_key(op);
+  if (key == nullptr) {
+    return false;
+  }
+  const MemoryBuffer *cached_buf = m_buffer_cache->lookup(*key,
+                                                          m_active_buffers.get_render_area(op));
+  if (cached_buf == nullptr) {
+    return false;
+  }
+
+  m_active_buffers.set_rendered_buffer(op, std::make_unique<MemoryBuffer>(*cached_buf));
+  /* Its inputs won't be read, report it so that their buffers may be freed. */
+  operation_finished(op);
+  return true;
+}
+
+void FullFrameExecutionModel::cache_operation_buffer(NodeOperation *op)
+{
+  if (!is_operation_cacheable(op)) {
+    return;
+  }
+  const BufferCacheKey *key = m_operation_keys.get_key(op);
+  if (key) {
+    m_buffer_cache->add(
+        *key, m_active_buffers.get_render_area(op), *m_active_buffers.get_rendered_buffer(op));
+  }
+}
+
+Vector<MemoryBuffer *> FullFrameExecutionModel::get_input_buffers(NodeOperation *op)
+{
+  const int num_inputs = op->getNumberOfInputSockets();
+  Vector<MemoryBuffer *> inputs_buffers(num_inputs);
+  for (int i = 0; i < num_inputs; i++) {
+    NodeOperation *input_op = op->getInputSocket(i)->getReader();
+    inputs_buffers[i] = input_op ? m_active_buffers.get_rendered_buffer(input_op) : nullptr;
+  }
+  return inputs_buffers;
+}
+
+MemoryBuffer *FullFrameExecutionModel::create_operation_buffer(NodeOperation *op)
+{
+  rcti op_rect;
+  BLI_rcti_init(&op_rect, 0, op->getWidth(), 0, op->getHeight());
+
+  const DataType data_type = op->getOutputSocket(0)->getDataType();
+  /* Set operations output a constant, a single element is enough to store it. */
+  const bool is_a_single_elem = op->get_flags().is_set_operation;
+  return new MemoryBuffer(data_type, op_rect, is_a_single_elem);
+}
+
+void FullFrameExecutionModel::operation_finished(NodeOperation *operation)
+{
+  /* Report inputs reads so that buffers may be freed/reused. */
+  const int num_inputs = operation->getNumberOfInputSockets();
+  for (int i = 0; i < num_inputs; i++) {
+    NodeOperation *input_op = operation->getInputSocket(i)->getReader();
+    if (input_op) {
+      m_active_buffers.read_finished(input_op);
+    }
+  }
+
+  m_num_operations_finished++;
+  update_progress_bar();
+}
+
+/**
+ * Calculates given output operation area to be rendered taking into account render/viewer
+ * borders.
+ */
+void FullFrameExecutionModel::get_output_render_area(NodeOperation *output_op, rcti &r_area)
+{
+  BLI_assert(output_op->isOutputOperation(m_context.isRendering()));
+
+  /* By default return operation bounds (no border). */
+  const int op_width = output_op->getWidth();
+  const int op_height = output_op->getHeight();
+  BLI_rcti_init(&r_area, 0, op_width, 0, op_height);
+
+  const bool has_viewer_border = m_border.use_viewer_border &&
+                                 output_op->get_flags().use_viewer_border;
+  const bool has_render_border = m_border.use_render_border &&
+                                 output_op->get_flags().use_render_border;
+  if (has_viewer_border || has_render_border) {
+    /* Get border with normalized coordinates. */
+    const rctf *norm_border = has_viewer_border ? m_border.viewer_border : m_border.render_border;
+
+    /* Return de-normalized border. */
+    BLI_rcti_init(&r_area,
+                  norm_border->xmin * op_width,
+                  norm_border->xmax * op_width,
+                  norm_border->ymin * op_height,
+                  norm_border->ymax * op_height);
+  }
+}
+
+/**
+ * Determines all operations areas needed to render given output area.
+ */
+void FullFrameExecutionModel::determine_areas_to_render(NodeOperation *output_op,
+                                                        const rcti &output_area)
+{
+  BLI_assert(output_op->isOutputOperation(m_context.isRendering()));
+
+  Vector<std::pair<NodeOperation *, rcti>> stack;
+  stack.append({output_op, output_area});
+  while (!stack.is_empty()) {
+    std::pair<NodeOperation *, rcti> pair = stack.pop_last();
+    NodeOperation *operation = pair.first;
+    const rcti &render_area = pair.second;
+    if (!m_active_buffers.extend_render_area(operation, render_area)) {
+      /* The area is already requested, as are the areas of interest of its inputs. */
+      continue;
+    }
+
+    const int num_inputs = operation->getNumberOfInputSockets();
+    for (int i = 0; i < num_inputs; i++) {
+      NodeOperation *input_op = operation->getInputSocket(i)->getReader();
+      if (input_op == nullptr) {
+        continue;
+      }
+      rcti input_op_rect, input_area;
+      BLI_rcti_init(&input_op_rect, 0, input_op->getWidth(), 0, input_op->getHeight());
+      operation->get_area_of_interest(i, render_area, input_area);
+
+      /* Ensure area of interest is within operation bounds, cropping areas outside. */
+      BLI_rcti_isect(&input_area, &input_op_rect, &input_area);
+
+      stack.append({input_op, input_area});
+    }
+  }
+}
+
+/**
+ * Determines the reads given operation and its inputs will receive (i.e: Number of dependent
+ * operations each operation has).
+ */
+void FullFrameExecutionModel::determine_reads(NodeOperation *output_op)
+{
+  BLI_assert(output_op->isOutputOperation(m_context.isRendering()));
+
+  Vector<NodeOperation *> stack;
+  stack.append(output_op);
+  while (!stack.is_empty()) {
+    NodeOperation *operation = stack.pop_last();
+    const int num_inputs = operation->getNumberOfInputSockets();
+    for (int i = 0; i < num_inputs; i++) {
+      NodeOperation *input_op = operation->getInputSocket(i)->getReader();
+      if (input_op == nullptr) {
+        continue;
+      }
+      if (!m_active_buffers.has_registered_reads(input_op)) {
+        stack.append(input_op);
+      }
+      m_active_buffers.register_read(input_op);
+    }
+  }
+}
+
+void FullFrameExecutionModel::update_progress_bar()
+{
+  const bNodeTree *tree = m_context.getbNodeTree();
+  if (tree) {
+    const float progress = m_num_operations_finished / static_cast<float>(m_operations.size());
+    tree->progress(tree->prh, progress);
+
+    char buf[128];
+    BLI_snprintf(buf,
+                 sizeof(buf),
+                 TIP_("Compositing | Operation %i-%i"),
+                 m_num_operations_finished,
+                 (int)m_operations.size());
+    tree->stats_draw(tree->sdh, buf);
+  }
+}
+
+}  // namespace blender::compositor
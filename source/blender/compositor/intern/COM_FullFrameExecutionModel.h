@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "COM_BufferCache.h"
+#include "COM_Enums.h"
+#include "COM_ExecutionModel.h"
+#include "COM_SharedOperationBuffers.h"
+
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+namespace blender::compositor {
+
+class MemoryBuffer;
+
+/**
+ * Fully renders operations in order from inputs to outputs. Each operation renders its whole
+ * area of interest into a memory buffer that is shared with all of its readers and freed once
+ * they have finished reading it.
+ *
+ * Rendered buffers are kept in a #BufferCache between executions. An operation is identified by
+ * its parameters together with the parameters and structure of the operations it depends on.
+ * Operations without inputs (images, render passes, constants...) are always rendered and
+ * identified by a hash of the content of their buffer instead. Operations found in the cache are
+ * not rendered, nor are the inputs only they read.
+ */
+class FullFrameExecutionModel : public ExecutionModel {
+ private:
+  /**
+   * Contains operations active buffers data. Buffers will be disposed once reader operations
+   * have finished reading them.
+   */
+  SharedOperationBuffers m_active_buffers;
+
+  /**
+   * Number of operations finished.
+   */
+  int m_num_operations_finished;
+
+  /**
+   * Order of priorities for output operations execution.
+   */
+  Vector<eCompositorPriority> m_priorities;
+
+  /**
+   * Buffers of previous executions, may be null.
+   */
+  BufferCache *m_buffer_cache;
+
+  /**
+   * Keys identifying the output of operations in the buffer cache.
+   */
+  BufferCacheKeyBuilder m_operation_keys;
+
+ public:
+  FullFrameExecutionModel(CompositorContext &context,
+                          Span<NodeOperation *> operations,
+                          BufferCache *buffer_cache);
+
+  void execute(ExecutionSystem &exec_system) override;
+
+ private:
+  void determine_areas_to_render_and_reads();
+  void render_operations(ExecutionSystem &exec_system);
+  void render_output_dependencies(NodeOperation *output_op, ExecutionSystem &exec_system);
+  void render_operation(NodeOperation *op);
+  Vector<NodeOperation *> get_operation_dependencies(NodeOperation *operation);
+
+  std::optional<Vector<uint64_t>> get_operation_params_key(NodeOperation *op);
+  bool is_operation_cacheable(NodeOperation *op);
+  bool load_cached_buffer(NodeOperation *op);
+  void cache_operation_buffer(NodeOperation *op);
+
+  Vector<MemoryBuffer *> get_input_buffers(NodeOperation *op);
+  MemoryBuffer *create_operation_buffer(NodeOperation *op);
+  void operation_finished(NodeOperation *operation);
+
+  void determine_areas_to_render(NodeOperation *output_op, const rcti &output_area);
+  void determine_reads(NodeOperation *output_op);
+  void get_output_render_area(NodeOperation *output_op, rcti &r_area);
+
+  void update_progress_bar();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
+
+}  // namespace blender::compositor
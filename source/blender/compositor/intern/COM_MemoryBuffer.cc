@@ -58,6 +58,19 @@ MemoryBuffer::MemoryBuffer(const MemoryBuffer &src)
   fill_from(src);
 }
 
+MemoryBuffer *MemoryBuffer::inflate() const
+{
+  BLI_assert(is_a_single_elem());
+  MemoryBuffer *inflated = new MemoryBuffer(this->m_datatype, this->m_rect, false);
+  float *dst = inflated->m_buffer;
+  const int num_elems = inflated->buffer_len();
+  for (int i = 0; i < num_elems; i++) {
+    memcpy(dst, this->m_buffer, this->m_num_channels * sizeof(float));
+    dst += this->m_num_channels;
+  }
+  return inflated;
+}
+
 void MemoryBuffer::set_strides()
 {
   if (m_is_a_single_elem) {
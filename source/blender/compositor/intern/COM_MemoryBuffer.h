@@ -223,6 +223,14 @@ class MemoryBuffer {
     return is_a_single_elem() ? 1 : getHeight();
   }
 
+  /**
+   * Get the size in bytes of the buffer data.
+   */
+  size_t get_memory_size() const
+  {
+    return sizeof(float) * (size_t)buffer_len() * m_num_channels;
+  }
+
   uint8_t get_num_channels()
   {
     return this->m_num_channels;
@@ -396,6 +404,12 @@ class MemoryBuffer {
 
   void readEWA(float *result, const float uv[2], const float derivatives[2][2]);
 
+  /**
+   * Create a full size copy of a single element buffer, for code reading the buffer memory
+   * directly. The caller owns the returned buffer.
+   */
+  MemoryBuffer *inflate() const;
+
   /**
    * \brief is this MemoryBuffer a temporarily buffer (based on an area, not on a chunk)
    */
@@ -19,6 +19,7 @@
 #include <cstdio>
 #include <typeinfo>
 
+#include "COM_BufferOperation.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_defines.h"
@@ -37,6 +38,8 @@ NodeOperation::NodeOperation()
   this->m_width = 0;
   this->m_height = 0;
   this->m_btree = nullptr;
+  this->m_exec_system = nullptr;
+  this->m_is_hash_output_params_implemented = false;
 }
 
 NodeOperationOutput *NodeOperation::getOutputSocket(unsigned int index)
@@ -175,6 +178,163 @@ bool NodeOperation::determineDependingAreaOfInterest(rcti *input,
   return !first;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Full Frame Methods
+ * \{ */
+
+void NodeOperation::get_area_of_interest(const int input_idx,
+                                         const rcti &output_area,
+                                         rcti &r_input_area)
+{
+  if (get_flags().is_fullframe_operation) {
+    r_input_area = output_area;
+  }
+  else {
+    /* Non full-frame operations never implement this method. To ensure correctness assume
+     * whole area is used. */
+    NodeOperation *input_op = getInputOperation(input_idx);
+    BLI_rcti_init(&r_input_area, 0, input_op->getWidth(), 0, input_op->getHeight());
+  }
+}
+
+void NodeOperation::render(MemoryBuffer *output_buf,
+                           const rcti &output_area,
+                           Span<MemoryBuffer *> inputs_bufs)
+{
+  if (get_flags().is_fullframe_operation) {
+    initExecution();
+    update_memory_buffer(output_buf, output_area, inputs_bufs);
+    deinitExecution();
+  }
+  else {
+    render_full_frame_fallback(output_buf, output_area, inputs_bufs);
+  }
+}
+
+std::optional<Vector<uint64_t>> NodeOperation::generate_params_key()
+{
+  m_params_key.clear();
+  m_params_key.append(typeid(*this).hash_code());
+  m_params_key.append(m_width);
+  m_params_key.append(m_height);
+
+  m_is_hash_output_params_implemented = true;
+  hash_output_params();
+  if (!m_is_hash_output_params_implemented) {
+    return std::nullopt;
+  }
+  return m_params_key;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Full Frame Fallback Methods
+ *
+ * Render operations that don't implement #NodeOperation::update_memory_buffer by reading
+ * their output pixel by pixel, as the tiled execution model does. Inputs are temporarily
+ * replaced by operations reading the already rendered input buffers.
+ * \{ */
+
+void NodeOperation::render_full_frame_fallback(MemoryBuffer *output_buf,
+                                               const rcti &output_area,
+                                               Span<MemoryBuffer *> inputs_bufs)
+{
+  Vector<NodeOperationOutput *> orig_input_links = replace_inputs_with_buffers(inputs_bufs);
+
+  initExecution();
+  const bool is_output_operation = getNumberOfOutputSockets() == 0;
+  if (!is_output_operation && output_buf->is_a_single_elem()) {
+    float *output_elem = output_buf->get_elem(0, 0);
+    readSampled(output_elem, 0, 0, PixelSampler::Nearest);
+  }
+  else {
+    auto render_split = [=](const rcti &split_rect) {
+      rcti tile_rect = split_rect;
+      if (is_output_operation) {
+        executeRegion(&tile_rect, 0);
+      }
+      else {
+        render_tile(output_buf, &tile_rect);
+      }
+    };
+    if (get_flags().single_threaded) {
+      render_split(output_area);
+    }
+    else {
+      m_exec_system->execute_work(output_area, render_split);
+    }
+  }
+  deinitExecution();
+
+  remove_buffers_and_restore_original_inputs(orig_input_links);
+}
+
+void NodeOperation::render_tile(MemoryBuffer *output_buf, rcti *tile_rect)
+{
+  const bool is_complex = get_flags().complex;
+  void *tile_data = is_complex ? initializeTileData(tile_rect) : nullptr;
+  const int elem_stride = output_buf->elem_stride;
+  for (int y = tile_rect->ymin; y < tile_rect->ymax; y++) {
+    float *output_elem = output_buf->get_elem(tile_rect->xmin, y);
+    if (is_complex) {
+      for (int x = tile_rect->xmin; x < tile_rect->xmax; x++) {
+        read(output_elem, x, y, tile_data);
+        output_elem += elem_stride;
+      }
+    }
+    else {
+      for (int x = tile_rect->xmin; x < tile_rect->xmax; x++) {
+        readSampled(output_elem, x, y, PixelSampler::Nearest);
+        output_elem += elem_stride;
+      }
+    }
+    if (isBraked()) {
+      break;
+    }
+  }
+  if (tile_data) {
+    deinitializeTileData(tile_rect, tile_data);
+  }
+}
+
+/**
+ * \return Replaced inputs links.
+ */
+Vector<NodeOperationOutput *> NodeOperation::replace_inputs_with_buffers(
+    Span<MemoryBuffer *> inputs_bufs)
+{
+  BLI_assert(inputs_bufs.size() == getNumberOfInputSockets());
+  Vector<NodeOperationOutput *> orig_links(inputs_bufs.size());
+  for (int i = 0; i < inputs_bufs.size(); i++) {
+    NodeOperationInput *input_socket = getInputSocket(i);
+    orig_links[i] = input_socket->getLink();
+    if (inputs_bufs[i] == nullptr) {
+      continue;
+    }
+    BufferOperation *buffer_op = new BufferOperation(inputs_bufs[i],
+                                                     orig_links[i]->getDataType());
+    input_socket->setLink(buffer_op->getOutputSocket());
+  }
+  return orig_links;
+}
+
+void NodeOperation::remove_buffers_and_restore_original_inputs(
+    Span<NodeOperationOutput *> original_inputs_links)
+{
+  BLI_assert(original_inputs_links.size() == getNumberOfInputSockets());
+  for (int i = 0; i < original_inputs_links.size(); i++) {
+    NodeOperationInput *input = getInputSocket(i);
+    if (input->getLink() != original_inputs_links[i]) {
+      NodeOperation *buffer_op = &input->getLink()->getOperation();
+      input->setLink(original_inputs_links[i]);
+      delete buffer_op;
+    }
+  }
+}
+
+/** \} */
+
 /*****************
  **** OpInput ****
  *****************/
@@ -267,6 +427,12 @@ std::ostream &operator<<(std::ostream &os, const NodeOperationFlags &node_operat
   if (!node_operation_flags.use_datatype_conversion) {
     os << "no_conversion,";
   }
+  if (node_operation_flags.is_fullframe_operation) {
+    os << "full_frame,";
+  }
+  if (node_operation_flags.has_init_side_effects) {
+    os << "init_side_effects,";
+  }
 
   return os;
 }
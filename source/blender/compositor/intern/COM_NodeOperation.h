@@ -19,12 +19,17 @@
 #pragma once
 
 #include <list>
+#include <optional>
 #include <sstream>
 #include <string>
 
+#include "BLI_hash.hh"
+#include "BLI_hash_mm2a.h"
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_span.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "COM_Enums.h"
 #include "COM_MemoryBuffer.h"
@@ -37,6 +42,7 @@
 namespace blender::compositor {
 
 class OpenCLDevice;
+class ExecutionSystem;
 class ReadBufferOperation;
 class WriteBufferOperation;
 
@@ -232,6 +238,19 @@ struct NodeOperationFlags {
    */
   bool use_datatype_conversion : 1;
 
+  /**
+   * Does the operation implement #NodeOperation::update_memory_buffer, rendering its output
+   * directly from its inputs buffers when executed by the full frame execution model.
+   * Operations that don't are rendered pixel by pixel using their tiled implementation.
+   */
+  bool is_fullframe_operation : 1;
+
+  /**
+   * Does #NodeOperation::initExecution change the state of other operations. Loading the output
+   * of such an operation from the buffer cache would skip it, so it's always rendered.
+   */
+  bool has_init_side_effects : 1;
+
   NodeOperationFlags()
   {
     complex = false;
@@ -247,6 +266,8 @@ struct NodeOperationFlags {
     is_viewer_operation = false;
     is_preview_operation = false;
     use_datatype_conversion = true;
+    is_fullframe_operation = false;
+    has_init_side_effects = false;
   }
 };
 
@@ -284,7 +305,19 @@ class NodeOperation {
    */
   const bNodeTree *m_btree;
 
+  /**
+   * Type, resolution and hashed parameters of the operation, see #generate_params_key.
+   */
+  Vector<uint64_t> m_params_key;
+  bool m_is_hash_output_params_implemented;
+
  protected:
+  /**
+   * Execution system the operation is being rendered by. Only set when using the full frame
+   * execution model.
+   */
+  ExecutionSystem *m_exec_system;
+
   /**
    * Width of the output of this operation.
    */
@@ -537,6 +570,48 @@ class NodeOperation {
     return std::unique_ptr<MetaData>();
   }
 
+  /* -------------------------------------------------------------------- */
+  /** \name Full Frame Methods
+   * \{ */
+
+  void set_execution_system(ExecutionSystem *system)
+  {
+    m_exec_system = system;
+  }
+
+  /**
+   * Get the area of the input at \a input_idx that is read when rendering \a output_area.
+   * By default full frame operations read the same area and tiled operations their whole
+   * inputs, as their reads can't be known in advance.
+   */
+  virtual void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area);
+
+  /**
+   * Render \a output_area of this operation into \a output_buf. \a inputs_bufs contain the
+   * rendered inputs in the same order as the input sockets, \a output_buf is null for
+   * operations without outputs.
+   */
+  void render(MemoryBuffer *output_buf, const rcti &output_area, Span<MemoryBuffer *> inputs_bufs);
+
+  /**
+   * Executes the operation updating \a area of its \a output buffer. Called once per render
+   * in the main thread, see #MultiThreadedOperation to split work between threads.
+   */
+  virtual void update_memory_buffer(MemoryBuffer * /*output*/,
+                                    const rcti & /*area*/,
+                                    Span<MemoryBuffer *> /*inputs*/)
+  {
+  }
+
+  /**
+   * Type, resolution and parameters of the operation, in the order they are hashed. Together with
+   * the keys of its inputs it identifies the output of the operation. Empty when the operation
+   * doesn't implement #hash_output_params.
+   */
+  std::optional<Vector<uint64_t>> generate_params_key();
+
+  /** \} */
+
  protected:
   NodeOperation();
 
@@ -561,6 +636,50 @@ class NodeOperation {
   void lockMutex();
   void unlockMutex();
 
+  /**
+   * Operations whose output only depends on their inputs and on the parameters hashed here
+   * override this method, which allows caching their output between executions. Operations
+   * without parameters override it with an empty body.
+   */
+  virtual void hash_output_params()
+  {
+    m_is_hash_output_params_implemented = false;
+  }
+
+  template<typename T> void hash_param(const T &param)
+  {
+    m_params_key.append(get_default_hash(param));
+  }
+
+  template<typename T1, typename T2> void hash_params(const T1 &param1, const T2 &param2)
+  {
+    hash_param(param1);
+    hash_param(param2);
+  }
+
+  /** Hash plain data parameters, such as DNA node settings. */
+  void hash_data(const void *data, size_t size)
+  {
+    hash_param(BLI_hash_mm2_64(static_cast<const unsigned char *>(data), size, 0));
+  }
+
+ private:
+  /* -------------------------------------------------------------------- */
+  /** \name Full Frame Fallback Methods
+   * \{ */
+
+  void render_full_frame_fallback(MemoryBuffer *output_buf,
+                                  const rcti &output_area,
+                                  Span<MemoryBuffer *> inputs_bufs);
+  void render_tile(MemoryBuffer *output_buf, rcti *tile_rect);
+  Vector<NodeOperationOutput *> replace_inputs_with_buffers(Span<MemoryBuffer *> inputs_bufs);
+  void remove_buffers_and_restore_original_inputs(
+      Span<NodeOperationOutput *> original_inputs_links);
+
+  /** \} */
+
+ protected:
+
   /**
    * \brief set whether this operation is complex
    *
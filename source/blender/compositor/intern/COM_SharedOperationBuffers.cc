@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_SharedOperationBuffers.h"
+
+#include "BLI_rect.h"
+
+namespace blender::compositor {
+
+SharedOperationBuffers::BufferData::BufferData()
+    : buffer(nullptr),
+      render_area({0, 0, 0, 0}),
+      is_render_area_set(false),
+      is_rendered(false),
+      registered_reads(0),
+      received_reads(0)
+{
+}
+
+SharedOperationBuffers::BufferData &SharedOperationBuffers::get_buffer_data(NodeOperation *op)
+{
+  return m_buffers.lookup_or_add_default(op);
+}
+
+bool SharedOperationBuffers::extend_render_area(NodeOperation *op, const rcti &area)
+{
+  BufferData &buf_data = get_buffer_data(op);
+  if (!buf_data.is_render_area_set) {
+    buf_data.render_area = area;
+    buf_data.is_render_area_set = true;
+    return true;
+  }
+
+  if (BLI_rcti_is_empty(&area) || BLI_rcti_inside_rcti(&buf_data.render_area, &area)) {
+    return false;
+  }
+  if (BLI_rcti_is_empty(&buf_data.render_area)) {
+    buf_data.render_area = area;
+  }
+  else {
+    BLI_rcti_union(&buf_data.render_area, &area);
+  }
+  return true;
+}
+
+bool SharedOperationBuffers::has_render_area(NodeOperation *op)
+{
+  return get_buffer_data(op).is_render_area_set;
+}
+
+const rcti &SharedOperationBuffers::get_render_area(NodeOperation *op)
+{
+  BLI_assert(has_render_area(op));
+  return get_buffer_data(op).render_area;
+}
+
+void SharedOperationBuffers::register_read(NodeOperation *read_op)
+{
+  get_buffer_data(read_op).registered_reads++;
+}
+
+bool SharedOperationBuffers::has_registered_reads(NodeOperation *op)
+{
+  return get_buffer_data(op).registered_reads > 0;
+}
+
+bool SharedOperationBuffers::is_operation_rendered(NodeOperation *op)
+{
+  return get_buffer_data(op).is_rendered;
+}
+
+void SharedOperationBuffers::set_rendered_buffer(NodeOperation *op,
+                                                 std::unique_ptr<MemoryBuffer> buffer)
+{
+  BufferData &buf_data = get_buffer_data(op);
+  BLI_assert(buf_data.received_reads == 0);
+  BLI_assert(buf_data.buffer == nullptr);
+  buf_data.buffer = std::move(buffer);
+  buf_data.is_rendered = true;
+}
+
+MemoryBuffer *SharedOperationBuffers::get_rendered_buffer(NodeOperation *op)
+{
+  BufferData &buf_data = get_buffer_data(op);
+  BLI_assert(buf_data.is_rendered);
+  return buf_data.buffer.get();
+}
+
+void SharedOperationBuffers::read_finished(NodeOperation *read_op)
+{
+  BufferData &buf_data = get_buffer_data(read_op);
+  buf_data.received_reads++;
+  BLI_assert(buf_data.received_reads > 0 && buf_data.received_reads <= buf_data.registered_reads);
+  if (buf_data.received_reads == buf_data.registered_reads) {
+    /* Dispose buffer. */
+    buf_data.buffer = nullptr;
+  }
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include "BLI_map.hh"
+#include "BLI_rect.h"
+
+#include "COM_MemoryBuffer.h"
+
+#include <memory>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+class NodeOperation;
+
+/**
+ * Stores and shares operations rendered buffers including render data. Buffers are
+ * disposed once all dependent operations have finished reading them.
+ */
+class SharedOperationBuffers {
+ private:
+  struct BufferData {
+    BufferData();
+    std::unique_ptr<MemoryBuffer> buffer;
+    /** Area of the operation output that its readers need, empty until it is set. */
+    rcti render_area;
+    bool is_render_area_set;
+    bool is_rendered;
+    int registered_reads;
+    int received_reads;
+  };
+  Map<NodeOperation *, BufferData> m_buffers;
+
+ public:
+  /**
+   * Extend the area to render of given operation. Returns true when the area has grown,
+   * meaning that its inputs areas of interest have to be extended too.
+   */
+  bool extend_render_area(NodeOperation *op, const rcti &area);
+  bool has_render_area(NodeOperation *op);
+  const rcti &get_render_area(NodeOperation *op);
+
+  void register_read(NodeOperation *read_op);
+  bool has_registered_reads(NodeOperation *op);
+
+  bool is_operation_rendered(NodeOperation *op);
+  void set_rendered_buffer(NodeOperation *op, std::unique_ptr<MemoryBuffer> buffer);
+  MemoryBuffer *get_rendered_buffer(NodeOperation *op);
+
+  /**
+   * Notifies that a reader of given operation has finished. Once all registered readers have
+   * finished, the operation buffer is freed.
+   */
+  void read_finished(NodeOperation *read_op);
+
+ private:
+  BufferData &get_buffer_data(NodeOperation *op);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:SharedOperationBuffers")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -22,6 +22,7 @@
 
 #include "BLI_rect.h"
 
+#include <functional>
 #include <ostream>
 
 namespace blender::compositor {
@@ -33,23 +34,36 @@ class ExecutionGroup;
  * \see WorkScheduler
  */
 struct WorkPackage {
+  eWorkPackageType type = eWorkPackageType::Tile;
+
   eWorkPackageState state = eWorkPackageState::NotScheduled;
 
   /**
    * \brief executionGroup with the operations-setup to be evaluated
+   * \note Only used by #eWorkPackageType::Tile packages.
    */
-  ExecutionGroup *execution_group;
+  ExecutionGroup *execution_group = nullptr;
 
   /**
    * \brief number of the chunk to be executed
    */
-  unsigned int chunk_number;
+  unsigned int chunk_number = 0;
 
   /**
    * Area of the execution group that the work package calculates.
    */
   rcti rect;
 
+  /**
+   * Function to execute on #eWorkPackageType::CustomFunction packages.
+   */
+  std::function<void()> execute_fn;
+
+  /**
+   * Optional function called after the work package has been executed.
+   */
+  std::function<void()> executed_fn;
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
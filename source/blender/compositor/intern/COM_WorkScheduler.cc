@@ -16,10 +16,14 @@
  * Copyright 2011, Blender Foundation.
  */
 
+#include <algorithm>
+#include <cfloat>
 #include <cstdio>
 #include <list>
+#include <memory>
 
 #include "COM_CPUDevice.h"
+#include "COM_ChunkOrderHotspot.h"
 #include "COM_OpenCLDevice.h"
 #include "COM_OpenCLKernels.cl.h"
 #include "COM_WorkScheduler.h"
@@ -30,6 +34,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_vector.hh"
@@ -51,11 +56,17 @@ enum class ThreadingModel {
 /**
  * Returns the active threading model.
  *
- * Default is `ThreadingModel::Queue`.
+ * Default is `ThreadingModel::Task` when Blender is built with TBB, so that the compositor shares
+ * the cores with the other users of the TBB arena instead of starting threads of its own.
+ * Otherwise `ThreadingModel::Queue` is used.
  */
 constexpr ThreadingModel COM_threading_model()
 {
+#ifdef WITH_TBB
+  return ThreadingModel::Task;
+#else
   return ThreadingModel::Queue;
+#endif
 }
 
 /**
@@ -66,8 +77,30 @@ constexpr bool COM_is_opencl_enabled()
   return COM_threading_model() != ThreadingModel::SingleThreaded;
 }
 
+/** State of a CPU thread between #WorkScheduler::start and #WorkScheduler::stop. */
+struct ThreadState {
+  /** The thread id is assigned when the thread executes its first work package. */
+  WorkSchedulerThreadStats stats = {-1, 0, 0.0, 0.0};
+  /** Number of work packages the thread is executing, more than one when they are nested. */
+  int execute_depth = 0;
+
+  /** Execution group and area of the last tile executed by the thread. */
+  const ExecutionGroup *last_execution_group = nullptr;
+  rcti last_rect;
+};
+
 static ThreadLocal(CPUDevice *) g_thread_device;
 static struct {
+  /**
+   * \brief State of every CPU thread that executed work packages, in thread local storage.
+   * Created in #WorkScheduler::start, so that threads only ever write to their own state.
+   */
+  std::unique_ptr<EnumerableThreadSpecific<ThreadState>> thread_states;
+  std::atomic<int> next_thread_id = 0;
+  double start_time = 0.0;
+  double stop_time = 0.0;
+  bool running = false;
+
   struct {
     /** \brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is
      * created
@@ -83,6 +116,12 @@ static struct {
 
   struct {
     TaskPool *pool;
+    /**
+     * \brief Scheduled packages that no task has taken yet, in the order they were scheduled.
+     * \note protected by the mutex.
+     */
+    Vector<WorkPackage *> pending;
+    ThreadMutex mutex;
   } task;
 
   struct {
@@ -143,7 +182,8 @@ static void opencl_start(CompositorContext &context)
 
 static bool opencl_schedule(WorkPackage *package)
 {
-  if (package->execution_group->get_flags().open_cl && g_work_scheduler.opencl.active) {
+  if (package->type == eWorkPackageType::Tile &&
+      package->execution_group->get_flags().open_cl && g_work_scheduler.opencl.active) {
     BLI_thread_queue_push(g_work_scheduler.opencl.queue, package);
     return true;
   }
@@ -297,6 +337,68 @@ static void opencl_deinitialize()
 
 /* \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Thread Statistics
+ * \{ */
+
+static void thread_states_reset()
+{
+  g_work_scheduler.thread_states = std::make_unique<EnumerableThreadSpecific<ThreadState>>();
+  g_work_scheduler.next_thread_id = 0;
+  g_work_scheduler.start_time = PIL_check_seconds_timer();
+  g_work_scheduler.running = true;
+}
+
+static void thread_states_print()
+{
+  printf("Compositor thread statistics:\n");
+  for (const WorkSchedulerThreadStats &stats : WorkScheduler::get_thread_stats()) {
+    printf("  Thread %d: %d work packages, busy %.3fs, idle %.3fs\n",
+           stats.thread_id,
+           stats.num_work_packages,
+           stats.busy_time,
+           stats.idle_time);
+  }
+}
+
+/**
+ * State of the calling thread. Thread ids of the task scheduler wrap around and may be shared by
+ * threads, so the state is kept in thread local storage instead.
+ */
+static ThreadState &thread_state_local()
+{
+  ThreadState &state = g_work_scheduler.thread_states->local();
+  if (state.stats.thread_id == -1) {
+    state.stats.thread_id = g_work_scheduler.next_thread_id++;
+  }
+  return state;
+}
+
+/**
+ * Execute a work package on the given device and update the state of the calling thread.
+ */
+static void execute_work_package(ThreadState &state, CPUDevice &device, WorkPackage *package)
+{
+  /* The package can be freed once it has been executed. */
+  if (package->type == eWorkPackageType::Tile) {
+    state.last_execution_group = package->execution_group;
+    state.last_rect = package->rect;
+  }
+
+  /* The task scheduler can execute another package on this thread while the package waits for
+   * tasks of its own. Its time is part of the busy time of the outer package already. */
+  const bool is_nested = state.execute_depth++ > 0;
+  const double start_time = PIL_check_seconds_timer();
+  device.execute(package);
+  if (!is_nested) {
+    state.stats.busy_time += PIL_check_seconds_timer() - start_time;
+  }
+  state.execute_depth--;
+  state.stats.num_work_packages++;
+}
+
+/* \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Single threaded Scheduling
  * \{ */
@@ -304,7 +406,7 @@ static void opencl_deinitialize()
 static void threading_model_single_thread_execute(WorkPackage *package)
 {
   CPUDevice device(0);
-  device.execute(package);
+  execute_work_package(thread_state_local(), device, package);
 }
 
 /* \} */
@@ -318,8 +420,9 @@ static void *threading_model_queue_execute(void *data)
   CPUDevice *device = (CPUDevice *)data;
   WorkPackage *work;
   BLI_thread_local_set(g_thread_device, device);
+  ThreadState &state = thread_state_local();
   while ((work = (WorkPackage *)BLI_thread_queue_pop(g_work_scheduler.queue.queue))) {
-    device->execute(work);
+    execute_work_package(state, *device, work);
   }
 
   return nullptr;
@@ -391,23 +494,72 @@ static void threading_model_queue_deinitialize()
 /** \name Task Scheduling
  * \{ */
 
-static void threading_model_task_execute(TaskPool *__restrict UNUSED(pool), void *task_data)
+/**
+ * Tasks don't own a work package, but take one of the pending packages when they start. TBB runs
+ * the tasks in any order, this keeps the chunk order of the execution groups. Among the next few
+ * packages the one closest to the tile the thread executed last is preferred, neighboring tiles
+ * mostly read the same areas of their input buffers.
+ */
+static WorkPackage *threading_model_task_pop(const ThreadState &state)
+{
+  Vector<WorkPackage *> &pending = g_work_scheduler.task.pending;
+
+  BLI_mutex_lock(&g_work_scheduler.task.mutex);
+  BLI_assert(!pending.is_empty());
+  int64_t index = 0;
+  if (state.last_execution_group != nullptr) {
+    ChunkOrderHotspot hotspot(state.last_rect.xmin, state.last_rect.ymin, 0.0f);
+    const int64_t num_candidates = std::min<int64_t>(pending.size(),
+                                                     BLI_task_scheduler_num_threads());
+    double min_distance = DBL_MAX;
+    for (int64_t i = 0; i < num_candidates; i++) {
+      const WorkPackage *candidate = pending[i];
+      if (candidate->type != eWorkPackageType::Tile ||
+          candidate->execution_group != state.last_execution_group) {
+        continue;
+      }
+      const double distance = hotspot.calc_distance(candidate->rect.xmin, candidate->rect.ymin);
+      if (distance < min_distance) {
+        min_distance = distance;
+        index = i;
+      }
+    }
+  }
+  WorkPackage *package = pending[index];
+  pending.remove(index);
+  BLI_mutex_unlock(&g_work_scheduler.task.mutex);
+
+  return package;
+}
+
+static void threading_model_task_execute(TaskPool *__restrict UNUSED(pool),
+                                         void *UNUSED(task_data))
 {
-  WorkPackage *package = static_cast<WorkPackage *>(task_data);
-  CPUDevice device(BLI_task_parallel_thread_id(nullptr));
+  ThreadState &state = thread_state_local();
+  WorkPackage *package = threading_model_task_pop(state);
+  CPUDevice device(state.stats.thread_id);
+
+  /* Restore the device of an outer package executed by this thread, see #execute_work_package. */
+  CPUDevice *outer_device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
   BLI_thread_local_set(g_thread_device, &device);
-  device.execute(package);
+  execute_work_package(state, device, package);
+  BLI_thread_local_set(g_thread_device, outer_device);
 }
 
 static void threading_model_task_schedule(WorkPackage *package)
 {
+  BLI_mutex_lock(&g_work_scheduler.task.mutex);
+  g_work_scheduler.task.pending.append(package);
+  BLI_mutex_unlock(&g_work_scheduler.task.mutex);
+
   BLI_task_pool_push(
-      g_work_scheduler.task.pool, threading_model_task_execute, package, false, nullptr);
+      g_work_scheduler.task.pool, threading_model_task_execute, nullptr, false, nullptr);
 }
 
 static void threading_model_task_start()
 {
   BLI_thread_local_create(g_thread_device);
+  BLI_mutex_init(&g_work_scheduler.task.mutex);
   g_work_scheduler.task.pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
 }
 
@@ -420,6 +572,9 @@ static void threading_model_task_stop()
 {
   BLI_task_pool_free(g_work_scheduler.task.pool);
   g_work_scheduler.task.pool = nullptr;
+  BLI_assert(g_work_scheduler.task.pending.is_empty());
+  g_work_scheduler.task.pending.clear_and_make_inline();
+  BLI_mutex_end(&g_work_scheduler.task.mutex);
   BLI_thread_local_delete(g_thread_device);
 }
 
@@ -461,6 +616,8 @@ void WorkScheduler::start(CompositorContext &context)
     opencl_start(context);
   }
 
+  thread_states_reset();
+
   switch (COM_threading_model()) {
     case ThreadingModel::SingleThreaded:
       /* Nothing to do. */
@@ -516,6 +673,52 @@ void WorkScheduler::stop()
       threading_model_task_stop();
       break;
   }
+
+  g_work_scheduler.stop_time = PIL_check_seconds_timer();
+  g_work_scheduler.running = false;
+
+  if (G.debug & G_DEBUG) {
+    thread_states_print();
+  }
+}
+
+int WorkScheduler::get_num_cpu_threads()
+{
+  switch (COM_threading_model()) {
+    case ThreadingModel::SingleThreaded:
+      return 1;
+
+    case ThreadingModel::Queue:
+      return g_work_scheduler.queue.devices.size();
+
+    case ThreadingModel::Task:
+      return BLI_task_scheduler_num_threads();
+  }
+  return 1;
+}
+
+Vector<WorkSchedulerThreadStats> WorkScheduler::get_thread_stats()
+{
+  const double end_time = g_work_scheduler.running ? PIL_check_seconds_timer() :
+                                                     g_work_scheduler.stop_time;
+  const double elapsed_time = end_time - g_work_scheduler.start_time;
+
+  Vector<WorkSchedulerThreadStats> result;
+  if (!g_work_scheduler.thread_states) {
+    return result;
+  }
+  /* Only the threads that executed work packages are known. */
+  for (const ThreadState &state : *g_work_scheduler.thread_states) {
+    WorkSchedulerThreadStats stats = state.stats;
+    stats.idle_time = std::max(elapsed_time - stats.busy_time, 0.0);
+    result.append(stats);
+  }
+  std::sort(result.begin(),
+            result.end(),
+            [](const WorkSchedulerThreadStats &a, const WorkSchedulerThreadStats &b) {
+              return a.thread_id < b.thread_id;
+            });
+  return result;
 }
 
 bool WorkScheduler::has_gpu_devices()
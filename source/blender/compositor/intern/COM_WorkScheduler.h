@@ -24,8 +24,22 @@
 #include "COM_WorkPackage.h"
 #include "COM_defines.h"
 
+#include "BLI_vector.hh"
+
 namespace blender::compositor {
 
+/**
+ * \brief Statistics of a CPU thread, collected from WorkScheduler.start until WorkScheduler.stop.
+ */
+struct WorkSchedulerThreadStats {
+  int thread_id;
+  int num_work_packages;
+  /** Seconds spent executing work packages. */
+  double busy_time;
+  /** Seconds the thread spent waiting for work or on work of other users of the task scheduler. */
+  double idle_time;
+};
+
 /** \brief the workscheduler
  * \ingroup execution
  */
@@ -87,6 +101,17 @@ struct WorkScheduler {
    */
   static bool has_gpu_devices();
 
+  /**
+   * \brief Number of CPU threads work packages are executed on.
+   */
+  static int get_num_cpu_threads();
+
+  /**
+   * \brief Statistics of the CPU threads of the last execution.
+   * When the task scheduler is used only the threads that executed work packages are listed.
+   */
+  static Vector<WorkSchedulerThreadStats> get_thread_stats();
+
   static int current_thread_id();
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -23,6 +23,7 @@
 #include "BKE_node.h"
 #include "BKE_scene.h"
 
+#include "COM_BufferCache.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
 #include "COM_WorkScheduler.h"
@@ -32,6 +33,8 @@
 static struct {
   bool is_initialized = false;
   ThreadMutex mutex;
+  /** Buffers rendered by previous executions, reused when their inputs didn't change. */
+  blender::compositor::BufferCache *buffer_cache = nullptr;
 } g_compositor;
 
 /* Make sure node tree has previews.
@@ -94,11 +97,22 @@ void COM_execute(RenderData *render_data,
   const bool use_opencl = (node_tree->flag & NTREE_COM_OPENCL) != 0;
   blender::compositor::WorkScheduler::initialize(use_opencl, BKE_render_num_threads(render_data));
 
+  if (g_compositor.buffer_cache == nullptr) {
+    g_compositor.buffer_cache = new blender::compositor::BufferCache();
+  }
+
   /* Execute. */
   const bool twopass = (node_tree->flag & NTREE_TWO_PASS) && !rendering;
   if (twopass) {
-    blender::compositor::ExecutionSystem fast_pass(
-        render_data, scene, node_tree, rendering, true, viewSettings, displaySettings, viewName);
+    blender::compositor::ExecutionSystem fast_pass(render_data,
+                                                   scene,
+                                                   node_tree,
+                                                   rendering,
+                                                   true,
+                                                   viewSettings,
+                                                   displaySettings,
+                                                   viewName,
+                                                   g_compositor.buffer_cache);
     fast_pass.execute();
 
     if (node_tree->test_break(node_tree->tbh)) {
@@ -107,8 +121,15 @@ void COM_execute(RenderData *render_data,
     }
   }
 
-  blender::compositor::ExecutionSystem system(
-      render_data, scene, node_tree, rendering, false, viewSettings, displaySettings, viewName);
+  blender::compositor::ExecutionSystem system(render_data,
+                                              scene,
+                                              node_tree,
+                                              rendering,
+                                              false,
+                                              viewSettings,
+                                              displaySettings,
+                                              viewName,
+                                              g_compositor.buffer_cache);
   system.execute();
 
   BLI_mutex_unlock(&g_compositor.mutex);
@@ -119,6 +140,8 @@ void COM_deinitialize()
   if (g_compositor.is_initialized) {
     BLI_mutex_lock(&g_compositor.mutex);
     blender::compositor::WorkScheduler::deinitialize();
+    delete g_compositor.buffer_cache;
+    g_compositor.buffer_cache = nullptr;
     g_compositor.is_initialized = false;
     BLI_mutex_unlock(&g_compositor.mutex);
     BLI_mutex_end(&g_compositor.mutex);
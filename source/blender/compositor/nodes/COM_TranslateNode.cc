@@ -56,7 +56,12 @@ void TranslateNode::convertToOperations(NodeConverter &converter,
   converter.mapInputSocket(inputYSocket, operation->getInputSocket(2));
   converter.mapOutputSocket(outputSocket, operation->getOutputSocket(0));
 
-  if (data->wrap_axis) {
+  if (data->wrap_axis && context.get_execution_model() == eExecutionModel::FullFrame) {
+    /* Full frame operations read a whole input buffer, they can wrap it themselves. */
+    operation->setWrapping(data->wrap_axis);
+    converter.mapInputSocket(inputSocket, operation->getInputSocket(0));
+  }
+  else if (data->wrap_axis) {
     WriteBufferOperation *writeOperation = new WriteBufferOperation(DataType::Color);
     WrapOperation *wrapOperation = new WrapOperation(DataType::Color);
     wrapOperation->setMemoryProxy(writeOperation->getMemoryProxy());
@@ -116,4 +116,15 @@ void ConvertDepthToRadiusOperation::deinitExecution()
   this->m_inputOperation = nullptr;
 }
 
+void ConvertDepthToRadiusOperation::hash_output_params()
+{
+  hash_params(m_fStop, m_maxRadius);
+  if (m_cameraObject && m_cameraObject->type == OB_CAMERA) {
+    const Camera *camera = (const Camera *)m_cameraObject->data;
+    hash_params(camera->lens,
+                BKE_camera_sensor_size(camera->sensor_fit, camera->sensor_x, camera->sensor_y));
+    hash_param(BKE_camera_object_dof_distance(m_cameraObject));
+  }
+}
+
 }  // namespace blender::compositor
@@ -82,7 +82,12 @@ class ConvertDepthToRadiusOperation : public NodeOperation {
   void setPostBlur(FastGaussianBlurValueOperation *operation)
   {
     this->m_blurPostOperation = operation;
+    /* The sigma of the blur is set on execution initialization. */
+    this->flags.has_init_side_effects = true;
   }
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
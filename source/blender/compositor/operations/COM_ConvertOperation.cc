@@ -37,6 +37,22 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = nullptr;
 }
 
+void ConvertBaseOperation::hash_output_params()
+{
+}
+
+void ConvertBaseOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                        const rcti &area,
+                                                        Span<MemoryBuffer *> inputs)
+{
+  const MemoryBuffer *input = inputs[0];
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    update_memory_buffer_row(
+        output->get_elem(area.xmin, y), input->get_elem(area.xmin, y), width, input->elem_stride);
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
@@ -56,6 +72,17 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::update_memory_buffer_row(float *out,
+                                                            const float *in,
+                                                            const int width,
+                                                            const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    out[0] = out[1] = out[2] = in[0];
+    out[3] = 1.0f;
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
@@ -74,6 +101,16 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::update_memory_buffer_row(float *out,
+                                                            const float *in,
+                                                            const int width,
+                                                            const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_VALUE_CHANNELS) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
@@ -92,6 +129,16 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::update_memory_buffer_row(float *out,
+                                                         const float *in,
+                                                         const int width,
+                                                         const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_VALUE_CHANNELS) {
+    out[0] = IMB_colormanagement_get_luminance(in);
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
@@ -110,6 +157,16 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width,
+                                                             const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_VECTOR_CHANNELS) {
+    copy_v3_v3(out, in);
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
@@ -128,6 +185,16 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width,
+                                                             const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_VECTOR_CHANNELS) {
+    out[0] = out[1] = out[2] = in[0];
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
@@ -145,6 +212,17 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width,
+                                                             const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    copy_v3_v3(out, in);
+    out[3] = 1.0f;
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
@@ -163,6 +241,16 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width,
+                                                             const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_VALUE_CHANNELS) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -187,6 +275,12 @@ void ConvertRGBToYCCOperation::setMode(int mode)
   }
 }
 
+void ConvertRGBToYCCOperation::hash_output_params()
+{
+  ConvertBaseOperation::hash_output_params();
+  hash_param(m_mode);
+}
+
 void ConvertRGBToYCCOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -205,6 +299,20 @@ void ConvertRGBToYCCOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertRGBToYCCOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    float ycc[3];
+    rgb_to_ycc(in[0], in[1], in[2], &ycc[0], &ycc[1], &ycc[2], this->m_mode);
+    /* divided by 255 to normalize for viewing in */
+    mul_v3_v3fl(out, ycc, 1.0f / 255.0f);
+    out[3] = in[3];
+  }
+}
+
 /* ******** YCC to RGB ******** */
 
 ConvertYCCToRGBOperation::ConvertYCCToRGBOperation() : ConvertBaseOperation()
@@ -229,6 +337,12 @@ void ConvertYCCToRGBOperation::setMode(int mode)
   }
 }
 
+void ConvertYCCToRGBOperation::hash_output_params()
+{
+  ConvertBaseOperation::hash_output_params();
+  hash_param(m_mode);
+}
+
 void ConvertYCCToRGBOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -251,6 +365,20 @@ void ConvertYCCToRGBOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertYCCToRGBOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    /* need to un-normalize the data */
+    float ycc[3];
+    mul_v3_v3fl(ycc, in, 255.0f);
+    ycc_to_rgb(ycc[0], ycc[1], ycc[2], &out[0], &out[1], &out[2], this->m_mode);
+    out[3] = in[3];
+  }
+}
+
 /* ******** RGB to YUV ******** */
 
 ConvertRGBToYUVOperation::ConvertRGBToYUVOperation() : ConvertBaseOperation()
@@ -276,6 +404,17 @@ void ConvertRGBToYUVOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertRGBToYUVOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    rgb_to_yuv(in[0], in[1], in[2], &out[0], &out[1], &out[2], BLI_YUV_ITU_BT709);
+    out[3] = in[3];
+  }
+}
+
 /* ******** YUV to RGB ******** */
 
 ConvertYUVToRGBOperation::ConvertYUVToRGBOperation() : ConvertBaseOperation()
@@ -301,6 +440,17 @@ void ConvertYUVToRGBOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertYUVToRGBOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    yuv_to_rgb(in[0], in[1], in[2], &out[0], &out[1], &out[2], BLI_YUV_ITU_BT709);
+    out[3] = in[3];
+  }
+}
+
 /* ******** RGB to HSV ******** */
 
 ConvertRGBToHSVOperation::ConvertRGBToHSVOperation() : ConvertBaseOperation()
@@ -320,6 +470,17 @@ void ConvertRGBToHSVOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertRGBToHSVOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    rgb_to_hsv_v(in, out);
+    out[3] = in[3];
+  }
+}
+
 /* ******** HSV to RGB ******** */
 
 ConvertHSVToRGBOperation::ConvertHSVToRGBOperation() : ConvertBaseOperation()
@@ -342,6 +503,20 @@ void ConvertHSVToRGBOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ConvertHSVToRGBOperation::update_memory_buffer_row(float *out,
+                                                        const float *in,
+                                                        const int width,
+                                                        const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    hsv_to_rgb_v(in, out);
+    out[0] = max_ff(out[0], 0.0f);
+    out[1] = max_ff(out[1], 0.0f);
+    out[2] = max_ff(out[2], 0.0f);
+    out[3] = in[3];
+  }
+}
+
 /* ******** Premul to Straight ******** */
 
 ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBaseOperation()
@@ -372,6 +547,24 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::update_memory_buffer_row(float *out,
+                                                                const float *in,
+                                                                const int width,
+                                                                const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    const float alpha = in[3];
+    if (fabsf(alpha) < 1e-5f) {
+      zero_v3(out);
+    }
+    else {
+      mul_v3_v3fl(out, in, 1.0f / alpha);
+    }
+    /* never touches the alpha */
+    out[3] = alpha;
+  }
+}
+
 /* ******** Straight to Premul ******** */
 
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBaseOperation()
@@ -397,6 +590,19 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::update_memory_buffer_row(float *out,
+                                                                const float *in,
+                                                                const int width,
+                                                                const int in_stride)
+{
+  for (int x = 0; x < width; x++, in += in_stride, out += COM_DATA_TYPE_COLOR_CHANNELS) {
+    const float alpha = in[3];
+    mul_v3_v3fl(out, in, alpha);
+    /* never touches the alpha */
+    out[3] = alpha;
+  }
+}
+
 /* ******** Separate Channels ******** */
 
 SeparateChannelOperation::SeparateChannelOperation()
@@ -307,6 +307,11 @@ void FastGaussianBlurValueOperation::deinitExecution()
   deinitMutex();
 }
 
+void FastGaussianBlurValueOperation::hash_output_params()
+{
+  hash_params(m_sigma, m_overlay);
+}
+
 void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 {
   lockMutex();
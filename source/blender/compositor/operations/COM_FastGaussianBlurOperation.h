@@ -80,6 +80,13 @@ class FastGaussianBlurValueOperation : public NodeOperation {
   {
     this->m_overlay = overlay;
   }
+
+ protected:
+  /**
+   * \note The sigma may still be changed by #ConvertDepthToRadiusOperation, from parameters that
+   * are part of the hash of the input.
+   */
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
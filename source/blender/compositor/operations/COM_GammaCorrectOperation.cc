@@ -63,6 +63,10 @@ void GammaCorrectOperation::deinitExecution()
   this->m_inputProgram = nullptr;
 }
 
+void GammaCorrectOperation::hash_output_params()
+{
+}
+
 GammaUncorrectOperation::GammaUncorrectOperation()
 {
   this->addInputSocket(DataType::Color);
@@ -105,4 +109,8 @@ void GammaUncorrectOperation::deinitExecution()
   this->m_inputProgram = nullptr;
 }
 
+void GammaUncorrectOperation::hash_output_params()
+{
+}
+
 }  // namespace blender::compositor
@@ -46,6 +46,9 @@ class GammaCorrectOperation : public NodeOperation {
    * Deinitialize the execution
    */
   void deinitExecution() override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 class GammaUncorrectOperation : public NodeOperation {
@@ -72,6 +75,9 @@ class GammaUncorrectOperation : public NodeOperation {
    * Deinitialize the execution
    */
   void deinitExecution() override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
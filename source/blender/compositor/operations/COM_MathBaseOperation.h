@@ -45,6 +45,8 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  void hash_output_params() override;
+
  public:
   /**
    * Initialize the execution
@@ -55,6 +55,11 @@ class QualityStepHelper {
   {
     this->m_quality = quality;
   }
+
+  eCompositorQuality getQuality() const
+  {
+    return this->m_quality;
+  }
 };
 
 }  // namespace blender::compositor
@@ -41,4 +41,9 @@ void SetColorOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetColorOperation::hash_output_params()
+{
+  hash_data(m_color, sizeof(m_color));
+}
+
 }  // namespace blender::compositor
@@ -80,6 +80,9 @@ class SetColorOperation : public NodeOperation {
 
   void determineResolution(unsigned int resolution[2],
                            unsigned int preferredResolution[2]) override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
@@ -41,4 +41,9 @@ void SetValueOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetValueOperation::hash_output_params()
+{
+  hash_param(m_value);
+}
+
 }  // namespace blender::compositor
@@ -51,6 +51,9 @@ class SetValueOperation : public NodeOperation {
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
   void determineResolution(unsigned int resolution[2],
                            unsigned int preferredResolution[2]) override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
@@ -44,4 +44,10 @@ void SetVectorOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetVectorOperation::hash_output_params()
+{
+  hash_params(m_x, m_y);
+  hash_param(m_z);
+}
+
 }  // namespace blender::compositor
@@ -86,6 +86,9 @@ class SetVectorOperation : public NodeOperation {
     setY(vector[1]);
     setZ(vector[2]);
   }
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
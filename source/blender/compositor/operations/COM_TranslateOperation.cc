@@ -33,6 +33,7 @@ TranslateOperation::TranslateOperation()
   this->m_isDeltaSet = false;
   this->m_factorX = 1.0f;
   this->m_factorY = 1.0f;
+  this->m_wrapping_type = CMP_NODE_WRAP_NONE;
 }
 void TranslateOperation::initExecution()
 {
@@ -48,6 +49,12 @@ void TranslateOperation::deinitExecution()
   this->m_inputYOperation = nullptr;
 }
 
+void TranslateOperation::hash_output_params()
+{
+  hash_params(m_factorX, m_factorY);
+  hash_param(m_wrapping_type);
+}
+
 void TranslateOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -83,4 +90,99 @@ void TranslateOperation::setFactorXY(float factorX, float factorY)
   m_factorY = factorY;
 }
 
+void TranslateOperation::setWrapping(int wrapping_type)
+{
+  m_wrapping_type = wrapping_type;
+}
+
+void TranslateOperation::get_area_of_interest(const int input_idx,
+                                              const rcti &output_area,
+                                              rcti &r_input_area)
+{
+  if (input_idx != 0) {
+    /* Only the first pixel of the delta inputs is read. */
+    BLI_rcti_init(&r_input_area, 0, 1, 0, 1);
+    return;
+  }
+
+  NodeOperation *input_op = getInputOperation(0);
+  NodeOperation *x_op = getInputOperation(1);
+  NodeOperation *y_op = getInputOperation(2);
+  BLI_rcti_init(&r_input_area, 0, input_op->getWidth(), 0, input_op->getHeight());
+  if (!x_op->get_flags().is_set_operation || !y_op->get_flags().is_set_operation) {
+    /* Delta is not known until its inputs are rendered, the whole input may be read. */
+    return;
+  }
+
+  /* Set operations can be read before being rendered. */
+  float delta[4];
+  x_op->readSampled(delta, 0, 0, PixelSampler::Nearest);
+  const float delta_x = delta[0] * m_factorX;
+  y_op->readSampled(delta, 0, 0, PixelSampler::Nearest);
+  const float delta_y = delta[0] * m_factorY;
+
+  /* Include the neighbor pixels read by bilinear interpolation. */
+  if (!ELEM(m_wrapping_type, CMP_NODE_WRAP_X, CMP_NODE_WRAP_XY)) {
+    r_input_area.xmin = (int)floorf(output_area.xmin - delta_x) - 1;
+    r_input_area.xmax = (int)floorf(output_area.xmax - delta_x) + 2;
+  }
+  if (!ELEM(m_wrapping_type, CMP_NODE_WRAP_Y, CMP_NODE_WRAP_XY)) {
+    r_input_area.ymin = (int)floorf(output_area.ymin - delta_y) - 1;
+    r_input_area.ymax = (int)floorf(output_area.ymax - delta_y) + 2;
+  }
+}
+
+void TranslateOperation::update_memory_buffer_started(MemoryBuffer * /*output*/,
+                                                      const rcti & /*area*/,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  if (!this->m_isDeltaSet) {
+    this->m_deltaX = *inputs[1]->get_elem(0, 0);
+    this->m_deltaY = *inputs[2]->get_elem(0, 0);
+    this->m_isDeltaSet = true;
+  }
+}
+
+static float wrap_coord(const float coord, const int size)
+{
+  if (size == 0) {
+    return 0.0f;
+  }
+  const float wrapped = fmodf(coord, size);
+  return wrapped < 0.0f ? wrapped + size : wrapped;
+}
+
+void TranslateOperation::update_memory_buffer_partial(MemoryBuffer *output,
+                                                      const rcti &area,
+                                                      Span<MemoryBuffer *> inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  const bool wrap_x = ELEM(m_wrapping_type, CMP_NODE_WRAP_X, CMP_NODE_WRAP_XY);
+  const bool wrap_y = ELEM(m_wrapping_type, CMP_NODE_WRAP_Y, CMP_NODE_WRAP_XY);
+  const MemoryBufferExtend extend_x = wrap_x ? MemoryBufferExtend::Repeat :
+                                               MemoryBufferExtend::Clip;
+  const MemoryBufferExtend extend_y = wrap_y ? MemoryBufferExtend::Repeat :
+                                               MemoryBufferExtend::Clip;
+  const float delta_x = this->getDeltaX();
+  const float delta_y = this->getDeltaY();
+  const int input_width = input->getWidth();
+  const int input_height = input->getHeight();
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->get_elem(area.xmin, y);
+    float input_y = y - delta_y;
+    if (wrap_y) {
+      input_y = wrap_coord(input_y, input_height);
+    }
+    for (int x = area.xmin; x < area.xmax; x++) {
+      float input_x = x - delta_x;
+      if (wrap_x) {
+        input_x = wrap_coord(input_x, input_width);
+      }
+      input->readBilinear(out, input_x, input_y, extend_x, extend_y);
+      out += output->elem_stride;
+    }
+  }
+}
+
 }  // namespace blender::compositor
@@ -18,11 +18,11 @@
 
 #pragma once
 
-#include "COM_NodeOperation.h"
+#include "COM_MultiThreadedOperation.h"
 
 namespace blender::compositor {
 
-class TranslateOperation : public NodeOperation {
+class TranslateOperation : public MultiThreadedOperation {
  private:
   SocketReader *m_inputOperation;
   SocketReader *m_inputXOperation;
@@ -32,6 +32,8 @@ class TranslateOperation : public NodeOperation {
   bool m_isDeltaSet;
   float m_factorX;
   float m_factorY;
+  /** Wrapping of the input image (CMP_NODE_WRAP_*), only used in full frame execution. */
+  int m_wrapping_type;
 
  public:
   TranslateOperation();
@@ -65,6 +67,18 @@ class TranslateOperation : public NodeOperation {
   }
 
   void setFactorXY(float factorX, float factorY);
+  void setWrapping(int wrapping_type);
+
+  void get_area_of_interest(int input_idx, const rcti &output_area, rcti &r_input_area) override;
+  void update_memory_buffer_started(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+  void update_memory_buffer_partial(MemoryBuffer *output,
+                                    const rcti &area,
+                                    Span<MemoryBuffer *> inputs) override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 }  // namespace blender::compositor
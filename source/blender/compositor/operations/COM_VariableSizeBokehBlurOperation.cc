@@ -231,6 +231,12 @@ void VariableSizeBokehBlurOperation::deinitExecution()
 #endif
 }
 
+void VariableSizeBokehBlurOperation::hash_output_params()
+{
+  hash_params(m_maxBlur, m_threshold);
+  hash_params(m_do_size_scale, getQuality());
+}
+
 bool VariableSizeBokehBlurOperation::determineDependingAreaOfInterest(
     rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
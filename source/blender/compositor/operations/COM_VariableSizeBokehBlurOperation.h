@@ -84,6 +84,9 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
                      MemoryBuffer **inputMemoryBuffers,
                      std::list<cl_mem> *clMemToCleanUp,
                      std::list<cl_kernel> *clKernelsToCleanUp) override;
+
+ protected:
+  void hash_output_params() override;
 };
 
 #ifdef COM_DEFOCUS_SEARCH
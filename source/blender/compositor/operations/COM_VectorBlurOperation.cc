@@ -86,6 +86,14 @@ void VectorBlurOperation::deinitExecution()
     this->m_cachedInstance = nullptr;
   }
 }
+
+void VectorBlurOperation::hash_output_params()
+{
+  if (m_settings) {
+    hash_data(m_settings, sizeof(NodeBlurData));
+  }
+  hash_param(getQuality());
+}
 void *VectorBlurOperation::initializeTileData(rcti *rect)
 {
   if (this->m_cachedInstance) {
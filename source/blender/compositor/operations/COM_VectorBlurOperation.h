@@ -69,6 +69,8 @@ class VectorBlurOperation : public NodeOperation, public QualityStepHelper {
                                         rcti *output) override;
 
  protected:
+  void hash_output_params() override;
+
   void generateVectorBlur(float *data,
                           MemoryBuffer *inputImage,
                           MemoryBuffer *inputSpeed,
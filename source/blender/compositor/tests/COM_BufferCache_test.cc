@@ -0,0 +1,173 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "testing/testing.h"
+
+#include "COM_BufferCache.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_SetValueOperation.h"
+
+namespace blender::compositor::tests {
+
+/** Operation identified by a single parameter, with the given number of inputs. */
+class TestOperation : public NodeOperation {
+ private:
+  uint64_t m_param;
+
+ public:
+  TestOperation(int num_inputs, uint64_t param) : m_param(param)
+  {
+    for (int i = 0; i < num_inputs; i++) {
+      addInputSocket(DataType::Color);
+    }
+    addOutputSocket(DataType::Color);
+  }
+
+  void link_input(int index, TestOperation &input_op)
+  {
+    getInputSocket(index)->setLink(input_op.getOutputSocket());
+  }
+
+ protected:
+  void hash_output_params() override
+  {
+    hash_param(m_param);
+  }
+};
+
+static BufferCacheKeyBuilder create_key_builder()
+{
+  return BufferCacheKeyBuilder([](NodeOperation *op) { return op->generate_params_key(); });
+}
+
+static void expect_keys_differ(const BufferCacheKey *a, const BufferCacheKey *b)
+{
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_NE(a->words.as_span(), b->words.as_span());
+  EXPECT_NE(a->hash, b->hash);
+}
+
+TEST(buffer_cache_key, SameStructure)
+{
+  TestOperation input_a(0, 1), input_b(0, 2);
+  TestOperation op1(2, 10), op2(2, 10);
+  op1.link_input(0, input_a);
+  op1.link_input(1, input_b);
+  op2.link_input(0, input_a);
+  op2.link_input(1, input_b);
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  const BufferCacheKey *key1 = builder.get_key(&op1);
+  const BufferCacheKey *key2 = builder.get_key(&op2);
+  ASSERT_NE(key1, nullptr);
+  ASSERT_NE(key2, nullptr);
+  EXPECT_EQ(key1->words.as_span(), key2->words.as_span());
+  EXPECT_EQ(key1->hash, key2->hash);
+}
+
+TEST(buffer_cache_key, SwappedInputs)
+{
+  TestOperation input_a(0, 1), input_b(0, 2);
+  TestOperation op_ab(2, 10), op_ba(2, 10);
+  op_ab.link_input(0, input_a);
+  op_ab.link_input(1, input_b);
+  op_ba.link_input(0, input_b);
+  op_ba.link_input(1, input_a);
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  expect_keys_differ(builder.get_key(&op_ab), builder.get_key(&op_ba));
+}
+
+TEST(buffer_cache_key, DuplicatedInputs)
+{
+  TestOperation input_x(0, 1), input_y(0, 2);
+  TestOperation op_xx(2, 10), op_yy(2, 10), op_xy(2, 10);
+  op_xx.link_input(0, input_x);
+  op_xx.link_input(1, input_x);
+  op_yy.link_input(0, input_y);
+  op_yy.link_input(1, input_y);
+  op_xy.link_input(0, input_x);
+  op_xy.link_input(1, input_y);
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  expect_keys_differ(builder.get_key(&op_xx), builder.get_key(&op_yy));
+  expect_keys_differ(builder.get_key(&op_xx), builder.get_key(&op_xy));
+}
+
+TEST(buffer_cache_key, DuplicatedParams)
+{
+  /* Parameters hashed twice must not cancel out. */
+  TestOperation input_x(0, 1), input_y(0, 2);
+  TestOperation op_x(1, 5), op_y(1, 5);
+  op_x.link_input(0, input_x);
+  op_y.link_input(0, input_y);
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  expect_keys_differ(builder.get_key(&op_x), builder.get_key(&op_y));
+}
+
+TEST(buffer_cache_key, UnconnectedInput)
+{
+  TestOperation input_a(0, 1);
+  TestOperation op(2, 10);
+  op.link_input(0, input_a);
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  EXPECT_EQ(builder.get_key(&op), nullptr);
+}
+
+TEST(buffer_cache_key, SetOperationInput)
+{
+  /* Constants are identified by their value, without rendering them. */
+  SetValueOperation value_a, value_b;
+  value_a.setValue(1.0f);
+  value_b.setValue(2.0f);
+  EXPECT_TRUE(value_a.generate_params_key().has_value());
+
+  TestOperation op_a(1, 10), op_b(1, 10);
+  op_a.getInputSocket(0)->setLink(value_a.getOutputSocket());
+  op_b.getInputSocket(0)->setLink(value_b.getOutputSocket());
+
+  BufferCacheKeyBuilder builder = create_key_builder();
+  expect_keys_differ(builder.get_key(&op_a), builder.get_key(&op_b));
+}
+
+TEST(buffer_cache, LookupComparesFullKey)
+{
+  rcti area;
+  BLI_rcti_init(&area, 0, 4, 0, 4);
+  MemoryBuffer buffer(DataType::Color, area);
+  buffer.clear();
+
+  BufferCacheKey key_a = {{1, 2, 3}, 42};
+  BufferCacheKey key_b = {{1, 2, 4}, 42};
+
+  BufferCache cache;
+  cache.add(key_a, area, buffer);
+  EXPECT_NE(cache.lookup(key_a, area), nullptr);
+  EXPECT_EQ(cache.lookup(key_b, area), nullptr);
+
+  /* A colliding key replaces the previous buffer. */
+  cache.add(key_b, area, buffer);
+  EXPECT_EQ(cache.lookup(key_a, area), nullptr);
+  EXPECT_NE(cache.lookup(key_b, area), nullptr);
+}
+
+}  // namespace blender::compositor::tests
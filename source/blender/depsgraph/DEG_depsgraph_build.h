@@ -72,12 +72,20 @@ void DEG_graph_build_from_ids(struct Depsgraph *graph, struct ID **ids, const in
 /* Tag relations from the given graph for update. */
 void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 
+/* Tag relations of the given ID for update. Unlike the tag above this allows to only rebuild the
+ * part of the graph around the ID, so it is to be used when the ID itself is not added or removed
+ * from the graph. */
+void DEG_graph_tag_relations_update_id(struct Depsgraph *graph, struct ID *id);
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(struct Depsgraph *graph);
 
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update in all dependency graphs. */
+void DEG_relations_tag_update_id(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
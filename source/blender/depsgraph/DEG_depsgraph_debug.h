@@ -62,9 +62,13 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Write the timeline of the last evaluation in the Chrome tracing JSON format.
+ * Requires evaluation with time debugging (--debug-depsgraph-time). */
+void DEG_debug_stats_chrome_trace(const struct Depsgraph *graph, FILE *fp);
+
 /* ************************************************ */
 
-/* Compare two dependency graphs. */
+/* Compare two dependency graphs, differences are printed to the stderr. */
 bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *graph2);
 
 /* Check that dependencies in the graph are really up to date. */
@@ -43,6 +43,7 @@
 #include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
+#include "intern/eval/deg_eval_priority.h"
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
@@ -204,6 +205,8 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Make sure dependencies of visible ID datablocks are visible. */
   deg_graph_build_flush_visibility(graph);
   deg_graph_remove_unused_noops(graph);
+  /* Estimate which operations are to be evaluated first. */
+  deg_graph_calculate_operation_priorities(graph);
 
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
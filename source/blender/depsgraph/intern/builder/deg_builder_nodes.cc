@@ -114,6 +114,7 @@
 
 #include "intern/builder/deg_builder.h"
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node.h"
@@ -157,23 +158,20 @@ IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
 
   const ID_Type id_type = GS(id->name);
   IDNode *id_node = nullptr;
-  ID *id_cow = nullptr;
-  IDComponentsMask previously_visible_components_mask = 0;
-  uint32_t previous_eval_flags = 0;
-  DEGCustomDataMeshMasks previous_customdata_masks;
   IDInfo *id_info = id_info_hash_.lookup_default(id->session_uuid, nullptr);
   if (id_info != nullptr) {
-    id_cow = id_info->id_cow;
-    previously_visible_components_mask = id_info->previously_visible_components_mask;
-    previous_eval_flags = id_info->previous_eval_flags;
-    previous_customdata_masks = id_info->previous_customdata_masks;
+    id_node = graph_->add_id_node(id, id_info->id_cow);
+    id_node->previously_visible_components_mask = id_info->previously_visible_components_mask;
+    id_node->previous_eval_flags = id_info->previous_eval_flags;
+    id_node->previous_customdata_masks = id_info->previous_customdata_masks;
     /* Tag ID info to not free the CoW ID pointer. */
     id_info->id_cow = nullptr;
   }
-  id_node = graph_->add_id_node(id, id_cow);
-  id_node->previously_visible_components_mask = previously_visible_components_mask;
-  id_node->previous_eval_flags = previous_eval_flags;
-  id_node->previous_customdata_masks = previous_customdata_masks;
+  else {
+    /* Either a new ID node, which has its previous state cleared on creation, or a node which is
+     * kept by an incremental build. */
+    id_node = graph_->add_id_node(id);
+  }
   /* NOTE: Zero number of components indicates that ID node was just created. */
   if (id_node->components.is_empty() && deg_copy_on_write_is_needed(id_type)) {
     ComponentNode *comp_cow = id_node->add_component(NodeType::COPY_ON_WRITE);
@@ -342,16 +340,11 @@ void DepsgraphNodeBuilder::begin_build()
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
+    save_entry_tag(op_node);
+  }
 
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+  for (OperationNode *op_node : graph_->operations) {
+    save_operation_time(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -360,6 +353,132 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_incremental_build(Scene *scene,
+                                                   ViewLayer *view_layer,
+                                                   Span<ID *> ids)
+{
+  /* Setup context which is otherwise set by the view layer builder. */
+  scene_ = scene;
+  view_layer_ = view_layer;
+  view_layer_index_ = 0;
+
+  Set<ID *> rebuild_ids;
+  rebuild_ids.add_multiple(ids);
+  for (IDNode *id_node : graph_->id_nodes) {
+    /* Only changes caused by this build are to be detected when finalizing it. */
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (!rebuild_ids.contains(id_node->id_orig)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+
+  Set<OperationNode *> removed_operations;
+  for (ID *id : ids) {
+    IDNode *id_node = graph_->find_id_node(id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        if (graph_->entry_tags.remove(op_node)) {
+          save_entry_tag(op_node);
+        }
+        save_operation_time(op_node);
+        /* Relations from and to the operations which are kept are added back by the relations
+         * builder. */
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        removed_operations.add(op_node);
+      }
+      delete comp_node;
+    }
+    id_node->components.clear();
+    /* Flags are accumulated again by the relations builder. */
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+  }
+
+  Vector<OperationNode *> operations;
+  operations.reserve(graph_->operations.size() - removed_operations.size());
+  for (OperationNode *op_node : graph_->operations) {
+    if (!removed_operations.contains(op_node)) {
+      operations.append(op_node);
+    }
+  }
+  graph_->operations = std::move(operations);
+}
+
+void DepsgraphNodeBuilder::rebuild_id(ID *id)
+{
+  IDNode *id_node = find_id_node(id);
+  BLI_assert(id_node != nullptr && id_node->components.is_empty());
+  if (GS(id->name) == ID_OB) {
+    /* Objects are built with the same state as when they were pulled into the graph by the view
+     * layer builder. */
+    Object *object = (Object *)id;
+    const int base_index = id_node->has_base ? find_object_base_index(object) : -1;
+    build_object(base_index, object, id_node->linked_state, id_node->is_directly_visible);
+  }
+  else {
+    build_id(id);
+  }
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(const OperationNode *op_node)
+{
+  const ComponentNode *comp_node = op_node->owner;
+  const IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
+void DepsgraphNodeBuilder::save_operation_time(const OperationNode *op_node)
+{
+  if (!op_node->has_time_sample) {
+    return;
+  }
+  const ComponentNode *comp_node = op_node->owner;
+  const IDNode *id_node = comp_node->owner;
+
+  SavedOperationTime operation_time;
+  operation_time.id_orig = id_node->id_orig;
+  operation_time.component_type = comp_node->type;
+  operation_time.component_name = comp_node->name;
+  operation_time.opcode = op_node->opcode;
+  operation_time.name = op_node->name;
+  operation_time.name_tag = op_node->name_tag;
+  operation_time.average_time = op_node->average_time;
+  saved_operation_times_.append(operation_time);
+}
+
+int DepsgraphNodeBuilder::find_object_base_index(Object *object)
+{
+  /* NOTE: Must match the indexing of bases in build_view_layer(). */
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+    if (need_pull_base_into_graph(base)) {
+      if (base->object == object) {
+        return base_index;
+      }
+      base_index++;
+    }
+  }
+  return -1;
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
@@ -380,6 +499,25 @@ void DepsgraphNodeBuilder::end_build()
      * that originally node was explicitly tagged for user update. */
     op_node->tag_update(graph_, DEG_UPDATE_SOURCE_USER_EDIT);
   }
+
+  for (const SavedOperationTime &operation_time : saved_operation_times_) {
+    IDNode *id_node = find_id_node(operation_time.id_orig);
+    if (id_node == nullptr) {
+      continue;
+    }
+    ComponentNode *comp_node = id_node->find_component(operation_time.component_type,
+                                                       operation_time.component_name.c_str());
+    if (comp_node == nullptr) {
+      continue;
+    }
+    OperationNode *op_node = comp_node->find_operation(
+        operation_time.opcode, operation_time.name.c_str(), operation_time.name_tag);
+    if (op_node == nullptr) {
+      continue;
+    }
+    op_node->average_time = operation_time.average_time;
+    op_node->has_time_sample = true;
+  }
 }
 
 void DepsgraphNodeBuilder::build_id(ID *id)
@@ -101,6 +101,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Incremental build, which keeps all nodes of the graph except for the ones of the given IDs.
+   * Nodes of these IDs are removed, together with all their relations, and are to be created
+   * again with rebuild_id(). Is to be finished with end_build(). */
+  virtual void begin_incremental_build(Scene *scene, ViewLayer *view_layer, Span<ID *> ids);
+  virtual void rebuild_id(ID *id);
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
@@ -262,6 +268,26 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* Measured evaluation time of an operation, which is restored after relations update so that
+   * the priorities of operations can be estimated right away. */
+  struct SavedOperationTime {
+    ID *id_orig;
+    NodeType component_type;
+    string component_name;
+    OperationCode opcode;
+    string name;
+    int name_tag;
+    float average_time;
+  };
+  Vector<SavedOperationTime> saved_operation_times_;
+
+  void save_entry_tag(const OperationNode *op_node);
+  void save_operation_time(const OperationNode *op_node);
+
+  /* Index of the object base among the bases which are pulled into the graph, -1 if the object
+   * has no such base in the current view layer. */
+  int find_object_base_index(Object *object);
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
     /* Denotes whether object the walk is invoked from is visible. */
@@ -164,6 +164,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Incremental build, which adds relations to a graph which has most of them already. Only the
+   * given IDs are built, relations which exist already are re-used instead of being duplicated. */
+  void begin_incremental_build(Span<ID *> ids);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -373,6 +377,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   /* State which demotes currently built entities. */
   Scene *scene_;
 
+  bool is_incremental_build_;
+
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
 };
@@ -21,8 +21,11 @@
 
 #include "PIL_time.h"
 
+#include "BKE_collection.h"
 #include "BKE_global.h"
 
+#include "DNA_object_types.h"
+#include "DNA_rigidbody_types.h"
 #include "DNA_scene_types.h"
 
 #include "deg_builder_cycle.h"
@@ -30,6 +33,12 @@
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
 
+#include "intern/depsgraph_physics.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
 namespace blender::deg {
 
 AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
@@ -57,6 +66,37 @@ void AbstractBuilderPipeline::build()
   }
 }
 
+bool AbstractBuilderPipeline::build_incremental(Span<ID *> ids)
+{
+  if (!can_build_incremental(ids)) {
+    return false;
+  }
+
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  build_step_sanity_check();
+  const Set<ID *> rebuild_ids = build_step_nodes_incremental(ids);
+  build_step_relations_incremental(ids, rebuild_ids);
+  /* Cycles are detected again for the whole graph. */
+  for (OperationNode *op_node : deg_graph_->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+  build_step_finalize();
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph updated incrementally in %f seconds (%d of %d IDs rebuilt).\n",
+           PIL_check_seconds_timer() - start_time,
+           (int)rebuild_ids.size(),
+           (int)deg_graph_->id_nodes.size());
+  }
+  return true;
+}
+
 void AbstractBuilderPipeline::build_step_sanity_check()
 {
   BLI_assert(BLI_findindex(&scene_->view_layers, view_layer_) != -1);
@@ -107,6 +147,174 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->need_update_all_relations = false;
+  deg_graph_->relations_update_ids.clear();
+}
+
+/* Whether the ID has operations which are added by the builders of other IDs. Only the builder of
+ * the ID itself runs when it is rebuilt, so these operations would be lost. */
+static bool id_node_has_operations_from_other_builders(const IDNode *id_node)
+{
+  for (const ComponentNode *comp_node : id_node->components.values()) {
+    for (const OperationNode *op_node : comp_node->operations) {
+      switch (op_node->opcode) {
+        /* Added to driver targets by the builders of the IDs with the drivers. */
+        case OperationCode::ID_PROPERTY:
+        /* Added to simulated objects by the rigid body world builder of the scene. */
+        case OperationCode::RIGIDBODY_TRANSFORM_COPY:
+          return true;
+        default:
+          break;
+      }
+    }
+  }
+  return false;
+}
+
+static bool object_is_in_rigidbody_world(const Scene *scene, Object *object)
+{
+  const RigidBodyWorld *rbw = scene->rigidbody_world;
+  if (rbw == nullptr) {
+    return false;
+  }
+  return (rbw->group != nullptr && BKE_collection_has_object_recursive(rbw->group, object)) ||
+         (rbw->constraints != nullptr &&
+          BKE_collection_has_object_recursive(rbw->constraints, object));
+}
+
+bool AbstractBuilderPipeline::can_build_incremental(Span<ID *> ids) const
+{
+  if (deg_graph_->id_nodes.is_empty() || deg_graph_->scene_cow == nullptr) {
+    /* Graph was never built. */
+    return false;
+  }
+  if (G.debug_value == 799) {
+    /* Transitive reduction removes relations which are not known to be removed when only a part
+     * of the graph is built. */
+    return false;
+  }
+  for (ID *id : ids) {
+    const IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr) {
+      return false;
+    }
+    /* Scenes and collections are built in the context of the view layer. */
+    if (ELEM(GS(id->name), ID_SCE, ID_GR)) {
+      return false;
+    }
+    if (id_node->linked_state == DEG_ID_LINKED_VIA_SET) {
+      return false;
+    }
+    if (id_node_has_operations_from_other_builders(id_node)) {
+      return false;
+    }
+    if (GS(id->name) == ID_OB) {
+      /* Proxies are modifying the objects they are built from. */
+      Object *object = (Object *)id;
+      if (object->proxy != nullptr || object->proxy_from != nullptr ||
+          object->proxy_group != nullptr) {
+        return false;
+      }
+      /* Rigid body world members are built as part of the scene. */
+      if (object_is_in_rigidbody_world(scene_, object)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/* Add IDs which have relations to or from operations of the given ID. */
+static void add_neighbor_ids(const IDNode *id_node, Set<ID *> &r_ids)
+{
+  auto add_operation_neighbors = [&](const OperationNode *op_node) {
+    for (const Relation *rel : op_node->inlinks) {
+      if (rel->from->type == NodeType::OPERATION) {
+        r_ids.add(static_cast<const OperationNode *>(rel->from)->owner->owner->id_orig);
+      }
+    }
+    for (const Relation *rel : op_node->outlinks) {
+      r_ids.add(static_cast<const OperationNode *>(rel->to)->owner->owner->id_orig);
+    }
+  };
+  for (const ComponentNode *comp_node : id_node->components.values()) {
+    /* Components of rebuilt IDs are not finalized yet. */
+    if (comp_node->operations_map != nullptr) {
+      for (const OperationNode *op_node : comp_node->operations_map->values()) {
+        add_operation_neighbors(op_node);
+      }
+    }
+    for (const OperationNode *op_node : comp_node->operations) {
+      add_operation_neighbors(op_node);
+    }
+  }
+}
+
+Set<ID *> AbstractBuilderPipeline::build_step_nodes_incremental(Span<ID *> ids)
+{
+  /* Relations between the rebuilt IDs and their neighbors can be added by builders of either of
+   * them, so the relations of the neighbors are to be built again as well. */
+  Set<ID *> rebuild_ids;
+  for (ID *id : ids) {
+    rebuild_ids.add(id);
+    add_neighbor_ids(deg_graph_->find_id_node(id), rebuild_ids);
+  }
+
+  const int64_t num_id_nodes = deg_graph_->id_nodes.size();
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_incremental_build(scene_, view_layer_, ids);
+  for (ID *id : ids) {
+    node_builder->rebuild_id(id);
+  }
+  node_builder->end_build();
+
+  /* IDs which were pulled into the graph by the rebuilt ones. */
+  for (IDNode *id_node : deg_graph_->id_nodes.as_span().drop_front(num_id_nodes)) {
+    rebuild_ids.add(id_node->id_orig);
+  }
+  return rebuild_ids;
+}
+
+void AbstractBuilderPipeline::build_step_relations_incremental(Span<ID *> ids,
+                                                               const Set<ID *> &rebuild_ids)
+{
+  /* Effectors and colliders could have changed. */
+  clear_physics_relations(deg_graph_);
+
+  Vector<ID *> pending_ids;
+  for (ID *id : rebuild_ids) {
+    pending_ids.append(id);
+  }
+  Set<ID *> built_ids;
+  while (!pending_ids.is_empty()) {
+    unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+    relation_builder->begin_incremental_build(pending_ids);
+    /* Run the regular builder to set up the context and to add relations which are added by the
+     * view layer itself, everything which is not rebuilt is skipped quickly. */
+    build_relations(*relation_builder);
+    for (ID *id : pending_ids) {
+      relation_builder->build_id(id);
+    }
+    for (ID *id : pending_ids) {
+      IDNode *id_node = deg_graph_->find_id_node(id);
+      relation_builder->build_copy_on_write_relations(id_node);
+      relation_builder->build_driver_relations(id_node);
+    }
+    built_ids.add_multiple(pending_ids);
+
+    /* Rebuilt IDs might now depend on IDs which were not connected to them before, and whose
+     * builders might have relations to add as well. */
+    Set<ID *> neighbor_ids;
+    for (ID *id : ids) {
+      add_neighbor_ids(deg_graph_->find_id_node(id), neighbor_ids);
+    }
+    pending_ids.clear();
+    for (ID *id : neighbor_ids) {
+      if (!built_ids.contains(id)) {
+        pending_ids.append(id);
+      }
+    }
+  }
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
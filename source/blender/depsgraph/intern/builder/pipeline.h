@@ -28,6 +28,7 @@
 #include "intern/depsgraph_type.h"
 
 struct Depsgraph;
+struct ID;
 struct Main;
 struct Scene;
 struct ViewLayer;
@@ -54,6 +55,11 @@ class AbstractBuilderPipeline {
 
   void build();
 
+  /* Rebuild nodes and relations of the given IDs and relations of their direct neighbors, keeping
+   * the rest of the graph which is expected to be fully built. Returns false if this is not
+   * possible, in which case the graph is not modified and is to be built with build(). */
+  bool build_incremental(Span<ID *> ids);
+
  protected:
   Depsgraph *deg_graph_;
   Main *bmain_;
@@ -69,6 +75,10 @@ class AbstractBuilderPipeline {
   void build_step_relations();
   void build_step_finalize();
 
+  bool can_build_incremental(Span<ID *> ids) const;
+  Set<ID *> build_step_nodes_incremental(Span<ID *> ids);
+  void build_step_relations_incremental(Span<ID *> ids, const Set<ID *> &rebuild_ids);
+
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) = 0;
 };
@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Export the timeline of the last depsgraph evaluation in the Chrome tracing JSON format, which
+ * can be viewed in `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * Every evaluated operation is written as a complete event on the row of the thread it has been
+ * evaluated on. The critical path is written as a separate process, so that it is easy to see
+ * which chain of operations limits the evaluation time.
+ */
+
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/depsgraph.h"
+#include "intern/eval/deg_eval_stats.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace deg = blender::deg;
+
+namespace blender::deg {
+namespace {
+
+/* Process identifiers of the trace. */
+enum {
+  TRACE_PID_THREADS = 0,
+  TRACE_PID_CRITICAL_PATH = 1,
+};
+
+string json_escape(const string &str)
+{
+  string result;
+  for (const char ch : str) {
+    switch (ch) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if ((unsigned char)ch < 0x20) {
+          result += ' ';
+        }
+        else {
+          result += ch;
+        }
+        break;
+    }
+  }
+  return result;
+}
+
+void write_event(FILE *fp,
+                 bool &is_first_event,
+                 const OperationNode *op_node,
+                 const int pid,
+                 const int tid,
+                 const double time_offset)
+{
+  const double start_us = (op_node->stats.current_start_time - time_offset) * 1e6;
+  const double duration_us = (op_node->stats.current_end_time -
+                              op_node->stats.current_start_time) *
+                             1e6;
+  fprintf(fp,
+          "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+          "\"pid\":%d,\"tid\":%d,\"args\":{\"id\":\"%s\"}}",
+          is_first_event ? "" : ",",
+          json_escape(op_node->full_identifier()).c_str(),
+          nodeTypeAsString(op_node->owner->type),
+          start_us,
+          duration_us,
+          pid,
+          tid,
+          json_escape(op_node->owner->owner->name).c_str());
+  is_first_event = false;
+}
+
+void write_name_metadata(FILE *fp,
+                         bool &is_first_event,
+                         const char *type,
+                         const int pid,
+                         const int tid,
+                         const char *name)
+{
+  fprintf(fp,
+          "%s\n{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          is_first_event ? "" : ",",
+          type,
+          pid,
+          tid,
+          name);
+  is_first_event = false;
+}
+
+void deg_debug_stats_chrome_trace(const Depsgraph *graph, FILE *fp)
+{
+  Vector<const OperationNode *> evaluated_operations;
+  double time_offset = 0.0;
+  for (const OperationNode *op_node : graph->operations) {
+    if (op_node->stats.current_end_time == 0.0) {
+      /* Not evaluated, or evaluated without time debugging. */
+      continue;
+    }
+    if (evaluated_operations.is_empty() || op_node->stats.current_start_time < time_offset) {
+      time_offset = op_node->stats.current_start_time;
+    }
+    evaluated_operations.append(op_node);
+  }
+
+  /* Thread identifiers are hashes, map them to small numbers so that the rows are easier to
+   * read. */
+  Map<uint64_t, int> tid_by_thread_id;
+  for (const OperationNode *op_node : evaluated_operations) {
+    tid_by_thread_id.add(op_node->stats.current_thread_id, tid_by_thread_id.size());
+  }
+
+  bool is_first_event = true;
+  fprintf(fp, "{\"traceEvents\":[");
+
+  write_name_metadata(fp, is_first_event, "process_name", TRACE_PID_THREADS, 0, "Threads");
+  write_name_metadata(
+      fp, is_first_event, "process_name", TRACE_PID_CRITICAL_PATH, 0, "Critical Path");
+  for (const int tid : tid_by_thread_id.values()) {
+    const string name = "Thread " + to_string(tid);
+    write_name_metadata(fp, is_first_event, "thread_name", TRACE_PID_THREADS, tid, name.c_str());
+  }
+
+  for (const OperationNode *op_node : evaluated_operations) {
+    const int tid = tid_by_thread_id.lookup(op_node->stats.current_thread_id);
+    write_event(fp, is_first_event, op_node, TRACE_PID_THREADS, tid, time_offset);
+  }
+
+  double critical_path_time;
+  for (const OperationNode *op_node : deg_eval_stats_critical_path(graph, &critical_path_time)) {
+    if (op_node->stats.current_end_time == 0.0) {
+      /* NOOP operations are part of the path, but take no time. */
+      continue;
+    }
+    write_event(fp, is_first_event, op_node, TRACE_PID_CRITICAL_PATH, 0, time_offset);
+  }
+
+  fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+}  // namespace
+}  // namespace blender::deg
+
+void DEG_debug_stats_chrome_trace(const Depsgraph *depsgraph, FILE *fp)
+{
+  if (depsgraph == nullptr) {
+    return;
+  }
+  deg::deg_debug_stats_chrome_trace((const deg::Depsgraph *)depsgraph, fp);
+}
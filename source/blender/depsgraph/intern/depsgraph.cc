@@ -62,6 +62,8 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_update_all_relations(true),
+      need_update_operation_priorities(false),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
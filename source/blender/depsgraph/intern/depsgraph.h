@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
@@ -108,6 +109,18 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Indicates whether relations of all IDs needs to be updated. When this is false, only the
+   * relations of IDs from relations_update_ids and their direct neighbors are rebuilt. */
+  bool need_update_all_relations;
+
+  /* Indicates whether operations were evaluated for the first time, so that their priorities can
+   * be updated with the measured time instead of the default estimate. Set from worker threads
+   * during evaluation. */
+  std::atomic<bool> need_update_operation_priorities;
+
+  /* Original IDs which relations were tagged for update individually. */
+  Set<ID *> relations_update_ids;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[INDEX_ID_MAX];
 
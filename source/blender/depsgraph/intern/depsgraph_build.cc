@@ -283,6 +283,7 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  deg_graph->need_update_all_relations = true;
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -295,6 +296,36 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+void DEG_graph_tag_relations_update_id(Depsgraph *graph, ID *id)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  deg::IDNode *id_node = deg_graph->find_id_node(id);
+  if (id_node == nullptr) {
+    /* The ID is possibly becoming a part of the graph, which requires finding all of its users. */
+    DEG_graph_tag_relations_update(graph);
+    return;
+  }
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  deg_graph->need_update = true;
+  deg_graph->relations_update_ids.add(id);
+  /* NOTE: Unlike the tag of all relations this does not add or remove bases, so only the ID
+   * itself is to be re-evaluated. */
+  id_node->tag_update(deg_graph, deg::DEG_UPDATE_SOURCE_RELATIONS);
+}
+
+/* Compare relations which were updated incrementally with the ones from a full rebuild. */
+static void deg_graph_validate_incremental_relations(Depsgraph *graph)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  Depsgraph *full_graph = DEG_graph_new(
+      deg_graph->bmain, deg_graph->scene, deg_graph->view_layer, deg_graph->mode);
+  DEG_graph_build_from_view_layer(full_graph);
+  if (!DEG_debug_compare(full_graph, graph)) {
+    fprintf(stderr, "ERROR! Incrementally updated depsgraph differs from a full rebuild!\n");
+  }
+  DEG_graph_free(full_graph);
+}
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(Depsgraph *graph)
 {
@@ -303,6 +334,20 @@ void DEG_graph_relations_update(Depsgraph *graph)
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (!deg_graph->need_update_all_relations) {
+    /* Only rebuild the part of the graph around the tagged IDs when possible. */
+    blender::Vector<ID *> ids;
+    for (ID *id : deg_graph->relations_update_ids) {
+      ids.append(id);
+    }
+    deg::ViewLayerBuilderPipeline builder(graph);
+    if (builder.build_incremental(ids)) {
+      if (G.debug & G_DEBUG_DEPSGRAPH_VALIDATE) {
+        deg_graph_validate_incremental_relations(graph);
+      }
+      return;
+    }
+  }
   DEG_graph_build_from_view_layer(graph);
 }
 
@@ -314,3 +359,12 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of the given ID for update. */
+void DEG_relations_tag_update_id(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    DEG_graph_tag_relations_update_id(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
@@ -40,6 +40,7 @@
 #include "intern/depsgraph_type.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 namespace deg = blender::deg;
@@ -68,22 +69,70 @@ const char *DEG_debug_name_get(struct Depsgraph *depsgraph)
   return deg_graph->debug.name.c_str();
 }
 
+/* Identifier of a node which does not depend on memory addresses, so that nodes of graphs which
+ * were built independently from each other can be matched. */
+static std::string deg_debug_node_identifier(const deg::Node *node)
+{
+  if (node->type != deg::NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const deg::OperationNode *op_node = static_cast<const deg::OperationNode *>(node);
+  const deg::ComponentNode *comp_node = op_node->owner;
+  return comp_node->owner->name + " : " + deg::nodeTypeAsString(comp_node->type) + "(" +
+         comp_node->name + ") : " + deg::operationCodeAsString(op_node->opcode) + "(" +
+         op_node->name + ", " + std::to_string(op_node->name_tag) + ")";
+}
+
+static void deg_debug_collect_graph(const deg::Depsgraph *deg_graph,
+                                    blender::Set<std::string> &r_operations,
+                                    blender::Set<std::string> &r_relations)
+{
+  for (const deg::OperationNode *op_node : deg_graph->operations) {
+    const std::string op_identifier = deg_debug_node_identifier(op_node);
+    r_operations.add(op_identifier);
+    for (const deg::Relation *rel : op_node->inlinks) {
+      r_relations.add(deg_debug_node_identifier(rel->from) + " -> " + op_identifier + " [" +
+                      rel->name + "]");
+    }
+  }
+}
+
+static bool deg_debug_compare_sets(const blender::Set<std::string> &set1,
+                                   const blender::Set<std::string> &set2,
+                                   const char *what)
+{
+  bool is_equal = true;
+  for (const std::string &item : set1) {
+    if (!set2.contains(item)) {
+      fprintf(stderr, "%s only in the first graph: %s\n", what, item.c_str());
+      is_equal = false;
+    }
+  }
+  for (const std::string &item : set2) {
+    if (!set1.contains(item)) {
+      fprintf(stderr, "%s only in the second graph: %s\n", what, item.c_str());
+      is_equal = false;
+    }
+  }
+  return is_equal;
+}
+
 bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *graph2)
 {
   BLI_assert(graph1 != nullptr);
   BLI_assert(graph2 != nullptr);
   const deg::Depsgraph *deg_graph1 = reinterpret_cast<const deg::Depsgraph *>(graph1);
   const deg::Depsgraph *deg_graph2 = reinterpret_cast<const deg::Depsgraph *>(graph2);
-  if (deg_graph1->operations.size() != deg_graph2->operations.size()) {
-    return false;
-  }
-  /* TODO(sergey): Currently we only do real stupid check,
-   * which is fast but which isn't 100% reliable.
-   *
-   * Would be cool to make it more robust, but it's good enough
-   * for now. Also, proper graph check is actually NP-complex
-   * problem. */
-  return true;
+  /* NOTE: Operations and relations are matched by their names, which is not 100% reliable in
+   * theory, but is good enough to find differences between graphs built for the same scene.
+   * Relations between the same nodes with the same description are considered equal. */
+  blender::Set<std::string> operations1, relations1;
+  blender::Set<std::string> operations2, relations2;
+  deg_debug_collect_graph(deg_graph1, operations1, relations1);
+  deg_debug_collect_graph(deg_graph2, operations2, relations2);
+  const bool operations_equal = deg_debug_compare_sets(operations1, operations2, "Operation");
+  const bool relations_equal = deg_debug_compare_sets(relations1, relations2, "Relation");
+  return operations_equal && relations_equal;
 }
 
 bool DEG_debug_graph_relations_validate(Depsgraph *graph,
@@ -25,10 +25,13 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <thread>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap_simple.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
@@ -47,6 +50,7 @@
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/eval/deg_eval_flush.h"
+#include "intern/eval/deg_eval_priority.h"
 #include "intern/eval/deg_eval_stats.h"
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -68,11 +72,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -95,32 +94,61 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+
+  /* Operations which are ready for threaded evaluation, ordered by their priority. */
+  HeapSimple *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  /* The task does not necessarily evaluate this node, but the ready node with the highest
+   * priority. This way long chains of dependencies start as early as possible. */
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heapsimple_insert(state->ready_operations, -node->priority, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+OperationNode *pop_ready_operation(DepsgraphEvalState *state)
+{
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_assert(!BLI_heapsimple_is_empty(state->ready_operations));
+  OperationNode *node = (OperationNode *)BLI_heapsimple_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  return node;
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+  /* Perform operation. Always measure the time, it is used to estimate the priorities. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double end_time = PIL_check_seconds_timer();
+  if (deg_eval_priority_add_time_sample(operation_node, end_time - start_time)) {
+    state->graph->need_update_operation_priorities = true;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (state->do_stats) {
+    operation_node->stats.current_time += end_time - start_time;
+    operation_node->stats.current_start_time = start_time;
+    operation_node->stats.current_end_time = end_time;
+    operation_node->stats.current_thread_id = std::hash<std::thread::id>()(
+        std::this_thread::get_id());
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
+  OperationNode *operation_node = pop_ready_operation(state);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
@@ -379,6 +407,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heapsimple_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -402,11 +432,22 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_assert(BLI_heapsimple_is_empty(state.ready_operations));
+  BLI_heapsimple_free(state.ready_operations, nullptr);
+  BLI_spin_end(&state.ready_operations_lock);
+
+  /* Update priorities for the next evaluation once operations have been measured. Later changes
+   * in their time are taken into account when relations are rebuilt. */
+  if (graph->need_update_operation_priorities) {
+    deg_graph_calculate_operation_priorities(graph);
+  }
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
+    deg_eval_stats_print_critical_path(graph);
   }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval_priority.h"
+
+#include "BLI_math_base.h"
+#include "BLI_stack.hh"
+#include "BLI_utildefines.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+/* Estimated cost of an operation which has not been evaluated yet, in seconds. It is not zero, so
+ * that the number of operations in a chain is taken into account when no timing is known. */
+static const float DEFAULT_OPERATION_TIME = 1e-6f;
+
+/* Weight of a new time sample in the moving average of the operation time. */
+static const float TIME_SAMPLE_WEIGHT = 0.25f;
+
+bool deg_eval_priority_add_time_sample(OperationNode *op_node, const double time)
+{
+  if (!op_node->has_time_sample) {
+    op_node->average_time = (float)time;
+    op_node->has_time_sample = true;
+    return true;
+  }
+  op_node->average_time += ((float)time - op_node->average_time) * TIME_SAMPLE_WEIGHT;
+  return false;
+}
+
+static float operation_estimated_time(const OperationNode *op_node)
+{
+  if (op_node->is_noop()) {
+    return 0.0f;
+  }
+  if (!op_node->has_time_sample) {
+    return DEFAULT_OPERATION_TIME;
+  }
+  return op_node->average_time;
+}
+
+static bool relation_affects_priority(const Relation *rel)
+{
+  /* Cyclic relations are ignored by the evaluation engine as well. */
+  return (rel->flag & RELATION_FLAG_CYCLIC) == 0 && rel->to->type == NodeType::OPERATION;
+}
+
+void deg_graph_calculate_operation_priorities(Depsgraph *graph)
+{
+  graph->need_update_operation_priorities = false;
+
+  /* Visit operations in reverse topological order, so that the priorities of all children are
+   * known when the priority of an operation is calculated. The custom flags are used to count the
+   * number of children which have not been visited yet. */
+  Stack<OperationNode *> ready_operations;
+  for (OperationNode *op_node : graph->operations) {
+    op_node->priority = 0.0f;
+    op_node->custom_flags = 0;
+    for (Relation *rel : op_node->outlinks) {
+      if (relation_affects_priority(rel)) {
+        op_node->custom_flags++;
+      }
+    }
+    if (op_node->custom_flags == 0) {
+      ready_operations.push(op_node);
+    }
+  }
+
+  while (!ready_operations.is_empty()) {
+    OperationNode *op_node = ready_operations.pop();
+    op_node->priority += operation_estimated_time(op_node);
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || !relation_affects_priority(rel)) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      parent->priority = max_ff(parent->priority, op_node->priority);
+      BLI_assert(parent->custom_flags > 0);
+      parent->custom_flags--;
+      if (parent->custom_flags == 0) {
+        ready_operations.push(parent);
+      }
+    }
+  }
+}
+
+}  // namespace blender::deg
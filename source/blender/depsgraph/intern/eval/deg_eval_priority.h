@@ -0,0 +1,43 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+namespace blender {
+namespace deg {
+
+struct Depsgraph;
+struct OperationNode;
+
+/* Update the measured evaluation time of an operation, which is used to estimate priorities.
+ * Returns true for the first sample of the operation, which replaces the default estimate. */
+bool deg_eval_priority_add_time_sample(OperationNode *op_node, double time);
+
+/* Calculate the priority of every operation, which is the estimated time it takes to evaluate the
+ * longest chain of operations starting at it. When multiple operations are ready for evaluation,
+ * the ones with the highest priority are evaluated first, so that long chains of dependencies
+ * start as early as possible.
+ *
+ * This visits the whole graph, so it is done when relations are rebuilt and after evaluations
+ * that measured operations for the first time, not on every evaluation. */
+void deg_graph_calculate_operation_priorities(Depsgraph *graph);
+
+}  // namespace deg
+}  // namespace blender
@@ -23,9 +23,17 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <algorithm>
+#include <cstdio>
+
+#include "BLI_map.hh"
+#include "BLI_math_base.h"
+#include "BLI_set.hh"
+#include "BLI_stack.hh"
 #include "BLI_utildefines.h"
 
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -54,4 +62,124 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+namespace {
+
+struct CriticalPathNodeState {
+  /* Number of scheduled parent operations which are not yet visited. */
+  int num_pending_parents = 0;
+  /* Highest accumulated evaluation time of all chains which end with this operation. */
+  double path_time = 0.0;
+  /* Parent operation on the chain with the highest time. */
+  OperationNode *path_parent = nullptr;
+};
+
+/* Operations which were handled by the last evaluation, including NOOP operations which are not
+ * evaluated, but are part of the chains of dependencies. */
+bool operation_was_scheduled(const Node *node)
+{
+  return node->type == NodeType::OPERATION && ((const OperationNode *)node)->scheduled;
+}
+
+}  // namespace
+
+Vector<OperationNode *> deg_eval_stats_critical_path(const Depsgraph *graph,
+                                                     double *r_critical_path_time)
+{
+  /* Longest path in the directed acyclic graph of scheduled operations, weighted by evaluation
+   * time. Operations are visited in topological order, cyclic relations are ignored just like the
+   * evaluation engine does. */
+  Map<OperationNode *, CriticalPathNodeState> states;
+  Stack<OperationNode *> ready_operations;
+  for (OperationNode *op_node : graph->operations) {
+    if (!op_node->scheduled) {
+      continue;
+    }
+    CriticalPathNodeState &state = states.lookup_or_add_default(op_node);
+    for (Relation *rel : op_node->inlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && operation_was_scheduled(rel->from)) {
+        state.num_pending_parents++;
+      }
+    }
+    if (state.num_pending_parents == 0) {
+      ready_operations.push(op_node);
+    }
+  }
+
+  OperationNode *path_end = nullptr;
+  double critical_path_time = 0.0;
+  while (!ready_operations.is_empty()) {
+    OperationNode *op_node = ready_operations.pop();
+    CriticalPathNodeState &state = states.lookup(op_node);
+    state.path_time += op_node->stats.current_time;
+    if (path_end == nullptr || state.path_time > critical_path_time) {
+      path_end = op_node;
+      critical_path_time = state.path_time;
+    }
+    for (Relation *rel : op_node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) != 0 || !operation_was_scheduled(rel->to)) {
+        continue;
+      }
+      OperationNode *child = (OperationNode *)rel->to;
+      CriticalPathNodeState &child_state = states.lookup(child);
+      if (child_state.path_parent == nullptr || state.path_time > child_state.path_time) {
+        child_state.path_time = state.path_time;
+        child_state.path_parent = op_node;
+      }
+      child_state.num_pending_parents--;
+      if (child_state.num_pending_parents == 0) {
+        ready_operations.push(child);
+      }
+    }
+  }
+
+  Vector<OperationNode *> critical_path;
+  for (OperationNode *op_node = path_end; op_node != nullptr;
+       op_node = states.lookup(op_node).path_parent) {
+    critical_path.append(op_node);
+  }
+  std::reverse(critical_path.begin(), critical_path.end());
+
+  if (r_critical_path_time != nullptr) {
+    *r_critical_path_time = critical_path_time;
+  }
+  return critical_path;
+}
+
+void deg_eval_stats_print_critical_path(const Depsgraph *graph)
+{
+  double critical_path_time;
+  Vector<OperationNode *> critical_path = deg_eval_stats_critical_path(graph,
+                                                                       &critical_path_time);
+  if (critical_path.is_empty()) {
+    return;
+  }
+
+  double total_time = 0.0;
+  double start_time = 0.0;
+  double end_time = 0.0;
+  Set<uint64_t> thread_ids;
+  for (const OperationNode *op_node : graph->operations) {
+    if (op_node->stats.current_end_time == 0.0) {
+      /* Not evaluated. */
+      continue;
+    }
+    total_time += op_node->stats.current_time;
+    if (thread_ids.is_empty() || op_node->stats.current_start_time < start_time) {
+      start_time = op_node->stats.current_start_time;
+    }
+    end_time = max_dd(end_time, op_node->stats.current_end_time);
+    thread_ids.add(op_node->stats.current_thread_id);
+  }
+  const double wall_time = end_time - start_time;
+
+  printf("Depsgraph critical path: %f seconds, %d operations, ending with %s.\n",
+         critical_path_time,
+         (int)critical_path.size(),
+         critical_path.last()->full_identifier().c_str());
+  printf("Depsgraph operations: %f seconds on %d threads, average parallelism %f.\n",
+         total_time,
+         (int)thread_ids.size(),
+         (wall_time > 0.0) ? total_time / wall_time : 0.0);
+}
+
 }  // namespace blender::deg
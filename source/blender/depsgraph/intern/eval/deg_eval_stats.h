@@ -23,13 +23,25 @@
 
 #pragma once
 
+#include "intern/depsgraph_type.h"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Find the chain of dependent operations with the highest accumulated evaluation time in the last
+ * graph evaluation. No matter how many threads are available, evaluation can not be faster than
+ * this chain. The operations are ordered from the first to the last evaluated one. */
+Vector<OperationNode *> deg_eval_stats_critical_path(const Depsgraph *graph,
+                                                     double *r_critical_path_time);
+
+/* Print a summary of the critical path and how well the evaluation was parallelized. */
+void deg_eval_stats_print_critical_path(const Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
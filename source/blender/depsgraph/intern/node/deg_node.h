@@ -163,6 +163,12 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Timeline of the current graph evaluation: when the evaluation of the node began and ended
+     * (as returned by PIL_check_seconds_timer()), and on which thread it was evaluated.
+     * Only filled in for operation nodes. */
+    double current_start_time;
+    double current_end_time;
+    uint64_t current_thread_id;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -209,7 +209,8 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : name_tag(-1), flag(0), average_time(0.0f), has_time_sample(false), priority(0.0f)
 {
 }
 
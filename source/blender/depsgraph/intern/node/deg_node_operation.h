@@ -272,6 +272,16 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Moving average of the evaluation time in seconds, only valid when has_time_sample is set.
+   * Is preserved when relations are rebuilt. */
+  float average_time;
+  /* The operation was evaluated and its time was measured. The measured time itself can be zero
+   * for very fast operations, because of the resolution of the timer. */
+  bool has_time_sample;
+  /* Estimated time in seconds to evaluate the longest chain of operations starting with this one.
+   * Operations with higher priority are evaluated first when multiple are ready. */
+  float priority;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -1389,7 +1389,7 @@ void ED_object_constraint_dependency_update(Main *bmain, Object *ob)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_relations_tag_update_id(bmain, &ob->id);
 }
 
 void ED_object_constraint_tag_update(Main *bmain, Object *ob, bConstraint *con)
@@ -1422,7 +1422,7 @@ void ED_object_constraint_dependency_tag_update(Main *bmain, Object *ob, bConstr
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_relations_tag_update_id(bmain, &ob->id);
 }
 
 bool ED_object_constraint_move_to_index(Object *ob, bConstraint *con, const int index)
@@ -1493,7 +1493,7 @@ static int constraint_delete_exec(bContext *C, wmOperator *op)
     ED_object_constraint_update(bmain, ob);
 
     /* relations */
-    DEG_relations_tag_update(CTX_data_main(C));
+    DEG_relations_tag_update_id(bmain, &ob->id);
 
     /* notifiers */
     WM_event_add_notifier(C, NC_OBJECT | ND_CONSTRAINT | NA_REMOVED, ob);
@@ -2137,7 +2137,7 @@ static int constraint_add_exec(
   }
 
   /* force depsgraph to get recalculated since new relationships added */
-  DEG_relations_tag_update(bmain);
+  DEG_relations_tag_update_id(bmain, &ob->id);
 
   if ((ob->type == OB_ARMATURE) && (pchan)) {
     BKE_pose_tag_recalc(bmain, ob->pose); /* sort pose channels */
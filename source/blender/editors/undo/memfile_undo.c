@@ -20,6 +20,8 @@
  * Wrapper between 'ED_undo.h' and 'BKE_undo_system.h' API's.
  */
 
+#include "CLG_log.h"
+
 #include "BLI_sys_types.h"
 #include "BLI_utildefines.h"
 
@@ -57,6 +59,8 @@
 
 #include <stdio.h>
 
+static CLG_LogRef LOG = {"ed.undo.memfile"};
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  * \{ */
@@ -101,6 +105,22 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : NULL);
   us->step.data_size = us->data->undo_size;
 
+  if (CLOG_CHECK(&LOG, 1)) {
+    MemFileChunkStoreStats stats;
+    BLO_memfile_chunk_store_stats_get(&stats);
+    CLOG_INFO(&LOG,
+              1,
+              "step size=%zu, store: chunks=%zu, stored=%zu, referenced=%zu (dedup ratio %.2f), "
+              "positional hits=%zu, content hits=%zu",
+              us->data->undo_size,
+              stats.chunks_num,
+              stats.stored_size,
+              stats.referenced_size,
+              stats.stored_size ? (double)stats.referenced_size / (double)stats.stored_size : 1.0,
+              stats.positional_dedup_num,
+              stats.content_dedup_num);
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
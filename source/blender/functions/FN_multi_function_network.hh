@@ -113,7 +113,9 @@ class MFFunctionNode : public MFNode {
 
   const MultiFunction &function() const;
 
+  MFInputSocket &input_for_param(int param_index);
   const MFInputSocket &input_for_param(int param_index) const;
+  MFOutputSocket &output_for_param(int param_index);
   const MFOutputSocket &output_for_param(int param_index) const;
 };
 
@@ -364,11 +366,21 @@ inline const MultiFunction &MFFunctionNode::function() const
   return *function_;
 }
 
+inline MFInputSocket &MFFunctionNode::input_for_param(int param_index)
+{
+  return this->input(input_param_indices_.first_index(param_index));
+}
+
 inline const MFInputSocket &MFFunctionNode::input_for_param(int param_index) const
 {
   return this->input(input_param_indices_.first_index(param_index));
 }
 
+inline MFOutputSocket &MFFunctionNode::output_for_param(int param_index)
+{
+  return this->output(output_param_indices_.first_index(param_index));
+}
+
 inline const MFOutputSocket &MFFunctionNode::output_for_param(int param_index) const
 {
   return this->output(output_param_indices_.first_index(param_index));
@@ -25,21 +25,39 @@
 namespace blender::fn {
 
 class MFNetworkEvaluationStorage;
+class MFNetworkEvaluationBufferPool;
 
 class MFNetworkEvaluator : public MultiFunction {
  private:
   MFSignature signature_;
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  int64_t chunk_size_ = 512;
 
  public:
   MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
 
   void call(IndexMask mask, MFParams params, MFContext context) const override;
 
+  /**
+   * Maximum number of indices that are evaluated through the entire network at once. Larger masks
+   * are split into multiple chunks. Zero disables chunked evaluation.
+   */
+  void set_chunk_size(const int64_t chunk_size)
+  {
+    BLI_assert(chunk_size >= 0);
+    chunk_size_ = chunk_size;
+  }
+
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  bool supports_chunked_evaluation() const;
+  void call_chunked(IndexMask mask,
+                    MFParams params,
+                    MFContext context,
+                    MFNetworkEvaluationBufferPool &buffer_pool) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
@@ -22,8 +22,37 @@
 
 namespace blender::fn::mf_network_optimization {
 
-void dead_node_removal(MFNetwork &network);
+/**
+ * Describes that a function outputs one of its inputs unchanged when another input has a specific
+ * value. For example, `a + 0 = a` and `a * 1 = a`.
+ */
+struct IdentityRule {
+  const MultiFunction *function;
+  /** The input that has to be the neutral value. */
+  int constant_param_index;
+  /** The neutral value. It is not owned by the rule. */
+  GPointer neutral_value;
+  /** The input that is passed through. */
+  int passthrough_param_index;
+  /** The output that is equal to the passed through input. */
+  int output_param_index;
+};
+
+/** Net number of function nodes that have been removed from the network by every pass. */
+struct OptimizationStats {
+  int dead_node_removal = 0;
+  int constant_folding = 0;
+  int algebraic_simplification = 0;
+  int common_subnetwork_elimination = 0;
+};
+
+int dead_node_removal(MFNetwork &network);
 void constant_folding(MFNetwork &network, ResourceScope &scope);
+void algebraic_simplification(MFNetwork &network, Span<IdentityRule> rules);
 void common_subnetwork_elimination(MFNetwork &network);
 
+OptimizationStats optimize(MFNetwork &network,
+                           ResourceScope &scope,
+                           Span<IdentityRule> identity_rules = {});
+
 }  // namespace blender::fn::mf_network_optimization
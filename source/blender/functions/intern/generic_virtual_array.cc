@@ -309,6 +309,41 @@ GVArray_For_SingleValue::~GVArray_For_SingleValue()
   MEM_freeN((void *)value_);
 }
 
+/* --------------------------------------------------------------------
+ * GVArray_For_SlicedGVArray.
+ */
+
+void GVArray_For_SlicedGVArray::get_impl(const int64_t index, void *r_value) const
+{
+  varray_.get(index + offset_, r_value);
+}
+
+void GVArray_For_SlicedGVArray::get_to_uninitialized_impl(const int64_t index,
+                                                          void *r_value) const
+{
+  varray_.get_to_uninitialized(index + offset_, r_value);
+}
+
+bool GVArray_For_SlicedGVArray::is_span_impl() const
+{
+  return varray_.is_span();
+}
+
+GSpan GVArray_For_SlicedGVArray::get_internal_span_impl() const
+{
+  return varray_.get_internal_span().slice(offset_, size_);
+}
+
+bool GVArray_For_SlicedGVArray::is_single_impl() const
+{
+  return varray_.is_single();
+}
+
+void GVArray_For_SlicedGVArray::get_internal_single_impl(void *r_value) const
+{
+  varray_.get_internal_single(r_value);
+}
+
 /* --------------------------------------------------------------------
  * GVArray_GSpan.
  */
@@ -28,15 +28,20 @@
  * - Avoids data copies in many cases.
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
+ * - Large masks are split into chunks that are evaluated one after another. This keeps the
+ *   temporary buffers small enough to stay in the CPU cache while the values flow through the
+ *   entire network, instead of streaming every intermediate array through main memory.
+ * - Temporary buffers are reused once they are not needed anymore.
  *
  * Possible improvements:
- * - Cache and reuse buffers.
+ * - Support chunked evaluation when there are vector inputs or outputs.
  * - Use "deepest depth first" heuristic to decide which order the inputs of a node should be
  *   computed. This reduces the number of required temporary buffers when they are reused.
  */
 
 #include "FN_multi_function_network_evaluation.hh"
 
+#include "BLI_map.hh"
 #include "BLI_resource_scope.hh"
 #include "BLI_stack.hh"
 
@@ -44,6 +49,44 @@ namespace blender::fn {
 
 struct Value;
 
+/**
+ * Keeps temporary buffers that are not used anymore, so that they can be reused by later nodes
+ * and by later chunks of the same evaluation. All buffers are freed when the pool is destructed.
+ */
+class MFNetworkEvaluationBufferPool {
+ private:
+  /* Free buffers grouped by their size and alignment in bytes. */
+  Map<std::pair<int64_t, int64_t>, Vector<void *>> free_buffers_;
+
+ public:
+  MFNetworkEvaluationBufferPool() = default;
+  MFNetworkEvaluationBufferPool(const MFNetworkEvaluationBufferPool &other) = delete;
+  MFNetworkEvaluationBufferPool &operator=(const MFNetworkEvaluationBufferPool &other) = delete;
+
+  ~MFNetworkEvaluationBufferPool()
+  {
+    for (Vector<void *> &buffers : free_buffers_.values()) {
+      for (void *buffer : buffers) {
+        MEM_freeN(buffer);
+      }
+    }
+  }
+
+  void *allocate(const int64_t size, const int64_t alignment)
+  {
+    Vector<void *> *buffers = free_buffers_.lookup_ptr({size, alignment});
+    if (buffers != nullptr && !buffers->is_empty()) {
+      return buffers->pop_last();
+    }
+    return MEM_mallocN_aligned(size, alignment, AT);
+  }
+
+  void deallocate(void *buffer, const int64_t size, const int64_t alignment)
+  {
+    free_buffers_.lookup_or_add_default({size, alignment}).append(buffer);
+  }
+};
+
 /**
  * This keeps track of all the values that flow through the multi-function network. Therefore it
  * maintains a mapping between output sockets and their corresponding values. Every `value`
@@ -54,12 +97,15 @@ struct Value;
 class MFNetworkEvaluationStorage {
  private:
   LinearAllocator<> allocator_;
+  MFNetworkEvaluationBufferPool &buffer_pool_;
   IndexMask mask_;
   Array<Value *> value_per_output_id_;
   int64_t min_array_size_;
 
  public:
-  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount);
+  MFNetworkEvaluationStorage(IndexMask mask,
+                             int socket_id_amount,
+                             MFNetworkEvaluationBufferPool &buffer_pool);
   ~MFNetworkEvaluationStorage();
 
   /* Add the values that have been provided by the caller of the multi-function network. */
@@ -105,6 +151,10 @@ class MFNetworkEvaluationStorage {
   bool socket_is_computed(const MFOutputSocket &socket);
   bool is_same_value_for_every_index(const MFOutputSocket &socket);
   bool socket_has_buffer_for_output(const MFOutputSocket &socket);
+
+ private:
+  GMutableSpan allocate_full_buffer(const CPPType &type);
+  void free_full_buffer(GMutableSpan span);
 };
 
 MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
@@ -152,8 +202,15 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
     return;
   }
 
+  MFNetworkEvaluationBufferPool buffer_pool;
+
+  if (chunk_size_ > 0 && mask.size() > chunk_size_ && this->supports_chunked_evaluation()) {
+    this->call_chunked(mask, params, context, buffer_pool);
+    return;
+  }
+
   const MFNetwork &network = outputs_[0]->node().network();
-  Storage storage(mask, network.socket_id_amount());
+  Storage storage(mask, network.socket_id_amount(), buffer_pool);
 
   Vector<const MFInputSocket *> outputs_to_initialize_in_the_end;
 
@@ -163,6 +220,90 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
   this->initialize_remaining_outputs(params, storage, outputs_to_initialize_in_the_end);
 }
 
+bool MFNetworkEvaluator::supports_chunked_evaluation() const
+{
+  for (const MFOutputSocket *socket : inputs_) {
+    if (socket->data_type().is_vector()) {
+      return false;
+    }
+  }
+  for (const MFInputSocket *socket : outputs_) {
+    if (socket->data_type().is_vector()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Evaluate the entire network for one chunk of the mask at a time. The storage of every chunk
+ * works with indices that are relative to the first index in the chunk, so that temporary buffers
+ * only have to be as large as the chunk. The inputs and outputs provided by the caller are sliced
+ * accordingly.
+ */
+BLI_NOINLINE void MFNetworkEvaluator::call_chunked(
+    IndexMask mask,
+    MFParams params,
+    MFContext context,
+    MFNetworkEvaluationBufferPool &buffer_pool) const
+{
+  const MFNetwork &network = outputs_[0]->node().network();
+  Vector<int64_t> relative_indices;
+
+  for (int64_t chunk_start = 0; chunk_start < mask.size(); chunk_start += chunk_size_) {
+    const int64_t chunk_size = std::min(chunk_size_, mask.size() - chunk_start);
+    const IndexMask chunk_mask = mask.indices().slice(chunk_start, chunk_size);
+    const int64_t offset = chunk_mask[0];
+
+    IndexMask relative_mask;
+    if (chunk_mask.is_range()) {
+      relative_mask = IndexRange(chunk_size);
+    }
+    else {
+      relative_indices.clear();
+      for (const int64_t i : chunk_mask) {
+        relative_indices.append(i - offset);
+      }
+      relative_mask = relative_indices.as_span();
+    }
+    const IndexRange chunk_range(offset, relative_mask.min_array_size());
+
+    ResourceScope scope;
+    Storage storage(relative_mask, network.socket_id_amount(), buffer_pool);
+
+    for (int input_index : inputs_.index_range()) {
+      const GVArray &varray = params.readonly_single_input(input_index);
+      storage.add_single_input_from_caller(
+          *inputs_[input_index],
+          scope.construct<GVArray_For_SlicedGVArray>(__func__, varray, chunk_range));
+    }
+
+    Vector<const MFInputSocket *> outputs_to_initialize_in_the_end;
+    for (int output_index : outputs_.index_range()) {
+      const MFInputSocket &socket = *outputs_[output_index];
+      const MFOutputSocket &origin = *socket.origin();
+      if (origin.node().is_dummy() || storage.socket_has_buffer_for_output(origin)) {
+        /* See #copy_outputs_to_storage. */
+        outputs_to_initialize_in_the_end.append(&socket);
+        continue;
+      }
+      GMutableSpan span = params.uninitialized_single_output(inputs_.size() + output_index);
+      storage.add_single_output_from_caller(origin,
+                                            span.slice(chunk_range.start(), chunk_range.size()));
+    }
+
+    this->evaluate_network_to_compute_outputs(context, storage);
+
+    for (const MFInputSocket *socket : outputs_to_initialize_in_the_end) {
+      const int param_index = inputs_.size() + outputs_.first_index_of(socket);
+      const GVArray &values = storage.get_single_input__full(*socket, scope);
+      GMutableSpan span = params.uninitialized_single_output(param_index);
+      values.materialize_to_uninitialized(
+          relative_mask, span.slice(chunk_range.start(), chunk_range.size()).data());
+    }
+  }
+}
+
 BLI_NOINLINE void MFNetworkEvaluator::copy_inputs_to_storage(MFParams params,
                                                              Storage &storage) const
 {
@@ -522,8 +663,11 @@ struct OwnVectorValue : public Value {
 /** \name Storage methods
  * \{ */
 
-MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount)
-    : mask_(mask),
+MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask,
+                                                       int socket_id_amount,
+                                                       MFNetworkEvaluationBufferPool &buffer_pool)
+    : buffer_pool_(buffer_pool),
+      mask_(mask),
       value_per_output_id_(socket_id_amount, nullptr),
       min_array_size_(mask.min_array_size())
 {
@@ -543,8 +687,7 @@ MFNetworkEvaluationStorage::~MFNetworkEvaluationStorage()
         type.destruct(span.data());
       }
       else {
-        type.destruct_indices(span.data(), mask_);
-        MEM_freeN(span.data());
+        this->free_full_buffer(span);
       }
     }
     else if (any_value->type == ValueType::OwnVector) {
@@ -559,6 +702,19 @@ IndexMask MFNetworkEvaluationStorage::mask() const
   return mask_;
 }
 
+GMutableSpan MFNetworkEvaluationStorage::allocate_full_buffer(const CPPType &type)
+{
+  void *buffer = buffer_pool_.allocate(min_array_size_ * type.size(), type.alignment());
+  return GMutableSpan(type, buffer, min_array_size_);
+}
+
+void MFNetworkEvaluationStorage::free_full_buffer(GMutableSpan span)
+{
+  const CPPType &type = span.type();
+  type.destruct_indices(span.data(), mask_);
+  buffer_pool_.deallocate(span.data(), min_array_size_ * type.size(), type.alignment());
+}
+
 bool MFNetworkEvaluationStorage::socket_is_computed(const MFOutputSocket &socket)
 {
   Value *any_value = value_per_output_id_[socket.id()];
@@ -653,8 +809,7 @@ void MFNetworkEvaluationStorage::finish_input_socket(const MFInputSocket &socket
           type.destruct(span.data());
         }
         else {
-          type.destruct_indices(span.data(), mask_);
-          MEM_freeN(span.data());
+          this->free_full_buffer(span);
         }
         value_per_output_id_[origin.id()] = nullptr;
       }
@@ -718,8 +873,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_single_output__full(const MFOutputS
   Value *any_value = value_per_output_id_[socket.id()];
   if (any_value == nullptr) {
     const CPPType &type = socket.data_type().single_type();
-    void *buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
-    GMutableSpan span(type, buffer, min_array_size_);
+    GMutableSpan span = this->allocate_full_buffer(type);
 
     auto *value =
         allocator_.construct<OwnSingleValue>(span, socket.targets().size(), false).release();
@@ -823,8 +977,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_mutable_single__full(const MFInputS
   }
 
   const GVArray &virtual_array = this->get_single_input__full(input, scope);
-  void *new_buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
-  GMutableSpan new_array_ref(type, new_buffer, min_array_size_);
+  GMutableSpan new_array_ref = this->allocate_full_buffer(type);
   virtual_array.materialize_to_uninitialized(mask_, new_array_ref.data());
 
   OwnSingleValue *new_value =
@@ -26,6 +26,7 @@
 #include "FN_multi_function_network_optimization.hh"
 
 #include "BLI_disjoint_set.hh"
+#include "BLI_function_ref.hh"
 #include "BLI_ghash.h"
 #include "BLI_map.hh"
 #include "BLI_multi_value_map.hh"
@@ -125,13 +126,15 @@ static Vector<MFNode *> find_nodes_based_on_mask(MFNetwork &network,
 
 /**
  * Unused nodes are all those nodes that no dummy node depends upon.
+ * Returns the number of removed nodes.
  */
-void dead_node_removal(MFNetwork &network)
+int dead_node_removal(MFNetwork &network)
 {
   Array<bool> node_is_used_mask = mask_nodes_to_the_left(network,
                                                          network.dummy_nodes().cast<MFNode *>());
   Vector<MFNode *> nodes_to_remove = find_nodes_based_on_mask(network, node_is_used_mask, false);
   network.remove(nodes_to_remove);
+  return nodes_to_remove.size();
 }
 
 /** \} */
@@ -294,10 +297,6 @@ static Array<MFOutputSocket *> compute_constant_sockets_and_add_folded_nodes(
   return add_constant_folded_sockets(network_fn, params, scope, network);
 }
 
-class MyClass {
-  MFDummyNode node;
-};
-
 /**
  * Find function nodes that always output the same value and replace those with constant nodes.
  */
@@ -322,6 +321,92 @@ void constant_folding(MFNetwork &network, ResourceScope &scope)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Algebraic Simplification
+ * \{ */
+
+/**
+ * Returns true when the socket is the output of a function node that outputs the given value for
+ * every index. Only nodes without inputs are checked, which is the case for constant folded
+ * nodes.
+ */
+static bool socket_has_constant_value(const MFOutputSocket &socket, GPointer value)
+{
+  const MFNode &node = socket.node();
+  if (node.is_dummy() || node.inputs().size() > 0) {
+    return false;
+  }
+  if (socket.data_type() != MFDataType::ForSingle(*value.type())) {
+    return false;
+  }
+  const MFFunctionNode &function_node = node.as_function();
+  const MultiFunction &fn = function_node.function();
+  if (fn.depends_on_context()) {
+    return false;
+  }
+  for (int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).category() != MFParamType::SingleOutput) {
+      return false;
+    }
+  }
+
+  MFParamsBuilder params{fn, 1};
+  ResourceScope &scope = params.resource_scope();
+  for (int param_index : fn.param_indices()) {
+    const CPPType &type = fn.param_type(param_index).data_type().single_type();
+    void *buffer = scope.linear_allocator().allocate(type.size(), type.alignment());
+    params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
+  }
+  MFContextBuilder context;
+  fn.call({0}, params, context);
+
+  bool is_equal = false;
+  for (int param_index : fn.param_indices()) {
+    GMutableSpan computed = params.computed_array(param_index);
+    if (&function_node.output_for_param(param_index) == &socket) {
+      is_equal = computed.type().is_equal(computed.data(), value.get());
+    }
+    computed.type().destruct(computed.data());
+  }
+  return is_equal;
+}
+
+/**
+ * Bypass function nodes that output one of their inputs unchanged, because another input is a
+ * neutral constant. The bypassed nodes become unused and are removed by #dead_node_removal.
+ * This should run after #constant_folding, so that constant sub-networks are detected as well.
+ */
+void algebraic_simplification(MFNetwork &network, Span<IdentityRule> rules)
+{
+  if (rules.is_empty()) {
+    return;
+  }
+
+  for (MFFunctionNode *node : network.function_nodes()) {
+    const MultiFunction &fn = node->function();
+    for (const IdentityRule &rule : rules) {
+      if (rule.function != &fn) {
+        continue;
+      }
+      MFOutputSocket *constant_origin = node->input_for_param(rule.constant_param_index).origin();
+      MFOutputSocket *passthrough_origin =
+          node->input_for_param(rule.passthrough_param_index).origin();
+      if (constant_origin == nullptr || passthrough_origin == nullptr) {
+        continue;
+      }
+      if (!socket_has_constant_value(*constant_origin, rule.neutral_value)) {
+        continue;
+      }
+      MFOutputSocket &output = node->output_for_param(rule.output_param_index);
+      BLI_assert(output.data_type() == passthrough_origin->data_type());
+      network.relink(output, *passthrough_origin);
+      break;
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Common Sub-network Elimination
  * \{ */
@@ -498,4 +583,38 @@ void common_subnetwork_elimination(MFNetwork &network)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Optimization Pipeline
+ * \{ */
+
+static int run_pass_and_count_removed_nodes(MFNetwork &network, FunctionRef<void()> pass)
+{
+  const int old_nodes_num = network.function_nodes().size();
+  pass();
+  dead_node_removal(network);
+  return old_nodes_num - network.function_nodes().size();
+}
+
+/**
+ * Run all optimization passes in an order in which they benefit from each other. Nodes that became
+ * unused are removed after every pass, so that the number of nodes removed by every pass can be
+ * reported.
+ */
+OptimizationStats optimize(MFNetwork &network,
+                           ResourceScope &scope,
+                           Span<IdentityRule> identity_rules)
+{
+  OptimizationStats stats;
+  stats.dead_node_removal = dead_node_removal(network);
+  stats.constant_folding = run_pass_and_count_removed_nodes(
+      network, [&]() { constant_folding(network, scope); });
+  stats.algebraic_simplification = run_pass_and_count_removed_nodes(
+      network, [&]() { algebraic_simplification(network, identity_rules); });
+  stats.common_subnetwork_elimination = run_pass_and_count_removed_nodes(
+      network, [&]() { common_subnetwork_elimination(network); });
+  return stats;
+}
+
+/** \} */
+
 }  // namespace blender::fn::mf_network_optimization
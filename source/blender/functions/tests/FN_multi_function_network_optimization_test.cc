@@ -0,0 +1,141 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "FN_multi_function_builder.hh"
+#include "FN_multi_function_network.hh"
+#include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
+
+namespace blender::fn::mf_network_optimization::tests {
+namespace {
+
+static int evaluate_network(MFOutputSocket &input_socket, MFInputSocket &output_socket, int value)
+{
+  MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket}};
+  int result = 0;
+  MFParamsBuilder params(network_fn, 1);
+  params.add_readonly_single_input(&value);
+  params.add_uninitialized_single_output(&result);
+  MFContextBuilder context;
+  network_fn.call({0}, params, context);
+  return result;
+}
+
+TEST(multi_function_network_optimization, DeadNodeRemoval)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(add_10_fn);
+  network.add_link(input_socket, node1.input(0));
+  network.add_link(input_socket, node2.input(0));
+  network.add_link(node1.output(0), output_socket);
+
+  EXPECT_EQ(dead_node_removal(network), 1);
+  EXPECT_EQ(network.function_nodes().size(), 1);
+  EXPECT_EQ(evaluate_network(input_socket, output_socket, 5), 15);
+}
+
+TEST(multi_function_network_optimization, AlgebraicSimplification)
+{
+  CustomMF_SI_SI_SO<int, int, int> add_fn("add", [](int a, int b) { return a + b; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+  CustomMF_Constant<int> zero_fn{0};
+  CustomMF_Constant<int> one_fn{1};
+  CustomMF_Constant<int> two_fn{2};
+
+  const int zero = 0;
+  const int one = 1;
+  Array<IdentityRule> rules = {
+      {&add_fn, 1, {CPPType::get<int>(), &zero}, 0, 2},
+      {&add_fn, 0, {CPPType::get<int>(), &zero}, 1, 2},
+      {&multiply_fn, 1, {CPPType::get<int>(), &one}, 0, 2},
+  };
+
+  /* ((x + 0) * 1) * 2 */
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  MFNode &zero_node = network.add_function(zero_fn);
+  MFNode &one_node = network.add_function(one_fn);
+  MFNode &two_node = network.add_function(two_fn);
+  MFNode &add_node = network.add_function(add_fn);
+  MFNode &multiply_node1 = network.add_function(multiply_fn);
+  MFNode &multiply_node2 = network.add_function(multiply_fn);
+  network.add_link(input_socket, add_node.input(0));
+  network.add_link(zero_node.output(0), add_node.input(1));
+  network.add_link(add_node.output(0), multiply_node1.input(0));
+  network.add_link(one_node.output(0), multiply_node1.input(1));
+  network.add_link(multiply_node1.output(0), multiply_node2.input(0));
+  network.add_link(two_node.output(0), multiply_node2.input(1));
+  network.add_link(multiply_node2.output(0), output_socket);
+
+  ResourceScope scope;
+  OptimizationStats stats = optimize(network, scope, rules);
+
+  EXPECT_EQ(stats.dead_node_removal, 0);
+  EXPECT_EQ(stats.constant_folding, 0);
+  EXPECT_EQ(stats.algebraic_simplification, 4);
+  EXPECT_EQ(stats.common_subnetwork_elimination, 0);
+  EXPECT_EQ(network.function_nodes().size(), 2);
+  EXPECT_EQ(evaluate_network(input_socket, output_socket, 7), 14);
+}
+
+TEST(multi_function_network_optimization, CommonSubnetworkElimination)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(add_10_fn);
+  MFNode &node3 = network.add_function(multiply_fn);
+  network.add_link(input_socket, node1.input(0));
+  network.add_link(input_socket, node2.input(0));
+  network.add_link(node1.output(0), node3.input(0));
+  network.add_link(node2.output(0), node3.input(1));
+  network.add_link(node3.output(0), output_socket);
+
+  ResourceScope scope;
+  OptimizationStats stats = optimize(network, scope);
+
+  EXPECT_EQ(stats.common_subnetwork_elimination, 1);
+  EXPECT_EQ(network.function_nodes().size(), 2);
+  EXPECT_EQ(evaluate_network(input_socket, output_socket, 2), 144);
+}
+
+TEST(multi_function_network_optimization, ConstantFolding)
+{
+  CustomMF_SI_SI_SO<int, int, int> add_fn("add", [](int a, int b) { return a + b; });
+  CustomMF_Constant<int> three_fn{3};
+
+  /* x + (3 + 3) */
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  MFNode &three_node = network.add_function(three_fn);
+  MFNode &add_node1 = network.add_function(add_fn);
+  MFNode &add_node2 = network.add_function(add_fn);
+  network.add_link(three_node.output(0), add_node1.input(0));
+  network.add_link(three_node.output(0), add_node1.input(1));
+  network.add_link(input_socket, add_node2.input(0));
+  network.add_link(add_node1.output(0), add_node2.input(1));
+  network.add_link(add_node2.output(0), output_socket);
+
+  ResourceScope scope;
+  OptimizationStats stats = optimize(network, scope);
+
+  /* The constant and the first add node are replaced by a single folded node. */
+  EXPECT_EQ(stats.constant_folding, 1);
+  EXPECT_EQ(network.function_nodes().size(), 2);
+  EXPECT_EQ(evaluate_network(input_socket, output_socket, 4), 10);
+}
+
+}  // namespace
+}  // namespace blender::fn::mf_network_optimization::tests
@@ -276,5 +276,81 @@ TEST(multi_function_network, Test2)
   }
 }
 
+TEST(multi_function_network, ChunkedEvaluation)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(multiply_fn);
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket1 = network.add_output("Output 1", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket2 = network.add_output("Output 2", MFDataType::ForSingle<int>());
+  network.add_link(input_socket, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input_socket, node2.input(1));
+  network.add_link(node2.output(0), output_socket1);
+  network.add_link(input_socket, output_socket2);
+
+  MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket1, &output_socket2}};
+  network_fn.set_chunk_size(7);
+
+  const int64_t size = 100;
+  Array<int> values(size);
+  for (const int64_t i : IndexRange(size)) {
+    values[i] = i;
+  }
+
+  {
+    Array<int> results1(size, -1);
+    Array<int> results2(size, -1);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+
+    network_fn.call(IndexRange(size), params, context);
+
+    for (const int64_t i : IndexRange(size)) {
+      EXPECT_EQ(results1[i], (i + 10) * i);
+      EXPECT_EQ(results2[i], i);
+    }
+  }
+  {
+    Vector<int64_t> indices;
+    for (int64_t i = 3; i < size; i += 3) {
+      indices.append(i);
+    }
+
+    Array<int> results1(size, -1);
+    Array<int> results2(size, -1);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_uninitialized_single_output(results1.as_mutable_span());
+    params.add_uninitialized_single_output(results2.as_mutable_span());
+
+    MFContextBuilder context;
+
+    network_fn.call(indices.as_span(), params, context);
+
+    for (const int64_t i : IndexRange(size)) {
+      if (i > 0 && i % 3 == 0) {
+        EXPECT_EQ(results1[i], (i + 10) * i);
+        EXPECT_EQ(results2[i], i);
+      }
+      else {
+        EXPECT_EQ(results1[i], -1);
+        EXPECT_EQ(results2[i], -1);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace blender::fn::tests
@@ -278,6 +278,54 @@ TEST(multi_function, CustomMF_SI_SI_SO)
   EXPECT_EQ(outputs[3], 90);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Range)
+{
+  CustomMF_SI_SI_SO<int, int, int> fn("sub", [](int a, int b) { return a - b; });
+
+  Array<int> values_a = {4, 6, 8, 9};
+  Array<int> values_b = {1, 2, 3, 4};
+  int value_c = 10;
+
+  MFContextBuilder context;
+
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(1, 3), params, context);
+    EXPECT_EQ(outputs[0], -1);
+    EXPECT_EQ(outputs[1], 4);
+    EXPECT_EQ(outputs[2], 5);
+    EXPECT_EQ(outputs[3], 5);
+  }
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(&value_c);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(4), params, context);
+    EXPECT_EQ(outputs[0], -6);
+    EXPECT_EQ(outputs[1], -4);
+    EXPECT_EQ(outputs[2], -2);
+    EXPECT_EQ(outputs[3], -1);
+  }
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(&value_c);
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(2), params, context);
+    EXPECT_EQ(outputs[0], 9);
+    EXPECT_EQ(outputs[1], 8);
+    EXPECT_EQ(outputs[2], -1);
+    EXPECT_EQ(outputs[3], -1);
+  }
+}
+
 TEST(multi_function, CustomMF_SI_SI_SI_SO)
 {
   CustomMF_SI_SI_SI_SO<int, std::string, bool, uint> fn{
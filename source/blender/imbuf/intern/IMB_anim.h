@@ -136,6 +136,8 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket *next_packet;
+  /* Frames decoded ahead during playback. */
+  struct AnimDecodeQueue *decode_queue;
 #endif
 
   char index_dir[768];
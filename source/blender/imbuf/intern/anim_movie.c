@@ -55,9 +55,11 @@
 
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
 #ifdef WITH_AVI
@@ -80,10 +82,39 @@
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
 #  include <libavutil/imgutils.h>
+#  include <libavutil/opt.h>
 #  include <libavutil/rational.h>
 #  include <libswscale/swscale.h>
 
 #  include "ffmpeg_compat.h"
+
+/* libswscale can convert slices of the image on multiple threads since FFmpeg 5.0. */
+#  if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+#    define FFMPEG_SWSCALE_THREADING
+#  endif
+
+/* Number of frames that are decoded ahead of the requested one during playback. */
+#  define FFMPEG_DECODE_AHEAD_FRAMES 4
+
+typedef struct AnimDecodedFrame {
+  struct ImBuf *ibuf;
+  int position;
+  int64_t pts;
+  int64_t next_pts;
+} AnimDecodedFrame;
+
+/* Frames decoded by a background task. While the task is running, it owns the decoder state of
+ * the anim: format and codec context, frames, packet and `next_pts`. */
+typedef struct AnimDecodeQueue {
+  TaskPool *task_pool;
+  ThreadMutex mutex;
+  /* Last requested frame followed by frames decoded ahead, in decoding order. */
+  AnimDecodedFrame frames[FFMPEG_DECODE_AHEAD_FRAMES + 1];
+  int num_frames;
+  int next_position;
+  bool running;
+  bool cancel;
+} AnimDecodeQueue;
 #endif /* WITH_FFMPEG */
 
 int ismovie(const char *UNUSED(filepath))
@@ -507,6 +538,43 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
   return (anim->x & 31) != 0;
 }
 
+static struct SwsContext *ffmpeg_sws_get_context(struct anim *anim)
+{
+  const int flags = SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT;
+
+#  if defined(FFMPEG_SWSCALE_THREADING)
+  struct SwsContext *context = sws_alloc_context();
+  if (context == NULL) {
+    return NULL;
+  }
+  av_opt_set_int(context, "srcw", anim->x, 0);
+  av_opt_set_int(context, "srch", anim->y, 0);
+  av_opt_set_int(context, "src_format", anim->pCodecCtx->pix_fmt, 0);
+  av_opt_set_int(context, "dstw", anim->x, 0);
+  av_opt_set_int(context, "dsth", anim->y, 0);
+  av_opt_set_int(context, "dst_format", AV_PIX_FMT_RGBA, 0);
+  av_opt_set_int(context, "sws_flags", flags, 0);
+  av_opt_set_int(context, "threads", BLI_system_thread_count(), 0);
+
+  if (sws_init_context(context, NULL, NULL) < 0) {
+    sws_freeContext(context);
+    return NULL;
+  }
+  return context;
+#  else
+  return sws_getContext(anim->x,
+                        anim->y,
+                        anim->pCodecCtx->pix_fmt,
+                        anim->x,
+                        anim->y,
+                        AV_PIX_FMT_RGBA,
+                        flags,
+                        NULL,
+                        NULL,
+                        NULL);
+#  endif
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -713,16 +781,7 @@ static int startffmpeg(struct anim *anim)
     anim->preseek = 0;
   }
 
-  anim->img_convert_ctx = sws_getContext(anim->x,
-                                         anim->y,
-                                         anim->pCodecCtx->pix_fmt,
-                                         anim->x,
-                                         anim->y,
-                                         AV_PIX_FMT_RGBA,
-                                         SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-                                         NULL,
-                                         NULL,
-                                         NULL);
+  anim->img_convert_ctx = ffmpeg_sws_get_context(anim);
 
   if (!anim->img_convert_ctx) {
     fprintf(stderr, "Can't transform color space??? Bailing out...\n");
@@ -766,16 +825,56 @@ static int startffmpeg(struct anim *anim)
   return 0;
 }
 
+static void ffmpeg_buffer_free_noop(void *UNUSED(opaque), uint8_t *UNUSED(data))
+{
+}
+
+/* Convert the frame to RGBA, on multiple threads when libswscale supports it. */
+static void ffmpeg_sws_scale(struct anim *anim,
+                             AVFrame *input,
+                             uint8_t *const dst[4],
+                             const int dst_stride[4])
+{
+#  if defined(FFMPEG_SWSCALE_THREADING)
+  /* Threaded conversion requires reference counted frames. The destination buffer is owned by
+   * the image buffer, so it is wrapped without taking ownership. */
+  if (input->buf[0] != NULL) {
+    AVFrame *output = av_frame_alloc();
+    output->format = AV_PIX_FMT_RGBA;
+    output->width = anim->x;
+    output->height = anim->y;
+    output->data[0] = dst[0];
+    output->linesize[0] = dst_stride[0];
+    output->buf[0] = av_buffer_create(dst[0], 0, ffmpeg_buffer_free_noop, NULL, 0);
+
+    const int ret = (output->buf[0] != NULL) ?
+                        sws_scale_frame(anim->img_convert_ctx, output, input) :
+                        -1;
+    av_frame_free(&output);
+    if (ret >= 0) {
+      return;
+    }
+  }
+#  endif
+
+  sws_scale(anim->img_convert_ctx,
+            (const uint8_t *const *)input->data,
+            input->linesize,
+            0,
+            anim->y,
+            dst,
+            dst_stride);
+}
+
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
   AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
   if (!anim->pFrameComplete) {
@@ -832,13 +931,7 @@ static void ffmpeg_postprocess(struct anim *anim)
   const int dstStride2[4] = {-dstStride[0], 0, 0, 0};
   uint8_t *dst2[4] = {dst[0] + (anim->y - 1) * dstStride[0], 0, 0, 0};
 
-  sws_scale(anim->img_convert_ctx,
-            (const uint8_t *const *)input->data,
-            input->linesize,
-            0,
-            anim->y,
-            dst2,
-            dstStride2);
+  ffmpeg_sws_scale(anim, input, dst2, dstStride2);
 #  else
   /* Scale with swscale then flip image over Y axis. */
   int *dstStride = anim->pFrameRGB->linesize;
@@ -849,13 +942,7 @@ static void ffmpeg_postprocess(struct anim *anim)
   unsigned char *bottom;
   unsigned char *top;
 
-  sws_scale(anim->img_convert_ctx,
-            (const uint8_t *const *)input->data,
-            input->linesize,
-            0,
-            anim->y,
-            dst2,
-            dstStride2);
+  ffmpeg_sws_scale(anim, input, dst2, dstStride2);
 
   bottom = (unsigned char *)ibuf->rect;
   top = bottom + ibuf->x * (ibuf->y - 1) * 4;
@@ -979,6 +1066,206 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
   return (rval >= 0);
 }
 
+static ImBuf *ffmpeg_frame_ibuf_alloc(struct anim *anim)
+{
+  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
+   * when destination buffer is not properly aligned. For example, this happens
+   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
+   * still best to avoid crash.
+   *
+   * This is achieved by using own allocation call rather than relying on
+   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
+   * to perform aligned allocation.
+   *
+   * In theory this could give better performance, since SIMD operations on
+   * aligned data are usually faster.
+   *
+   * Note that even though sometimes vertical flip is required it does not
+   * affect on alignment of data passed to sws_scale because if the X dimension
+   * is not 32 byte aligned special intermediate buffer is allocated.
+   *
+   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
+   * and is fixed in the newer versions than 4.3.1. */
+  ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, 0);
+  ibuf->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
+  ibuf->mall |= IB_rect;
+
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+  return ibuf;
+}
+
+/* Frames decoded ahead are not part of any cache and can't be freed when memory is needed. Only
+ * decode them while the memory in use stays within the cache limit. */
+static bool ffmpeg_decode_ahead_fits_cache_limit(const struct anim *anim)
+{
+  const size_t mem_limit = MEM_CacheLimiter_get_maximum();
+  const size_t frame_size = (size_t)4 * anim->x * anim->y;
+  return mem_limit == 0 || MEM_get_memory_in_use() + frame_size <= mem_limit;
+}
+
+/* Decode frames following the last decoded one, until the queue is full, canceled or the cache
+ * limit is reached. */
+static void ffmpeg_decode_ahead_task(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  struct anim *anim = BLI_task_pool_user_data(pool);
+  AnimDecodeQueue *queue = anim->decode_queue;
+
+  while (true) {
+    BLI_mutex_lock(&queue->mutex);
+    const bool stop = queue->cancel || !anim->pFrameComplete ||
+                      queue->num_frames == FFMPEG_DECODE_AHEAD_FRAMES + 1 ||
+                      !ffmpeg_decode_ahead_fits_cache_limit(anim);
+    if (stop) {
+      queue->running = false;
+    }
+    BLI_mutex_unlock(&queue->mutex);
+
+    if (stop) {
+      break;
+    }
+
+    /* Same as the end of #ffmpeg_fetchibuf: convert the pending frame, then decode the next one
+     * to know where the converted frame ends. */
+    AnimDecodedFrame frame;
+    frame.ibuf = ffmpeg_frame_ibuf_alloc(anim);
+    frame.position = queue->next_position++;
+    frame.pts = anim->next_pts;
+    ffmpeg_postprocess(anim, frame.ibuf);
+    ffmpeg_decode_video_frame(anim);
+    frame.next_pts = anim->next_pts;
+
+    BLI_mutex_lock(&queue->mutex);
+    queue->frames[queue->num_frames++] = frame;
+    BLI_mutex_unlock(&queue->mutex);
+  }
+}
+
+/* Start decoding frames following the last frame in background, the last frame is added to the
+ * queue so repeated requests for it are handled without stopping the task. */
+static void ffmpeg_decode_queue_start(struct anim *anim, int position)
+{
+  if (!anim->pFrameComplete) {
+    return;
+  }
+
+  if (anim->decode_queue == NULL) {
+    anim->decode_queue = MEM_callocN(sizeof(AnimDecodeQueue), "AnimDecodeQueue");
+    anim->decode_queue->task_pool = BLI_task_pool_create_background_serial(anim,
+                                                                          TASK_PRIORITY_LOW);
+    BLI_mutex_init(&anim->decode_queue->mutex);
+  }
+
+  AnimDecodeQueue *queue = anim->decode_queue;
+  BLI_assert(!queue->running && queue->num_frames == 0);
+
+  IMB_refImBuf(anim->last_frame);
+  queue->frames[0].ibuf = anim->last_frame;
+  queue->frames[0].position = position;
+  queue->frames[0].pts = anim->last_pts;
+  queue->frames[0].next_pts = anim->next_pts;
+  queue->num_frames = 1;
+  queue->next_position = position + 1;
+
+  queue->cancel = false;
+  queue->running = true;
+  BLI_task_pool_push(queue->task_pool, ffmpeg_decode_ahead_task, NULL, false, NULL);
+}
+
+/* Wait for the background task, so the decoder can be used directly. The newest decoded frame
+ * becomes the last frame, which matches the state in which the decoder was left. */
+static void ffmpeg_decode_queue_stop(struct anim *anim)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+  if (queue == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(&queue->mutex);
+  queue->cancel = true;
+  BLI_mutex_unlock(&queue->mutex);
+  BLI_task_pool_work_and_wait(queue->task_pool);
+
+  if (queue->num_frames > 0) {
+    AnimDecodedFrame *newest = &queue->frames[queue->num_frames - 1];
+    IMB_freeImBuf(anim->last_frame);
+    anim->last_frame = newest->ibuf;
+    anim->last_pts = newest->pts;
+    anim->curposition = newest->position;
+
+    for (int i = 0; i < queue->num_frames - 1; i++) {
+      IMB_freeImBuf(queue->frames[i].ibuf);
+    }
+    queue->num_frames = 0;
+  }
+}
+
+static void ffmpeg_decode_queue_free(struct anim *anim)
+{
+  if (anim->decode_queue == NULL) {
+    return;
+  }
+
+  ffmpeg_decode_queue_stop(anim);
+  BLI_task_pool_free(anim->decode_queue->task_pool);
+  BLI_mutex_end(&anim->decode_queue->mutex);
+  MEM_freeN(anim->decode_queue);
+  anim->decode_queue = NULL;
+}
+
+/* Take the requested frame from the queue, if it was decoded already. Frames preceding it are
+ * not needed anymore, which makes room for decoding further ahead. */
+static ImBuf *ffmpeg_decode_queue_pop(struct anim *anim, int64_t pts_to_search, int position)
+{
+  AnimDecodeQueue *queue = anim->decode_queue;
+  if (queue == NULL) {
+    return NULL;
+  }
+
+  ImBuf *ibuf = NULL;
+
+  BLI_mutex_lock(&queue->mutex);
+  for (int i = 0; i < queue->num_frames; i++) {
+    AnimDecodedFrame *frame = &queue->frames[i];
+    if (frame->pts <= pts_to_search && frame->next_pts > pts_to_search) {
+      for (int j = 0; j < i; j++) {
+        IMB_freeImBuf(queue->frames[j].ibuf);
+      }
+      queue->num_frames -= i;
+      memmove(queue->frames, frame, sizeof(*frame) * queue->num_frames);
+      queue->frames[0].position = position;
+
+      ibuf = queue->frames[0].ibuf;
+      IMB_refImBuf(ibuf);
+      break;
+    }
+  }
+  /* Decoder state can only be read when the task is not running. */
+  const bool restart = ibuf != NULL && !queue->running && anim->pFrameComplete &&
+                       ffmpeg_decode_ahead_fits_cache_limit(anim);
+  if (restart) {
+    queue->cancel = false;
+    queue->running = true;
+  }
+  BLI_mutex_unlock(&queue->mutex);
+
+  if (restart) {
+    /* Let the finished task exit before pushing a new one. */
+    BLI_task_pool_work_and_wait(queue->task_pool);
+    BLI_task_pool_push(queue->task_pool, ffmpeg_decode_ahead_task, NULL, false, NULL);
+  }
+
+  if (ibuf != NULL) {
+    anim->curposition = position;
+    if (!restart && !ffmpeg_decode_ahead_fits_cache_limit(anim)) {
+      /* Give the memory of the frames decoded ahead back to the caches. */
+      ffmpeg_decode_queue_stop(anim);
+    }
+  }
+
+  return ibuf;
+}
+
 static int match_format(const char *name, AVFormatContext *pFormatCtx)
 {
   const char *p;
@@ -1279,6 +1566,17 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
          frame_rate,
          st_time);
 
+  /* Frame was decoded ahead in background. */
+  ImBuf *ibuf = ffmpeg_decode_queue_pop(anim, pts_to_search, position);
+  if (ibuf != NULL) {
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: frame decoded ahead\n");
+    return ibuf;
+  }
+
+  /* Decode ahead only during playback, when frames are requested in sequence. */
+  const bool is_sequential = position == anim->curposition + 1;
+  ffmpeg_decode_queue_stop(anim);
+
   if (ffmpeg_pts_matches_last_frame(anim, pts_to_search)) {
     av_log(anim->pFormatCtx,
            AV_LOG_DEBUG,
@@ -1287,6 +1585,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            (int64_t)anim->next_pts);
     IMB_refImBuf(anim->last_frame);
     anim->curposition = position;
+    if (is_sequential) {
+      ffmpeg_decode_queue_start(anim, position);
+    }
     return anim->last_frame;
   }
 
@@ -1301,32 +1602,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   }
 
   IMB_freeImBuf(anim->last_frame);
+  anim->last_frame = ffmpeg_frame_ibuf_alloc(anim);
 
-  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
-   * when destination buffer is not properly aligned. For example, this happens
-   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
-   * still best to avoid crash.
-   *
-   * This is achieved by using own allocation call rather than relying on
-   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
-   * to perform aligned allocation.
-   *
-   * In theory this could give better performance, since SIMD operations on
-   * aligned data are usually faster.
-   *
-   * Note that even though sometimes vertical flip is required it does not
-   * affect on alignment of data passed to sws_scale because if the X dimension
-   * is not 32 byte aligned special intermediate buffer is allocated.
-   *
-   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
-   * and is fixed in the newer versions than 4.3.1. */
-  anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, 0);
-  anim->last_frame->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
-  anim->last_frame->mall |= IB_rect;
-
-  anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
-
-  ffmpeg_postprocess(anim);
+  ffmpeg_postprocess(anim, anim->last_frame);
 
   anim->last_pts = anim->next_pts;
 
@@ -1336,6 +1614,10 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   IMB_refImBuf(anim->last_frame);
 
+  if (is_sequential) {
+    ffmpeg_decode_queue_start(anim, position);
+  }
+
   return anim->last_frame;
 }
 
@@ -1345,6 +1627,8 @@ static void free_anim_ffmpeg(struct anim *anim)
     return;
   }
 
+  ffmpeg_decode_queue_free(anim);
+
   if (anim->pCodecCtx) {
     avcodec_free_context(&anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
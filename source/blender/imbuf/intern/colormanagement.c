@@ -43,6 +43,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
@@ -100,10 +101,37 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Analytic form of an OCIO processor, see #colormanage_fast_path_detect. */
+typedef struct ColormanageFastPath {
+  int transfer_in;
+  int transfer_out;
+  bool use_matrix;
+  float matrix[3][3];
+  /* Lookup table for byte buffers, only used without matrix. */
+  unsigned char byte_table[256];
+} ColormanageFastPath;
+
+/* Result of #colormanage_fast_path_detect, which is too slow to run whenever a processor is
+ * created: processors are also created to transform single pixels. */
+typedef struct ColormanageFastPathCacheEntry {
+  bool use_fast_path;
+  ColormanageFastPath fast_path;
+} ColormanageFastPathCacheEntry;
+
+/* Entries by description of the transform, cleared when it grows too large, e.g. when changing
+ * the exposure of the view. */
+#define FAST_PATH_CACHE_MAX_ENTRIES 256
+static GHash *fast_path_cache = NULL;
+static pthread_mutex_t fast_path_cache_lock = BLI_MUTEX_INITIALIZER;
+
 typedef struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+  /* When set, the fast path gives the same result as the OCIO processor, which is verified
+   * including negative and out of range values. */
+  bool use_fast_path;
+  ColormanageFastPath fast_path;
 } ColormanageProcessor;
 
 static struct global_gpu_state {
@@ -732,6 +760,11 @@ void colormanagement_exit(void)
   memset(&global_gpu_state, 0, sizeof(global_gpu_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  if (fast_path_cache) {
+    BLI_ghash_free(fast_path_cache, MEM_freeN, MEM_freeN);
+    fast_path_cache = NULL;
+  }
+
   colormanage_free_config();
 }
 
@@ -3748,6 +3781,218 @@ void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin,
 /** \name Pixel Processor Functions
  * \{ */
 
+static bool colormanage_fast_path_compare(const float a, const float b, const int transfer_out)
+{
+  /* The sRGB transforms of the default configuration are dense 1D LUTs. Towards the display they
+   * deviate from the analytic curve by about 1e-4 in dark colors, which can not be seen. */
+  const float max_diff = (transfer_out == BLI_COLOR_TRANSFER_LINEAR_TO_SRGB) ? 5e-4f : 1e-5f;
+  return compare_ff_relative(a, b, max_diff, 64);
+}
+
+static bool colormanage_fast_path_verify_probe(OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                                               const ColormanageFastPath *fast_path,
+                                               const float probe[3])
+{
+  const float(*matrix)[3] = fast_path->use_matrix ? fast_path->matrix : NULL;
+  float expected[3], result[3];
+  copy_v3_v3(expected, probe);
+  copy_v3_v3(result, probe);
+
+  rgb_transform_buffer(
+      expected, 1, 3, fast_path->transfer_in, matrix, fast_path->transfer_out, false);
+  OCIO_cpuProcessorApplyRGB(cpu_processor, result);
+
+  for (int k = 0; k < 3; k++) {
+    if (!colormanage_fast_path_compare(expected[k], result[k], fast_path->transfer_out)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool colormanage_fast_path_verify(OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                                         const ColormanageFastPath *fast_path)
+{
+  /* Negative and large values. The transfer functions of #rgb_transform_buffer clamp negative
+   * values to zero and extrapolate large values, while OCIO transforms based on LUTs handle
+   * negative values and clamp at the end of their domain. The sRGB transforms of the default
+   * configuration do both, so they are not replaced by the fast path. */
+  const float out_of_range_probes[][3] = {{-0.1f, -0.1f, -0.1f},
+                                          {50.0f, 50.0f, 50.0f},
+                                          {-0.1f, 0.5f, 50.0f}};
+  for (int i = 0; i < ARRAY_SIZE(out_of_range_probes); i++) {
+    if (!colormanage_fast_path_verify_probe(cpu_processor, fast_path, out_of_range_probes[i])) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < 256; i++) {
+    const float v = i / 255.0f;
+    /* Grays including HDR values, ramps of the primaries and a mix of channels. */
+    const float probes[][3] = {{v, v, v},
+                               {4.0f * v, 4.0f * v, 4.0f * v},
+                               {v, 0.0f, 0.0f},
+                               {0.0f, v, 0.0f},
+                               {0.0f, 0.0f, v},
+                               {v, 1.0f - v, 0.5f}};
+
+    for (int j = 0; j < ARRAY_SIZE(probes); j++) {
+      if (!colormanage_fast_path_verify_probe(cpu_processor, fast_path, probes[j])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Many of the transforms used in practice are only a matrix between two sRGB or linear spaces,
+ * e.g. the conversion of sRGB textures to scene linear or the standard view transform. These can
+ * be computed much faster than by the generic OCIO processor. Since the OCIO configuration does
+ * not expose the structure of transforms, it is recognized by probing the processor.
+ */
+static bool colormanage_fast_path_detect(OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                                         ColormanageFastPath *r_fast_path)
+{
+  const int transfers_in[] = {BLI_COLOR_TRANSFER_NONE, BLI_COLOR_TRANSFER_SRGB_TO_LINEAR};
+  const int transfers_out[] = {BLI_COLOR_TRANSFER_NONE, BLI_COLOR_TRANSFER_LINEAR_TO_SRGB};
+
+  for (int i = 0; i < ARRAY_SIZE(transfers_in); i++) {
+    for (int j = 0; j < ARRAY_SIZE(transfers_out); j++) {
+      ColormanageFastPath fast_path = {0};
+      fast_path.transfer_in = transfers_in[i];
+      fast_path.transfer_out = transfers_out[j];
+
+      /* Both transfer functions map the primaries to themselves, so the matrix columns follow
+       * from the transformed primaries. */
+      for (int col = 0; col < 3; col++) {
+        float primary[3] = {0.0f, 0.0f, 0.0f};
+        primary[col] = 1.0f;
+        OCIO_cpuProcessorApplyRGB(cpu_processor, primary);
+        for (int row = 0; row < 3; row++) {
+          const float value = (fast_path.transfer_out == BLI_COLOR_TRANSFER_LINEAR_TO_SRGB) ?
+                                  srgb_to_linearrgb(primary[row]) :
+                                  primary[row];
+          fast_path.matrix[col][row] = value;
+        }
+      }
+      float unit[3][3];
+      unit_m3(unit);
+      fast_path.use_matrix = !(compare_v3v3(fast_path.matrix[0], unit[0], 1e-6f) &&
+                               compare_v3v3(fast_path.matrix[1], unit[1], 1e-6f) &&
+                               compare_v3v3(fast_path.matrix[2], unit[2], 1e-6f));
+
+      if (!colormanage_fast_path_verify(cpu_processor, &fast_path)) {
+        continue;
+      }
+
+      for (int k = 0; k < 256; k++) {
+        float value = rgb_transfer_evaluate(fast_path.transfer_in, k / 255.0f);
+        value = rgb_transfer_evaluate(fast_path.transfer_out, value);
+        fast_path.byte_table[k] = unit_float_to_uchar_clamp(value);
+      }
+
+      *r_fast_path = fast_path;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * \param cache_key: Identifies the transform of the processor, its fast path is only detected
+ * the first time.
+ */
+static void colormanage_processor_init_fast_path(ColormanageProcessor *cm_processor,
+                                                 const char *cache_key)
+{
+  if (cm_processor->cpu_processor == NULL) {
+    return;
+  }
+
+  bool is_cached = false;
+  BLI_mutex_lock(&fast_path_cache_lock);
+  if (fast_path_cache) {
+    const ColormanageFastPathCacheEntry *entry = BLI_ghash_lookup(fast_path_cache, cache_key);
+    if (entry) {
+      cm_processor->use_fast_path = entry->use_fast_path;
+      cm_processor->fast_path = entry->fast_path;
+      is_cached = true;
+    }
+  }
+  BLI_mutex_unlock(&fast_path_cache_lock);
+
+  if (is_cached) {
+    return;
+  }
+
+  /* Detect without holding the lock, other threads may detect the same transform meanwhile. */
+  cm_processor->use_fast_path = colormanage_fast_path_detect(cm_processor->cpu_processor,
+                                                             &cm_processor->fast_path);
+
+  BLI_mutex_lock(&fast_path_cache_lock);
+  if (fast_path_cache == NULL) {
+    fast_path_cache = BLI_ghash_str_new(__func__);
+  }
+  else if (BLI_ghash_len(fast_path_cache) >= FAST_PATH_CACHE_MAX_ENTRIES) {
+    BLI_ghash_clear(fast_path_cache, MEM_freeN, MEM_freeN);
+  }
+  if (!BLI_ghash_haskey(fast_path_cache, cache_key)) {
+    ColormanageFastPathCacheEntry *entry = MEM_mallocN(sizeof(ColormanageFastPathCacheEntry),
+                                                       __func__);
+    entry->use_fast_path = cm_processor->use_fast_path;
+    entry->fast_path = cm_processor->fast_path;
+    BLI_ghash_insert(fast_path_cache, BLI_strdup(cache_key), entry);
+  }
+  BLI_mutex_unlock(&fast_path_cache_lock);
+}
+
+static bool colormanage_processor_fast_path_is_noop(const ColormanageProcessor *cm_processor)
+{
+  const ColormanageFastPath *fast_path = &cm_processor->fast_path;
+  return fast_path->transfer_in == BLI_COLOR_TRANSFER_NONE &&
+         fast_path->transfer_out == BLI_COLOR_TRANSFER_NONE && !fast_path->use_matrix;
+}
+
+static void colormanage_processor_apply_fast_path(const ColormanageProcessor *cm_processor,
+                                                  float *buffer,
+                                                  size_t num_pixels,
+                                                  int channels,
+                                                  bool predivide)
+{
+  const ColormanageFastPath *fast_path = &cm_processor->fast_path;
+  rgb_transform_buffer(buffer,
+                       num_pixels,
+                       channels,
+                       fast_path->transfer_in,
+                       fast_path->use_matrix ? fast_path->matrix : NULL,
+                       fast_path->transfer_out,
+                       predivide);
+}
+
+typedef struct FastPathThreadData {
+  const ColormanageProcessor *cm_processor;
+  float *buffer;
+  int width;
+  int channels;
+  bool predivide;
+} FastPathThreadData;
+
+static void processor_apply_fast_path_thread_do(void *data_v,
+                                                int start_scanline,
+                                                int num_scanlines)
+{
+  FastPathThreadData *data = (FastPathThreadData *)data_v;
+  const size_t row_size = (size_t)data->width * data->channels;
+  colormanage_processor_apply_fast_path(data->cm_processor,
+                                        data->buffer + start_scanline * row_size,
+                                        (size_t)data->width * num_scanlines,
+                                        data->channels,
+                                        data->predivide);
+}
+
 ColormanageProcessor *IMB_colormanagement_display_processor_new(
     const ColorManagedViewSettings *view_settings,
     const ColorManagedDisplaySettings *display_settings)
@@ -3780,6 +4025,17 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
       applied_view_settings->gamma,
       global_role_scene_linear);
 
+  char cache_key[5 * MAX_COLORSPACE_NAME];
+  BLI_snprintf(cache_key,
+               sizeof(cache_key),
+               "%s\n%s\n%s\n%a\n%a",
+               applied_view_settings->look,
+               applied_view_settings->view_transform,
+               display_settings->display_device,
+               applied_view_settings->exposure,
+               applied_view_settings->gamma);
+  colormanage_processor_init_fast_path(cm_processor, cache_key);
+
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
     BKE_curvemapping_premultiply(cm_processor->curve_mapping, false);
@@ -3806,6 +4062,10 @@ ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *f
   }
   OCIO_processorRelease(processor);
 
+  char cache_key[2 * MAX_COLORSPACE_NAME + 1];
+  BLI_snprintf(cache_key, sizeof(cache_key), "%s\n%s", from_colorspace, to_colorspace);
+  colormanage_processor_init_fast_path(cm_processor, cache_key);
+
   return cm_processor;
 }
 
@@ -3815,7 +4075,10 @@ void IMB_colormanagement_processor_apply_v4(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->use_fast_path) {
+    colormanage_processor_apply_fast_path(cm_processor, pixel, 1, 4, false);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGBA(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3827,7 +4090,10 @@ void IMB_colormanagement_processor_apply_v4_predivide(ColormanageProcessor *cm_p
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->use_fast_path) {
+    colormanage_processor_apply_fast_path(cm_processor, pixel, 1, 4, true);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGBA_predivide(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3838,7 +4104,10 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->cpu_processor) {
+  if (cm_processor->use_fast_path) {
+    colormanage_processor_apply_fast_path(cm_processor, pixel, 1, 3, false);
+  }
+  else if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorApplyRGB(cm_processor->cpu_processor, pixel);
   }
 }
@@ -3884,7 +4153,20 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->cpu_processor && channels >= 3) {
+  if (cm_processor->use_fast_path && ELEM(channels, 3, 4)) {
+    if (colormanage_processor_fast_path_is_noop(cm_processor)) {
+      return;
+    }
+
+    FastPathThreadData data;
+    data.cm_processor = cm_processor;
+    data.buffer = buffer;
+    data.width = width;
+    data.channels = channels;
+    data.predivide = predivide;
+    IMB_processor_apply_threaded_scanlines(height, processor_apply_fast_path_thread_do, &data);
+  }
+  else if (cm_processor->cpu_processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3914,6 +4196,21 @@ void IMB_colormanagement_processor_apply_byte(
    * but for now it's not so important.
    */
   BLI_assert(channels == 4);
+
+  if (cm_processor->use_fast_path && !cm_processor->fast_path.use_matrix &&
+      cm_processor->curve_mapping == NULL) {
+    /* Channels are transformed independently, so a lookup table gives the exact result. */
+    const unsigned char *table = cm_processor->fast_path.byte_table;
+    const size_t num_pixels = (size_t)width * height;
+    for (size_t i = 0; i < num_pixels; i++) {
+      unsigned char *pixel = buffer + i * channels;
+      pixel[0] = table[pixel[0]];
+      pixel[1] = table[pixel[1]];
+      pixel[2] = table[pixel[2]];
+    }
+    return;
+  }
+
   float pixel[4];
   for (int y = 0; y < height; y++) {
     for (int x = 0; x < width; x++) {
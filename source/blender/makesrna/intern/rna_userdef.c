@@ -5430,6 +5430,14 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "geometry_nodes_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "geometry_nodes_cache_limit");
+  RNA_def_property_range(prop, 1, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Geometry Nodes Cache Limit",
+                           "Memory used to keep the results of geometry nodes between "
+                           "evaluations, shared by all modifiers (in megabytes)");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -6116,6 +6124,14 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Compress File", "Enable file compression when saving .blend files");
 
+  prop = RNA_def_property(srna, "use_file_compression_zstd", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_FILECOMPRESS_ZSTD);
+  RNA_def_property_ui_text(prop,
+                           "Zstd Compression",
+                           "Compress .blend files with Zstandard instead of gzip, which is faster "
+                           "and allows reading parts of the file without decompressing all of it "
+                           "(files can not be opened by builds without Zstd support)");
+
   prop = RNA_def_property(srna, "use_load_ui", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_negative_sdna(prop, NULL, "flag", USER_FILENOUI);
   RNA_def_property_ui_text(prop, "Load UI", "Load user interface setup when loading .blend files");
@@ -27,6 +27,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "CLG_log.h"
+
 #include "BLI_float3.hh"
 #include "BLI_listbase.h"
 #include "BLI_multi_value_map.hh"
@@ -71,10 +73,12 @@
 #include "RNA_enum_types.h"
 
 #include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
 #include "MOD_modifiertypes.h"
 #include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
 #include "MOD_nodes_evaluator.hh"
 #include "MOD_ui_common.h"
 
@@ -95,10 +99,14 @@ using blender::StringRefNull;
 using blender::Vector;
 using blender::fn::GMutablePointer;
 using blender::fn::GPointer;
+using blender::modifiers::geometry_nodes::InputGeometryState;
+using blender::modifiers::geometry_nodes::NodeOutputCache;
 using blender::nodes::GeoNodeExecParams;
 using namespace blender::fn::multi_function_types;
 using namespace blender::nodes::derived_node_tree_types;
 
+static CLG_LogRef LOG = {"mod.nodes"};
+
 static void initData(ModifierData *md)
 {
   NodesModifierData *nmd = (NodesModifierData *)md;
@@ -251,6 +259,14 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
   return false;
 }
 
+static NodeOutputCache *ensure_node_output_cache(NodesModifierData *nmd)
+{
+  if (nmd->modifier.runtime == nullptr) {
+    nmd->modifier.runtime = new NodeOutputCache();
+  }
+  return static_cast<NodeOutputCache *>(nmd->modifier.runtime);
+}
+
 static bool logging_enabled(const ModifierEvalContext *ctx)
 {
   if (!DEG_is_active(ctx->depsgraph)) {
@@ -841,10 +857,42 @@ static void log_ui_hints(const DSocket socket,
   }
 }
 
+/**
+ * The modifier input mesh is a new copy on every evaluation. When nothing but the mesh data-block
+ * is applied before this modifier, the depsgraph recalc flags of the evaluated mesh tell whether
+ * the input changed, without comparing the contents.
+ */
+static InputGeometryState get_input_geometry_state(ModifierData *md,
+                                                   const ModifierEvalContext *ctx)
+{
+  Object *object = ctx->object;
+  if (object->type != OB_MESH || (object->id.tag & LIB_TAG_COPIED_ON_WRITE) == 0) {
+    return InputGeometryState::Unknown;
+  }
+  const Mesh *mesh = BKE_object_get_pre_modified_mesh(object);
+  /* Shape keys, edit mode and parent deformation change the input without tagging the mesh. */
+  if (mesh->key != nullptr || mesh->edit_mesh != nullptr ||
+      (object->parent != nullptr && object->partype == PARSKEL)) {
+    return InputGeometryState::Unknown;
+  }
+  const Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
+  const int required_mode = (ctx->flag & MOD_APPLY_RENDER) ? eModifierMode_Render :
+                                                             eModifierMode_Realtime;
+  for (ModifierData *md_prev = md->prev; md_prev != nullptr; md_prev = md_prev->prev) {
+    if (BKE_modifier_is_enabled(scene, md_prev, required_mode)) {
+      return InputGeometryState::Unknown;
+    }
+  }
+  if (mesh->id.recalc != 0) {
+    return InputGeometryState::Changed;
+  }
+  return InputGeometryState::Unchanged;
+}
+
 /**
  * Evaluate a node group to compute the output geometry.
- * Currently, this uses a fairly basic and inefficient algorithm that might compute things more
- * often than necessary. It's going to be replaced soon.
+ * Nodes that do not depend on each other are executed in parallel, unless threading is disabled
+ * for debugging with `--debug-depsgraph-no-threads`.
  */
 static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                     Span<const NodeRef *> group_input_nodes,
@@ -857,6 +905,15 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   blender::LinearAllocator<> &allocator = scope.linear_allocator();
   blender::nodes::MultiFunctionByNode mf_by_node = get_multi_function_per_node(tree, scope);
 
+  /* Reuse the results of nodes whose inputs did not change since the last evaluation. */
+  NodeOutputCache *output_cache = nullptr;
+  if ((ctx->flag & MOD_APPLY_ORCO) == 0) {
+    output_cache = ensure_node_output_cache(nmd);
+    output_cache->begin_evaluation();
+    input_geometry_set = output_cache->stabilize_input_geometry(
+        std::move(input_geometry_set), get_input_geometry_state(&nmd->modifier, ctx));
+  }
+
   Map<DOutputSocket, GMutablePointer> group_inputs;
 
   const DTreeContext *root_context = &tree.root_context();
@@ -915,8 +972,29 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   eval_params.depsgraph = ctx->depsgraph;
   eval_params.self_object = ctx->object;
   eval_params.log_socket_value_fn = log_socket_value;
+  eval_params.use_multi_threading = (DEG_debug_flags_get(ctx->depsgraph) &
+                                     G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+  eval_params.output_cache = output_cache;
   blender::modifiers::geometry_nodes::evaluate_geometry_nodes(eval_params);
 
+  if (output_cache != nullptr) {
+    output_cache->end_evaluation();
+    if (CLOG_CHECK(&LOG, 1)) {
+      const blender::modifiers::geometry_nodes::NodeOutputCacheStats stats =
+          output_cache->stats();
+      CLOG_INFO(&LOG,
+                1,
+                "cache of %s/%s: %lld hits, %lld misses, %lld evictions, %lld entries, %lld KiB",
+                ctx->object->id.name + 2,
+                nmd->modifier.name,
+                (long long)stats.hits,
+                (long long)stats.misses,
+                (long long)stats.evictions,
+                (long long)stats.entries_num,
+                (long long)(stats.memory_usage / 1024));
+    }
+  }
+
   BLI_assert(eval_params.r_output_values.size() == 1);
   GMutablePointer result = eval_params.r_output_values[0];
   return result.relocate_out<GeometrySet>();
@@ -1160,6 +1238,11 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
   }
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  delete static_cast<NodeOutputCache *>(runtime_data);
+}
+
 static void freeData(ModifierData *md)
 {
   NodesModifierData *nmd = reinterpret_cast<NodesModifierData *>(md);
@@ -1167,6 +1250,8 @@ static void freeData(ModifierData *md)
     IDP_FreeProperty_ex(nmd->settings.properties, false);
     nmd->settings.properties = nullptr;
   }
+  freeRuntimeData(md->runtime);
+  md->runtime = nullptr;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1210,7 +1295,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ foreachTexLink,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
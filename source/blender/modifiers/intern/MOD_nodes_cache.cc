@@ -0,0 +1,394 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software  Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <atomic>
+
+#include "MOD_nodes_cache.hh"
+
+#include "BLI_vector.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_customdata.h"
+
+#include "FN_cpp_type.hh"
+
+namespace blender::modifiers::geometry_nodes {
+
+/** All node output caches, so that they can share the memory budget. */
+struct NodeOutputCacheRegistry {
+  std::mutex mutex;
+  Set<NodeOutputCache *> caches;
+};
+
+static NodeOutputCacheRegistry &cache_registry()
+{
+  static NodeOutputCacheRegistry registry;
+  return registry;
+}
+
+/** Incremented for every evaluation of any cache, to find the least recently used entries. */
+static std::atomic<int64_t> last_evaluation_index = 0;
+
+/** Memory that may be used by the node output caches of all modifiers, in bytes. */
+static int64_t memory_budget()
+{
+  return (int64_t)U.geometry_nodes_cache_limit * 1024 * 1024;
+}
+
+static GMutablePointer copy_value(GPointer value)
+{
+  const CPPType &type = *value.type();
+  void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+  type.copy_to_uninitialized(value.get(), buffer);
+  return {type, buffer};
+}
+
+static void free_value(GMutablePointer value)
+{
+  value.destruct();
+  MEM_freeN(value.get());
+}
+
+static bool geometries_are_identical(const GeometrySet &a, const GeometrySet &b)
+{
+  Vector<const GeometryComponent *> a_components = a.get_components_for_read();
+  Vector<const GeometryComponent *> b_components = b.get_components_for_read();
+  if (a_components.size() != b_components.size()) {
+    return false;
+  }
+  for (const GeometryComponent *component : a_components) {
+    if (!b_components.contains(component)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool values_are_equal(GPointer a, GPointer b)
+{
+  const CPPType &type = *a.type();
+  if (type != *b.type()) {
+    return false;
+  }
+  if (type.is<GeometrySet>()) {
+    return geometries_are_identical(*(const GeometrySet *)a.get(),
+                                    *(const GeometrySet *)b.get());
+  }
+  return type.is_equal(a.get(), b.get());
+}
+
+static bool vertex_group_names_are_equal(const MeshComponent &a, const MeshComponent &b)
+{
+  const Map<std::string, int> &names_a = a.vertex_group_names();
+  const Map<std::string, int> &names_b = b.vertex_group_names();
+  if (names_a.size() != names_b.size()) {
+    return false;
+  }
+  for (auto item : names_a.items()) {
+    if (names_b.lookup_default(item.key, -1) != item.value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int64_t estimate_component_memory(const GeometryComponent &component)
+{
+  int64_t size = 0;
+  component.attribute_foreach(
+      [&](const StringRefNull UNUSED(name), const AttributeMetaData &meta_data) {
+        size += (int64_t)component.attribute_domain_size(meta_data.domain) *
+                CustomData_sizeof(meta_data.data_type);
+        return true;
+      });
+  if (component.type() == GEO_COMPONENT_TYPE_MESH) {
+    const Mesh *mesh = static_cast<const MeshComponent &>(component).get_for_read();
+    if (mesh != nullptr) {
+      size += (int64_t)mesh->totedge * sizeof(MEdge) + (int64_t)mesh->totloop * sizeof(MLoop) +
+              (int64_t)mesh->totpoly * sizeof(MPoly);
+    }
+  }
+  return size;
+}
+
+NodeOutputCache::NodeOutputCache()
+{
+  NodeOutputCacheRegistry &registry = cache_registry();
+  std::lock_guard lock{registry.mutex};
+  registry.caches.add_new(this);
+}
+
+NodeOutputCache::~NodeOutputCache()
+{
+  {
+    NodeOutputCacheRegistry &registry = cache_registry();
+    std::lock_guard lock{registry.mutex};
+    registry.caches.remove(this);
+  }
+  this->clear();
+}
+
+GeometrySet NodeOutputCache::stabilize_input_geometry(GeometrySet geometry_set,
+                                                      const InputGeometryState state)
+{
+  /* Only a geometry that consists of a single mesh is reused, which is the common case for
+   * geometry nodes modifiers on mesh objects. */
+  Vector<const GeometryComponent *> components = geometry_set.get_components_for_read();
+  const MeshComponent *old_component = input_geometry_.get_component_for_read<MeshComponent>();
+  if (state == InputGeometryState::Unknown || components.size() != 1 ||
+      components[0]->type() != GEO_COMPONENT_TYPE_MESH) {
+    input_geometry_.clear();
+  }
+  else if (state == InputGeometryState::Unchanged && old_component != nullptr &&
+           vertex_group_names_are_equal(*old_component,
+                                        *(const MeshComponent *)components[0])) {
+    geometry_set = input_geometry_;
+  }
+  else {
+    /* The modifier stack owns the mesh that is passed in, so the cached geometry needs a copy. */
+    geometry_set.ensure_owns_direct_data();
+    input_geometry_ = geometry_set;
+  }
+  this->update_stable_components_and_memory_usage();
+  return geometry_set;
+}
+
+void NodeOutputCache::begin_evaluation()
+{
+  {
+    /* Other caches don't evict entries from this one while it is being evaluated. */
+    std::lock_guard lock{cache_registry().mutex};
+    is_evaluating_ = true;
+  }
+  evaluation_index_ = ++last_evaluation_index;
+}
+
+void NodeOutputCache::end_evaluation()
+{
+  /* Entries that were not used in this evaluation are outdated, because their inputs changed or
+   * because the node is not evaluated anymore. */
+  Vector<std::string> unused_keys;
+  for (auto item : entries_.items()) {
+    if (item.value.last_used != evaluation_index_) {
+      unused_keys.append(item.key);
+    }
+  }
+  for (const std::string &key : unused_keys) {
+    this->remove_entry(key);
+  }
+  /* Account for the entries added during this evaluation. */
+  this->update_stable_components_and_memory_usage();
+
+  std::lock_guard lock{cache_registry().mutex};
+  is_evaluating_ = false;
+  registered_memory_usage_ = stats_.memory_usage;
+  NodeOutputCache::enforce_memory_budget();
+}
+
+bool NodeOutputCache::find_least_recently_used(const std::string **r_key,
+                                               int64_t *r_last_used) const
+{
+  *r_key = nullptr;
+  *r_last_used = INT64_MAX;
+  for (auto item : entries_.items()) {
+    if (item.value.last_used < *r_last_used) {
+      *r_last_used = item.value.last_used;
+      *r_key = &item.key;
+    }
+  }
+  return *r_key != nullptr;
+}
+
+/* Must be called with the mutex of the cache registry locked. */
+void NodeOutputCache::enforce_memory_budget()
+{
+  const NodeOutputCacheRegistry &registry = cache_registry();
+  const int64_t budget = memory_budget();
+  while (true) {
+    int64_t memory_usage = 0;
+    NodeOutputCache *lru_cache = nullptr;
+    const std::string *lru_key = nullptr;
+    int64_t lru_last_used = INT64_MAX;
+    for (NodeOutputCache *cache : registry.caches) {
+      memory_usage += cache->registered_memory_usage_;
+      if (cache->is_evaluating_) {
+        continue;
+      }
+      const std::string *key;
+      int64_t last_used;
+      if (cache->find_least_recently_used(&key, &last_used) && last_used < lru_last_used) {
+        lru_cache = cache;
+        lru_key = key;
+        lru_last_used = last_used;
+      }
+    }
+    if (memory_usage <= budget || lru_cache == nullptr) {
+      break;
+    }
+    std::lock_guard lock{lru_cache->mutex_};
+    lru_cache->remove_entry(*lru_key);
+    lru_cache->stats_.evictions++;
+    lru_cache->update_stable_components_and_memory_usage();
+    lru_cache->registered_memory_usage_ = lru_cache->stats_.memory_usage;
+  }
+}
+
+bool NodeOutputCache::inputs_are_cacheable(Span<GPointer> inputs)
+{
+  std::lock_guard lock{mutex_};
+  for (const GPointer &input : inputs) {
+    if (input.is_type<GeometrySet>()) {
+      const GeometrySet &geometry_set = *(const GeometrySet *)input.get();
+      for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+        if (!stable_components_.contains(component)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool NodeOutputCache::lookup(StringRef node_key,
+                             Span<GPointer> inputs,
+                             FunctionRef<void(StringRef identifier, GPointer value)> output_fn)
+{
+  std::lock_guard lock{mutex_};
+  Entry *entry = entries_.lookup_ptr_as(node_key);
+  if (entry == nullptr || entry->inputs.size() != inputs.size()) {
+    stats_.misses++;
+    return false;
+  }
+  for (const int i : inputs.index_range()) {
+    if (!values_are_equal(entry->inputs[i], inputs[i])) {
+      stats_.misses++;
+      return false;
+    }
+  }
+  entry->last_used = evaluation_index_;
+  for (const std::pair<std::string, GMutablePointer> &output : entry->outputs) {
+    output_fn(output.first, output.second);
+  }
+  stats_.hits++;
+  return true;
+}
+
+void NodeOutputCache::add(StringRef node_key,
+                          Span<GPointer> inputs,
+                          Span<std::pair<StringRef, GMutablePointer>> outputs)
+{
+  Entry entry;
+  entry.last_used = evaluation_index_;
+  for (const GPointer &input : inputs) {
+    entry.inputs.append(copy_value(input));
+  }
+  for (const std::pair<StringRef, GMutablePointer> &output : outputs) {
+    if (output.second.is_type<GeometrySet>()) {
+      /* Do this on the output value itself, so that the geometry passed on to the next nodes is
+       * shared with the cache. */
+      output.second.get<GeometrySet>()->ensure_owns_direct_data();
+    }
+    entry.outputs.append({output.first, copy_value(output.second)});
+  }
+
+  std::lock_guard lock{mutex_};
+  this->remove_entry(node_key);
+  for (const std::pair<std::string, GMutablePointer> &output : entry.outputs) {
+    if (output.second.is_type<GeometrySet>()) {
+      const GeometrySet &geometry_set = *output.second.get<GeometrySet>();
+      for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+        stable_components_.add(component);
+      }
+    }
+  }
+  entries_.add_new(node_key, std::move(entry));
+  stats_.entries_num = entries_.size();
+}
+
+void NodeOutputCache::clear()
+{
+  Vector<std::string> keys;
+  for (const std::string &key : entries_.keys()) {
+    keys.append(key);
+  }
+  for (const std::string &key : keys) {
+    this->remove_entry(key);
+  }
+  input_geometry_.clear();
+  this->update_stable_components_and_memory_usage();
+}
+
+NodeOutputCacheStats NodeOutputCache::stats() const
+{
+  /* Entries may be evicted by other caches. */
+  std::lock_guard lock{cache_registry().mutex};
+  return stats_;
+}
+
+void NodeOutputCache::remove_entry(StringRef node_key)
+{
+  std::optional<Entry> entry = entries_.pop_try_as(node_key);
+  if (!entry.has_value()) {
+    return;
+  }
+  for (GMutablePointer value : entry->inputs) {
+    free_value(value);
+  }
+  for (std::pair<std::string, GMutablePointer> &output : entry->outputs) {
+    free_value(output.second);
+  }
+  stats_.entries_num = entries_.size();
+}
+
+void NodeOutputCache::update_stable_components_and_memory_usage()
+{
+  stable_components_.clear();
+  int64_t memory_usage = 0;
+
+  auto add_geometry = [&](const GeometrySet &geometry_set) {
+    for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+      if (stable_components_.add(component)) {
+        memory_usage += estimate_component_memory(*component);
+      }
+    }
+  };
+
+  add_geometry(input_geometry_);
+  for (const Entry &entry : entries_.values()) {
+    for (const std::pair<std::string, GMutablePointer> &output : entry.outputs) {
+      if (output.second.is_type<GeometrySet>()) {
+        add_geometry(*output.second.get<GeometrySet>());
+      }
+      else {
+        memory_usage += output.second.type()->size();
+      }
+    }
+    for (const GMutablePointer &input : entry.inputs) {
+      if (input.is_type<GeometrySet>()) {
+        add_geometry(*input.get<GeometrySet>());
+      }
+      else {
+        memory_usage += input.type()->size();
+      }
+    }
+  }
+  stats_.memory_usage = memory_usage;
+}
+
+}  // namespace blender::modifiers::geometry_nodes
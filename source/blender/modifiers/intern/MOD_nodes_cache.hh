@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software  Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "BLI_function_ref.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+
+#include "BKE_geometry_set.hh"
+
+#include "FN_generic_pointer.hh"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::modifiers::geometry_nodes {
+
+using fn::CPPType;
+using fn::GMutablePointer;
+using fn::GPointer;
+
+struct NodeOutputCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+  /** Estimated memory used by the cached values, in bytes. */
+  int64_t memory_usage = 0;
+  int64_t entries_num = 0;
+};
+
+/** How the modifier input geometry relates to the input of the previous evaluation. */
+enum class InputGeometryState {
+  /** The input does not only depend on the mesh data-block, it is not reused. */
+  Unknown,
+  /** The mesh data-block changed since the previous evaluation. */
+  Changed,
+  /** The mesh data-block did not change since the previous evaluation. */
+  Unchanged,
+};
+
+/**
+ * Keeps the outputs of geometry nodes alive between evaluations of the same modifier, so that
+ * nodes whose inputs did not change do not have to be executed again. It is stored as runtime
+ * data of the modifier.
+ *
+ * The memory budget set in the preferences is shared by the caches of all modifiers. When it is
+ * exceeded, the least recently used entries of caches that are not being evaluated are evicted.
+ *
+ * Geometry inputs are compared by the identity of their components rather than by their content.
+ * This is only correct when the cache keeps the components alive, because otherwise the memory of
+ * a freed component could be reused for different data. Therefore, a node can only be cached when
+ * all of its geometry inputs are stable, i.e. when they were produced by cached nodes or are the
+ * modifier input geometry that is stabilized with #stabilize_input_geometry.
+ *
+ * All methods that are used during evaluation are thread-safe.
+ */
+class NodeOutputCache {
+ private:
+  struct Entry {
+    /** Copies of the input values, to compare against the inputs of later evaluations. */
+    Vector<GMutablePointer> inputs;
+    /** Copies of the output values with the identifiers of their sockets. */
+    Vector<std::pair<std::string, GMutablePointer>> outputs;
+    /** Index of the evaluation in which the entry was used last, shared by all caches. */
+    int64_t last_used = 0;
+  };
+
+  std::mutex mutex_;
+  /** Entries identified by the path of the node in the node tree and a hash of its settings. */
+  Map<std::string, Entry> entries_;
+  /** Geometry components that are referenced by cached values. */
+  Set<const GeometryComponent *> stable_components_;
+
+  /** Modifier input geometry of the last evaluation. */
+  GeometrySet input_geometry_;
+
+  int64_t evaluation_index_ = 0;
+  NodeOutputCacheStats stats_;
+
+  /* Protected by the mutex of the cache registry. */
+  bool is_evaluating_ = false;
+  int64_t registered_memory_usage_ = 0;
+
+ public:
+  NodeOutputCache();
+  ~NodeOutputCache();
+
+  /**
+   * Replace the modifier input geometry with the one from the previous evaluation when it did
+   * not change, so that the nodes depending on it can be found in the cache. The contents are
+   * not compared, that would mean reading the entire mesh on every evaluation.
+   * Must be called after #begin_evaluation.
+   */
+  GeometrySet stabilize_input_geometry(GeometrySet geometry_set, InputGeometryState state);
+
+  void begin_evaluation();
+  /**
+   * Drop the entries that were not used in this evaluation, then evict the least recently used
+   * entries of all caches until the shared memory budget is met.
+   */
+  void end_evaluation();
+
+  /**
+   * Returns true when the node can be cached with these input values, which is the case when all
+   * of the geometry inputs are stable.
+   */
+  bool inputs_are_cacheable(Span<GPointer> inputs);
+
+  /**
+   * Look for outputs that have been computed with the same inputs before. When found, the output
+   * values are passed to the callback and true is returned.
+   */
+  bool lookup(StringRef node_key,
+              Span<GPointer> inputs,
+              FunctionRef<void(StringRef identifier, GPointer value)> output_fn);
+
+  /**
+   * Store the inputs and outputs of a node that has just been executed. Output geometries are
+   * made to own their data, so that they can be shared with the cache.
+   */
+  void add(StringRef node_key,
+           Span<GPointer> inputs,
+           Span<std::pair<StringRef, GMutablePointer>> outputs);
+
+  void clear();
+
+  NodeOutputCacheStats stats() const;
+
+ private:
+  void remove_entry(StringRef node_key);
+  void update_stable_components_and_memory_usage();
+  bool find_least_recently_used(const std::string **r_key, int64_t *r_last_used) const;
+  static void enforce_memory_budget();
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("NodeOutputCache")
+};
+
+}  // namespace blender::modifiers::geometry_nodes
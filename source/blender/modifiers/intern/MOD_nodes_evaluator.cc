@@ -14,7 +14,18 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <mutex>
+
 #include "MOD_nodes_evaluator.hh"
+#include "MOD_nodes_cache.hh"
+
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_hash.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_resource_scope.hh"
+#include "BLI_set.hh"
+#include "BLI_stack.hh"
+#include "BLI_task.h"
 
 #include "NOD_geometry_exec.hh"
 #include "NOD_type_conversions.hh"
@@ -31,11 +42,18 @@ using fn::GValueMap;
 using nodes::GeoNodeExecParams;
 using namespace fn::multi_function_types;
 
+class GeometryNodesEvaluator;
+struct NodeState;
+
 class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
  public:
   LinearAllocator<> *allocator;
   GValueMap<StringRef> *input_values;
   GValueMap<StringRef> *output_values;
+  GeometryNodesEvaluator *evaluator;
+  NodeState *node_state;
+  /** True when the node asked for an input that is not available yet. */
+  bool is_waiting_for_input = false;
 
   bool can_get_input(StringRef identifier) const override
   {
@@ -79,17 +97,130 @@ class NodeParamsProvider : public nodes::GeoNodeExecParamsProvider {
   {
     void *buffer = this->allocator->allocate(type.size(), type.alignment());
     GMutablePointer ptr{&type, buffer};
-    this->output_values->add_new_direct(identifier, ptr);
+    /* Copy the identifier, because the output map can outlive the string passed in by the node
+     * when the node is executed more than once. */
+    this->output_values->add_new_direct(this->allocator->copy_string(identifier), ptr);
     return ptr;
   }
+
+  bool lazy_require_input(StringRef identifier) override;
+};
+
+/**
+ * Evaluation state of a node that may have to be executed to compute the group outputs. Apart
+ * from the data computed in the preprocessing step, all members are protected by the mutex of the
+ * evaluator.
+ */
+struct NodeState {
+  DNode node;
+  /**
+   * When true, the node requests its inputs itself using #GeoNodeExecParams::lazy_require_input.
+   * Otherwise, all inputs are computed before the node is executed.
+   */
+  bool supports_laziness = false;
+  /**
+   * The outputs of the node only depend on its inputs and settings, so they can be reused from the
+   * output cache of the modifier. Empty when the node cannot be cached.
+   */
+  std::string cache_key;
+  /** Nodes that compute the values of every input socket. Computed during preprocessing. */
+  Map<DInputSocket, Vector<NodeState *>> origin_nodes_by_input;
+
+  /** An output of this node is used, so the node has to be executed. */
+  bool is_required = false;
+  /** The node has been pushed to the task pool or is running right now. */
+  bool is_scheduled = false;
+  /** All outputs have been computed and forwarded to the linked sockets. */
+  bool has_finished = false;
+  /** Inputs whose values have been requested. */
+  Set<DInputSocket> requested_inputs;
+  /** Requested inputs that have been loaded into #input_values already. */
+  Set<DInputSocket> loaded_inputs;
+  /** Number of nodes that have to finish before all requested inputs are available. */
+  int missing_dependencies = 0;
+  /** Nodes that wait for this node to finish. */
+  Vector<NodeState *> waiting_nodes;
+  /**
+   * Inputs and outputs of the node. They are kept when a lazy node is executed more than once.
+   * Values are only added with #GValueMap::add_new_direct, so the allocator of the maps is unused
+   * and it is fine to access them from different threads.
+   */
+  std::unique_ptr<GValueMap<StringRef>> input_values;
+  std::unique_ptr<GValueMap<StringRef>> output_values;
 };
 
+/**
+ * Nodes can be cached when their outputs only depend on the input values and the node settings.
+ * Nodes that reference other data-blocks are skipped, because those can change without the
+ * pointer changing. Only nodes that output a geometry are cached, all other nodes are cheap.
+ */
+static bool node_is_cacheable(const DNode node)
+{
+  const bNodeType &node_type = *node->bnode()->typeinfo;
+  if (node_type.geometry_node_execute == nullptr ||
+      node_type.geometry_node_execute_supports_laziness) {
+    return false;
+  }
+  bool has_inputs = false;
+  for (const InputSocketRef *socket : node->inputs()) {
+    if (socket->is_available()) {
+      if (ELEM(socket->typeinfo()->type,
+               SOCK_OBJECT,
+               SOCK_COLLECTION,
+               SOCK_TEXTURE,
+               SOCK_MATERIAL)) {
+        return false;
+      }
+      has_inputs = true;
+    }
+  }
+  if (!has_inputs) {
+    return false;
+  }
+  for (const OutputSocketRef *socket : node->outputs()) {
+    if (socket->is_available() && socket->typeinfo()->type == SOCK_GEOMETRY) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Build a key that identifies the node in the same modifier across evaluations. It contains the
+ * names of the node and its parent group nodes, and a hash of the node settings.
+ */
+static std::string node_cache_key(const DNode node)
+{
+  const bNode &bnode = *node->bnode();
+  std::string key = bnode.name;
+  for (const DTreeContext *context = node.context(); !context->is_root();
+       context = context->parent_context()) {
+    key = context->parent_node()->name() + "/" + key;
+  }
+
+  uint64_t settings_hash = get_default_hash_2(get_default_hash_2(bnode.custom1, bnode.custom2),
+                                              get_default_hash_2(bnode.custom3, bnode.custom4));
+  if (bnode.storage != nullptr) {
+    /* Node storage is allocated with the guarded allocator, which knows its size. */
+    settings_hash = settings_hash * 33 ^
+                    BLI_hash_mm2((const uchar *)bnode.storage, MEM_allocN_len(bnode.storage), 0);
+  }
+  return key + "|" + std::to_string(settings_hash);
+}
+
 class GeometryNodesEvaluator {
  public:
   using LogSocketValueFn = std::function<void(DSocket, Span<GPointer>)>;
 
  private:
-  blender::LinearAllocator<> &allocator_;
+  blender::LinearAllocator<> &main_allocator_;
+  /**
+   * Linear allocators are not thread-safe, so every thread that executes nodes gets its own. The
+   * final results are relocated into the main allocator once evaluation is done.
+   */
+  EnumerableThreadSpecific<LinearAllocator<>> local_allocators_;
+  /** Protects #value_by_input_ and the scheduling state of all nodes. */
+  std::mutex mutex_;
   Map<std::pair<DInputSocket, DOutputSocket>, GMutablePointer> value_by_input_;
   Vector<DInputSocket> group_outputs_;
   blender::nodes::MultiFunctionByNode &mf_by_node_;
@@ -98,19 +229,35 @@ class GeometryNodesEvaluator {
   const ModifierData *modifier_;
   Depsgraph *depsgraph_;
   LogSocketValueFn log_socket_value_fn_;
+  bool use_multi_threading_;
+  NodeOutputCache *output_cache_;
+
+  /** Output sockets whose values are passed in from outside, i.e. the group inputs. */
+  Set<DOutputSocket> provided_outputs_;
+  /** States of all nodes that might have to be executed. They are owned by #scope_. */
+  ResourceScope scope_;
+  Map<DNode, NodeState *> node_states_;
+  TaskPool *task_pool_ = nullptr;
+  /** Scheduled nodes when multi-threading is disabled. */
+  Stack<NodeState *> serial_schedule_;
+
+  friend NodeParamsProvider;
 
  public:
   GeometryNodesEvaluator(GeometryNodesEvaluationParams &params)
-      : allocator_(params.allocator),
+      : main_allocator_(params.allocator),
         group_outputs_(std::move(params.output_sockets)),
         mf_by_node_(*params.mf_by_node),
         conversions_(blender::nodes::get_implicit_type_conversions()),
         self_object_(params.self_object),
         modifier_(&params.modifier_->modifier),
         depsgraph_(params.depsgraph),
-        log_socket_value_fn_(std::move(params.log_socket_value_fn))
+        log_socket_value_fn_(std::move(params.log_socket_value_fn)),
+        use_multi_threading_(params.use_multi_threading),
+        output_cache_(params.output_cache)
   {
     for (auto item : params.input_values.items()) {
+      provided_outputs_.add_new(item.key);
       this->log_socket_value(item.key, item.value);
       this->forward_to_inputs(item.key, item.value);
     }
@@ -118,11 +265,40 @@ class GeometryNodesEvaluator {
 
   Vector<GMutablePointer> execute()
   {
+    /* Find all nodes that might have to be executed before evaluation starts. */
+    Vector<NodeState *> output_node_states;
+    for (const DInputSocket &group_output : group_outputs_) {
+      output_node_states.extend_non_duplicates(this->add_origin_node_states(group_output));
+    }
+
+    if (use_multi_threading_) {
+      task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
+    }
+    {
+      std::lock_guard lock{mutex_};
+      for (NodeState *node_state : output_node_states) {
+        this->require_node(*node_state);
+      }
+    }
+    if (use_multi_threading_) {
+      BLI_task_pool_work_and_wait(task_pool_);
+      BLI_task_pool_free(task_pool_);
+      task_pool_ = nullptr;
+    }
+    else {
+      /* Execute the nodes one after another on this thread. This gives reproducible results and
+       * timings, which is useful when debugging and when comparing against the multi-threaded
+       * evaluation. */
+      while (!serial_schedule_.is_empty()) {
+        this->run_node(*serial_schedule_.pop());
+      }
+    }
+
     Vector<GMutablePointer> results;
     for (const DInputSocket &group_output : group_outputs_) {
       Vector<GMutablePointer> result = this->get_input_values(group_output);
       this->log_socket_value(group_output, result);
-      results.append(result[0]);
+      results.append(this->relocate_to_main_allocator(result[0]));
     }
     for (GMutablePointer value : value_by_input_.values()) {
       value.destruct();
@@ -131,6 +307,327 @@ class GeometryNodesEvaluator {
   }
 
  private:
+  /**
+   * Create the states of the nodes that compute the value of the given input socket and of all
+   * the nodes they depend on. This is only done before evaluation starts, so it is not
+   * thread-safe.
+   */
+  Vector<NodeState *> add_origin_node_states(const DInputSocket socket)
+  {
+    Vector<NodeState *> origin_states;
+    socket.foreach_origin_socket([&](const DSocket origin) {
+      if (origin->is_input()) {
+        /* The value of unlinked inputs is read from the socket directly. */
+        return;
+      }
+      const DOutputSocket origin_output{origin};
+      if (provided_outputs_.contains(origin_output)) {
+        return;
+      }
+      if (!origin_output->is_available()) {
+        /* The value of unavailable outputs does not depend on anything. Use a default value right
+         * away, but only once even when the output is linked to multiple sockets. */
+        if (provided_outputs_.add(origin_output)) {
+          const CPPType &type = *blender::nodes::socket_cpp_type_get(*origin_output->typeinfo());
+          void *buffer = main_allocator_.allocate(type.size(), type.alignment());
+          type.copy_to_uninitialized(type.default_value(), buffer);
+          this->forward_to_inputs(origin_output, {type, buffer});
+        }
+        return;
+      }
+      origin_states.append_non_duplicates(&this->ensure_node_state(origin_output.node()));
+    });
+    return origin_states;
+  }
+
+  NodeState &ensure_node_state(const DNode node)
+  {
+    NodeState *existing_state = node_states_.lookup_default(node, nullptr);
+    if (existing_state != nullptr) {
+      return *existing_state;
+    }
+    NodeState &node_state = scope_.construct<NodeState>(__func__);
+    node_state.node = node;
+    node_state.supports_laziness =
+        node->bnode()->typeinfo->geometry_node_execute_supports_laziness;
+    if (output_cache_ != nullptr && node_is_cacheable(node)) {
+      node_state.cache_key = node_cache_key(node);
+    }
+    node_state.input_values = std::make_unique<GValueMap<StringRef>>(main_allocator_);
+    node_state.output_values = std::make_unique<GValueMap<StringRef>>(main_allocator_);
+    node_states_.add_new(node, &node_state);
+
+    for (const InputSocketRef *input_socket : node->inputs()) {
+      if (input_socket->is_available()) {
+        const DInputSocket dsocket{node.context(), input_socket};
+        node_state.origin_nodes_by_input.add_new(dsocket, this->add_origin_node_states(dsocket));
+      }
+    }
+    return node_state;
+  }
+
+  /** Mark the node as required, so that it is executed once its inputs are available. Expects the
+   * mutex to be locked. */
+  void require_node(NodeState &node_state)
+  {
+    if (node_state.is_required) {
+      return;
+    }
+    node_state.is_required = true;
+    if (!node_state.supports_laziness) {
+      for (const DInputSocket &socket : node_state.origin_nodes_by_input.keys()) {
+        this->require_input(node_state, socket);
+      }
+    }
+    this->schedule_node_if_ready(node_state);
+  }
+
+  /** Make sure that the value of the input socket will be computed. Expects the mutex to be
+   * locked. */
+  void require_input(NodeState &node_state, const DInputSocket socket)
+  {
+    if (!node_state.requested_inputs.add(socket)) {
+      return;
+    }
+    for (NodeState *origin_state : node_state.origin_nodes_by_input.lookup(socket)) {
+      if (!origin_state->has_finished) {
+        origin_state->waiting_nodes.append(&node_state);
+        node_state.missing_dependencies++;
+        this->require_node(*origin_state);
+      }
+    }
+  }
+
+  /** Expects the mutex to be locked. */
+  void schedule_node_if_ready(NodeState &node_state)
+  {
+    if (!node_state.is_required || node_state.is_scheduled || node_state.has_finished) {
+      return;
+    }
+    if (node_state.missing_dependencies > 0) {
+      return;
+    }
+    node_state.is_scheduled = true;
+    if (use_multi_threading_) {
+      BLI_task_pool_push(task_pool_, run_node_from_task_pool, &node_state, false, nullptr);
+    }
+    else {
+      serial_schedule_.push(&node_state);
+    }
+  }
+
+  static void run_node_from_task_pool(TaskPool *__restrict pool, void *task_data)
+  {
+    GeometryNodesEvaluator &evaluator = *(GeometryNodesEvaluator *)BLI_task_pool_user_data(pool);
+    NodeState &node_state = *(NodeState *)task_data;
+    evaluator.run_node(node_state);
+  }
+
+  void run_node(NodeState &node_state)
+  {
+    const DNode node = node_state.node;
+    LinearAllocator<> &allocator = this->local_allocator();
+
+    Vector<DInputSocket> inputs_to_load;
+    {
+      std::lock_guard lock{mutex_};
+      for (const DInputSocket &socket : node_state.requested_inputs) {
+        if (node_state.loaded_inputs.add(socket)) {
+          inputs_to_load.append(socket);
+        }
+      }
+    }
+
+    /* All requested inputs are available now, move them into the inputs of the node. */
+    for (const DInputSocket &socket : inputs_to_load) {
+      Vector<GMutablePointer> values = this->get_input_values(socket);
+      this->log_socket_value(socket, values);
+      for (int i = 0; i < values.size(); ++i) {
+        /* Values from Multi Input Sockets are stored in input map with the format
+         * <identifier>[<index>]. */
+        blender::StringRefNull key = allocator.copy_string(
+            socket->identifier() + (i > 0 ? ("[" + std::to_string(i)) + "]" : ""));
+        node_state.input_values->add_new_direct(key, std::move(values[i]));
+      }
+    }
+
+    /* Execute the node. */
+    NodeParamsProvider params_provider;
+    params_provider.dnode = node;
+    params_provider.self_object = self_object_;
+    params_provider.depsgraph = depsgraph_;
+    params_provider.allocator = &allocator;
+    params_provider.input_values = node_state.input_values.get();
+    params_provider.output_values = node_state.output_values.get();
+    params_provider.modifier = modifier_;
+    params_provider.evaluator = this;
+    params_provider.node_state = &node_state;
+    if (node_state.cache_key.empty()) {
+      this->execute_node(node, params_provider);
+    }
+    else {
+      this->execute_node_with_cache(node_state, params_provider);
+    }
+
+    if (!this->all_outputs_are_computed(node_state)) {
+      if (params_provider.is_waiting_for_input) {
+        /* The node will be executed again once the requested inputs are available. */
+        std::lock_guard lock{mutex_};
+        node_state.is_scheduled = false;
+        this->schedule_node_if_ready(node_state);
+        return;
+      }
+      /* The node does not request more inputs, so it cannot compute the remaining outputs. */
+      this->set_missing_outputs_to_default(node_state, allocator);
+    }
+
+    /* Inputs that have not been used are not needed anymore. */
+    node_state.input_values.reset();
+
+    /* Forward computed outputs to linked input sockets. */
+    for (const OutputSocketRef *output_socket : node->outputs()) {
+      if (output_socket->is_available()) {
+        const DOutputSocket dsocket{node.context(), output_socket};
+        GMutablePointer value = node_state.output_values->extract(output_socket->identifier());
+        this->log_socket_value(dsocket, value);
+        this->forward_to_inputs(dsocket, value);
+      }
+    }
+
+    /* Notify the nodes that were waiting for this node. */
+    std::lock_guard lock{mutex_};
+    node_state.has_finished = true;
+    node_state.is_scheduled = false;
+    for (NodeState *waiting_state : node_state.waiting_nodes) {
+      waiting_state->missing_dependencies--;
+      this->schedule_node_if_ready(*waiting_state);
+    }
+    node_state.waiting_nodes.clear_and_make_inline();
+  }
+
+  void execute_node_with_cache(NodeState &node_state, NodeParamsProvider &params_provider)
+  {
+    const DNode node = node_state.node;
+    std::string key = node_state.cache_key;
+
+    /* Gather the inputs in a fixed order. The number of values of every socket is part of the key,
+     * so that the values of different multi-input sockets cannot be confused. */
+    Vector<GPointer> inputs;
+    for (const InputSocketRef *input_socket : node->inputs()) {
+      if (!input_socket->is_available()) {
+        continue;
+      }
+      int values_num = 0;
+      while (true) {
+        std::string identifier = input_socket->identifier();
+        if (values_num > 0) {
+          identifier += "[" + std::to_string(values_num) + "]";
+        }
+        if (!params_provider.input_values->contains(identifier)) {
+          break;
+        }
+        inputs.append(params_provider.input_values->lookup(identifier));
+        values_num++;
+      }
+      key += "|" + std::to_string(values_num);
+    }
+
+    if (!output_cache_->inputs_are_cacheable(inputs)) {
+      this->execute_node(node, params_provider);
+      return;
+    }
+    const bool found = output_cache_->lookup(
+        key, inputs, [&](const StringRef identifier, const GPointer value) {
+          GMutablePointer output = params_provider.alloc_output_value(identifier, *value.type());
+          value.type()->copy_to_uninitialized(value.get(), output.get());
+        });
+    if (found) {
+      return;
+    }
+
+    /* The node may consume its inputs, so keep copies to store in the cache. This does not copy
+     * geometry data, because the geometries are shared with the cache already. */
+    LinearAllocator<> &allocator = *params_provider.allocator;
+    Vector<GMutablePointer> input_copies;
+    for (const GPointer &input : inputs) {
+      const CPPType &type = *input.type();
+      void *buffer = allocator.allocate(type.size(), type.alignment());
+      type.copy_to_uninitialized(input.get(), buffer);
+      input_copies.append({type, buffer});
+    }
+
+    this->execute_node(node, params_provider);
+
+    if (this->all_outputs_are_computed(node_state)) {
+      Vector<std::pair<StringRef, GMutablePointer>> outputs;
+      for (const OutputSocketRef *output_socket : node->outputs()) {
+        if (output_socket->is_available()) {
+          const StringRef identifier = output_socket->identifier();
+          GMutablePointer value = node_state.output_values->extract(identifier);
+          node_state.output_values->add_new_direct(identifier, value);
+          outputs.append({identifier, value});
+        }
+      }
+      output_cache_->add(key, input_copies.as_span().cast<GPointer>(), outputs);
+    }
+    for (GMutablePointer value : input_copies) {
+      value.destruct();
+    }
+  }
+
+  /** Called by lazy nodes that need the value of an input that is not loaded yet. */
+  void require_input_during_execution(NodeState &node_state, const StringRef identifier)
+  {
+    const DNode node = node_state.node;
+    for (const InputSocketRef *input_socket : node->inputs()) {
+      if (input_socket->is_available() && input_socket->identifier() == identifier) {
+        std::lock_guard lock{mutex_};
+        this->require_input(node_state, {node.context(), input_socket});
+        return;
+      }
+    }
+    BLI_assert_unreachable();
+  }
+
+  bool all_outputs_are_computed(const NodeState &node_state)
+  {
+    for (const OutputSocketRef *output_socket : node_state.node->outputs()) {
+      if (output_socket->is_available()) {
+        if (!node_state.output_values->contains(output_socket->identifier())) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void set_missing_outputs_to_default(NodeState &node_state, LinearAllocator<> &allocator)
+  {
+    for (const OutputSocketRef *output_socket : node_state.node->outputs()) {
+      if (output_socket->is_available()) {
+        if (!node_state.output_values->contains(output_socket->identifier())) {
+          const CPPType &type = *blender::nodes::socket_cpp_type_get(*output_socket->typeinfo());
+          void *buffer = allocator.allocate(type.size(), type.alignment());
+          type.copy_to_uninitialized(type.default_value(), buffer);
+          node_state.output_values->add_new_direct(output_socket->identifier(), {type, buffer});
+        }
+      }
+    }
+  }
+
+  LinearAllocator<> &local_allocator()
+  {
+    return local_allocators_.local();
+  }
+
+  GMutablePointer relocate_to_main_allocator(GMutablePointer value)
+  {
+    const CPPType &type = *value.type();
+    void *buffer = main_allocator_.allocate(type.size(), type.alignment());
+    type.relocate_to_uninitialized(value.get(), buffer);
+    return {type, buffer};
+  }
+
   Vector<GMutablePointer> get_input_values(const DInputSocket socket_to_compute)
   {
     Vector<DSocket> from_sockets;
@@ -167,7 +664,7 @@ class GeometryNodesEvaluator {
          * can happen when a node linked to a multi-input-socket is muted. */
         GMutablePointer value = values[first_occurence];
         const CPPType *type = value.type();
-        void *copy_buffer = allocator_.allocate(type->size(), type->alignment());
+        void *copy_buffer = this->local_allocator().allocate(type->size(), type->alignment());
         type->copy_to_uninitialized(value.get(), copy_buffer);
         values.append({type, copy_buffer});
       }
@@ -179,17 +676,12 @@ class GeometryNodesEvaluator {
                                                const DSocket from_socket)
   {
     if (from_socket->is_output()) {
+      /* The node that computes the value has finished already, because the input has only been
+       * loaded after all of its dependencies are available. */
       const DOutputSocket from_output_socket{from_socket};
       const std::pair<DInputSocket, DOutputSocket> key = std::make_pair(socket_to_compute,
                                                                         from_output_socket);
-      std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
-      if (value.has_value()) {
-        /* This input has been computed before, return it directly. */
-        return {*value};
-      }
-
-      /* Compute the socket now. */
-      this->compute_output_and_forward(from_output_socket);
+      std::lock_guard lock{mutex_};
       return {value_by_input_.pop(key)};
     }
 
@@ -199,59 +691,6 @@ class GeometryNodesEvaluator {
     return {get_unlinked_input_value(from_input_socket, type)};
   }
 
-  void compute_output_and_forward(const DOutputSocket socket_to_compute)
-  {
-    const DNode node{socket_to_compute.context(), &socket_to_compute->node()};
-
-    if (!socket_to_compute->is_available()) {
-      /* If the output is not available, use a default value. */
-      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute->typeinfo());
-      void *buffer = allocator_.allocate(type.size(), type.alignment());
-      type.copy_to_uninitialized(type.default_value(), buffer);
-      this->forward_to_inputs(socket_to_compute, {type, buffer});
-      return;
-    }
-
-    /* Prepare inputs required to execute the node. */
-    GValueMap<StringRef> node_inputs_map{allocator_};
-    for (const InputSocketRef *input_socket : node->inputs()) {
-      if (input_socket->is_available()) {
-        DInputSocket dsocket{node.context(), input_socket};
-        Vector<GMutablePointer> values = this->get_input_values(dsocket);
-        this->log_socket_value(dsocket, values);
-        for (int i = 0; i < values.size(); ++i) {
-          /* Values from Multi Input Sockets are stored in input map with the format
-           * <identifier>[<index>]. */
-          blender::StringRefNull key = allocator_.copy_string(
-              input_socket->identifier() + (i > 0 ? ("[" + std::to_string(i)) + "]" : ""));
-          node_inputs_map.add_new_direct(key, std::move(values[i]));
-        }
-      }
-    }
-
-    /* Execute the node. */
-    GValueMap<StringRef> node_outputs_map{allocator_};
-    NodeParamsProvider params_provider;
-    params_provider.dnode = node;
-    params_provider.self_object = self_object_;
-    params_provider.depsgraph = depsgraph_;
-    params_provider.allocator = &allocator_;
-    params_provider.input_values = &node_inputs_map;
-    params_provider.output_values = &node_outputs_map;
-    params_provider.modifier = modifier_;
-    this->execute_node(node, params_provider);
-
-    /* Forward computed outputs to linked input sockets. */
-    for (const OutputSocketRef *output_socket : node->outputs()) {
-      if (output_socket->is_available()) {
-        const DOutputSocket dsocket{node.context(), output_socket};
-        GMutablePointer value = node_outputs_map.extract(output_socket->identifier());
-        this->log_socket_value(dsocket, value);
-        this->forward_to_inputs(dsocket, value);
-      }
-    }
-  }
-
   void log_socket_value(const DSocket socket, Span<GPointer> values)
   {
     if (log_socket_value_fn_) {
@@ -326,8 +765,8 @@ class GeometryNodesEvaluator {
     for (const OutputSocketRef *socket : node->outputs()) {
       if (socket->is_available()) {
         const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
-        params_provider.output_values->add_new_by_copy(socket->identifier(),
-                                                       {type, type.default_value()});
+        GMutablePointer value = params_provider.alloc_output_value(socket->identifier(), type);
+        type.copy_to_uninitialized(type.default_value(), value.get());
       }
     }
   }
@@ -355,7 +794,7 @@ class GeometryNodesEvaluator {
         to_sockets_same_type.append(to_socket);
       }
       else {
-        void *buffer = allocator_.allocate(to_type.size(), to_type.alignment());
+        void *buffer = this->local_allocator().allocate(to_type.size(), to_type.alignment());
         if (conversions_.is_convertible(from_type, to_type)) {
           conversions_.convert_to_uninitialized(
               from_type, to_type, value_to_forward.get(), buffer);
@@ -388,7 +827,7 @@ class GeometryNodesEvaluator {
       add_value_to_input_socket(first_key, value_to_forward);
       for (const DInputSocket &to_socket : other_to_sockets) {
         const std::pair<DInputSocket, DOutputSocket> key = std::make_pair(to_socket, from_socket);
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = this->local_allocator().allocate(type.size(), type.alignment());
         type.copy_to_uninitialized(value_to_forward.get(), buffer);
         add_value_to_input_socket(key, GMutablePointer{type, buffer});
       }
@@ -398,6 +837,7 @@ class GeometryNodesEvaluator {
   void add_value_to_input_socket(const std::pair<DInputSocket, DOutputSocket> key,
                                  GMutablePointer value)
   {
+    std::lock_guard lock{mutex_};
     value_by_input_.add_new(key, value);
   }
 
@@ -406,25 +846,36 @@ class GeometryNodesEvaluator {
   {
     bNodeSocket *bsocket = socket->bsocket();
     const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
-    void *buffer = allocator_.allocate(type.size(), type.alignment());
+    void *buffer = this->local_allocator().allocate(type.size(), type.alignment());
     blender::nodes::socket_cpp_value_get(*bsocket, buffer);
 
     if (type == required_type) {
       return {type, buffer};
     }
     if (conversions_.is_convertible(type, required_type)) {
-      void *converted_buffer = allocator_.allocate(required_type.size(),
-                                                   required_type.alignment());
+      void *converted_buffer = this->local_allocator().allocate(required_type.size(),
+                                                                required_type.alignment());
       conversions_.convert_to_uninitialized(type, required_type, buffer, converted_buffer);
       type.destruct(buffer);
       return {required_type, converted_buffer};
     }
-    void *default_buffer = allocator_.allocate(required_type.size(), required_type.alignment());
+    void *default_buffer = this->local_allocator().allocate(required_type.size(),
+                                                            required_type.alignment());
     required_type.copy_to_uninitialized(required_type.default_value(), default_buffer);
     return {required_type, default_buffer};
   }
 };
 
+bool NodeParamsProvider::lazy_require_input(StringRef identifier)
+{
+  if (input_values->contains(identifier)) {
+    return false;
+  }
+  evaluator->require_input_during_execution(*node_state, identifier);
+  is_waiting_for_input = true;
+  return true;
+}
+
 void evaluate_geometry_nodes(GeometryNodesEvaluationParams &params)
 {
   GeometryNodesEvaluator evaluator{params};
@@ -31,6 +31,8 @@ using namespace nodes::derived_node_tree_types;
 using fn::GMutablePointer;
 using fn::GPointer;
 
+class NodeOutputCache;
+
 using LogSocketValueFn = std::function<void(DSocket, Span<GPointer>)>;
 
 struct GeometryNodesEvaluationParams {
@@ -43,6 +45,13 @@ struct GeometryNodesEvaluationParams {
   Depsgraph *depsgraph;
   Object *self_object;
   LogSocketValueFn log_socket_value_fn;
+  /**
+   * Execute independent nodes in parallel. When disabled, all nodes are executed on the calling
+   * thread in a fixed order.
+   */
+  bool use_multi_threading = true;
+  /** Reuse node outputs from previous evaluations when not null. */
+  NodeOutputCache *output_cache = nullptr;
 
   Vector<GMutablePointer> r_output_values;
 };
@@ -97,6 +97,12 @@ class GeoNodeExecParamsProvider {
    * initialized by the caller. The identifier and type are expected to be correct.
    */
   virtual GMutablePointer alloc_output_value(StringRef identifier, const CPPType &type) = 0;
+
+  /**
+   * Request the value of an input that is not available yet. Returns true when the node has to
+   * wait for the value, in which case it will be executed again once it has been computed.
+   */
+  virtual bool lazy_require_input(StringRef identifier) = 0;
 };
 
 class GeoNodeExecParams {
@@ -178,6 +184,20 @@ class GeoNodeExecParams {
     new (gvalue.get()) StoredT(std::forward<T>(value));
   }
 
+  /**
+   * Returns true when the value of the given input has not been computed yet. The node should then
+   * return without setting its outputs; it is executed again once the input is available. Inputs
+   * that are never required are not computed at all.
+   *
+   * This can only be used by nodes that set `geometry_node_execute_supports_laziness`, for all
+   * other nodes every input is computed before the node is executed.
+   */
+  bool lazy_require_input(StringRef identifier)
+  {
+    BLI_assert(this->node().typeinfo->geometry_node_execute_supports_laziness);
+    return provider_->lazy_require_input(identifier);
+  }
+
   /**
    * Get the node that is currently being executed.
    */
@@ -176,10 +176,14 @@ static void do_math_operation(const VArray<float> &span_a,
 {
   bool success = try_dispatch_float_math_fl_fl_to_fl(
       operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        parallel_for(IndexRange(span_result.size()), 1024, [&](IndexRange range) {
-          for (const int i : range) {
-            span_result[i] = math_function(span_a[i], span_b[i]);
-          }
+        /* Devirtualize the inputs, so that the compiler can optimize the loop for the common
+         * cases of attributes and single values. */
+        devirtualize_varray2(span_a, span_b, [&](const auto &span_a, const auto &span_b) {
+          parallel_for(IndexRange(span_result.size()), 1024, [&](IndexRange range) {
+            for (const int i : range) {
+              span_result[i] = math_function(span_a[i], span_b[i]);
+            }
+          });
         });
       });
   BLI_assert(success);
@@ -192,10 +196,12 @@ static void do_math_operation(const VArray<float> &span_input,
 {
   bool success = try_dispatch_float_math_fl_to_fl(
       operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        parallel_for(IndexRange(span_result.size()), 1024, [&](IndexRange range) {
-          for (const int i : range) {
-            span_result[i] = math_function(span_input[i]);
-          }
+        devirtualize_varray(span_input, [&](const auto &span_input) {
+          parallel_for(IndexRange(span_result.size()), 1024, [&](IndexRange range) {
+            for (const int i : range) {
+              span_result[i] = math_function(span_input[i]);
+            }
+          });
         });
       });
   BLI_assert(success);
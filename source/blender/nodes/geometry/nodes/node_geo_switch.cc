@@ -76,12 +76,12 @@ void output_input(GeoNodeExecParams &params,
                   const StringRef input_suffix,
                   const StringRef output_identifier)
 {
-  if (input) {
-    params.set_output(output_identifier, params.extract_input<T>("B" + input_suffix));
-  }
-  else {
-    params.set_output(output_identifier, params.extract_input<T>("A" + input_suffix));
+  /* Only the input that is passed through is computed. */
+  const std::string input_identifier = (input ? "B" : "A") + input_suffix;
+  if (params.lazy_require_input(input_identifier)) {
+    return;
   }
+  params.set_output(output_identifier, params.extract_input<T>(input_identifier));
 }
 
 static void geo_node_switch_update(bNodeTree *UNUSED(ntree), bNode *node)
@@ -102,7 +102,10 @@ static void geo_node_switch_update(bNodeTree *UNUSED(ntree), bNode *node)
 static void geo_node_switch_exec(GeoNodeExecParams params)
 {
   const NodeSwitch &storage = *(const NodeSwitch *)params.node().storage;
-  const bool input = params.extract_input<bool>("Switch");
+  if (params.lazy_require_input("Switch")) {
+    return;
+  }
+  const bool input = params.get_input<bool>("Switch");
   switch ((eNodeSocketDatatype)storage.input_type) {
     case SOCK_FLOAT: {
       output_input<float>(params, input, "", "Output");
@@ -158,6 +161,7 @@ void register_node_type_geo_switch()
   node_type_update(&ntype, blender::nodes::geo_node_switch_update);
   node_type_storage(&ntype, "NodeSwitch", node_free_standard_storage, node_copy_standard_storage);
   ntype.geometry_node_execute = blender::nodes::geo_node_switch_exec;
+  ntype.geometry_node_execute_supports_laziness = true;
   ntype.draw_buttons = geo_node_switch_layout;
   nodeRegisterType(&ntype);
 }
@@ -34,6 +34,7 @@ struct Sequence;
 
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Prefetch workers use consecutive IDs starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
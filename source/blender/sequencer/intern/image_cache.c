@@ -40,8 +40,11 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -57,6 +60,10 @@
 #include "prefetch.h"
 #include "strip_time.h"
 
+#ifdef WITH_ZSTD
+#  include <zstd.h>
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -89,7 +96,13 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data is encoded per image, see eDiskCacheCodec:
+ *  - Without compression, data is stored as is and read through memory mapped file.
+ *  - With compression, data is split into chunks that are compressed with Zstd independently,
+ *    so they can be compressed and decoded in parallel. Float data is byte-shuffled first.
+ *    Zlib is used when Blender is built without Zstd.
+ * Only reading and writing of files is done with the disk cache locked, so images can be
+ * compressed and decoded by multiple threads at the same time.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
@@ -102,11 +115,30 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
+/* Size of independently compressed chunks of image data. */
+#define DCACHE_CHUNK_SIZE (1 << 20)
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+typedef enum eDiskCacheCodec {
+  /* Image data is stored as is. */
+  DCACHE_CODEC_NONE = 0,
+  /* Image data is single zlib stream. */
+  DCACHE_CODEC_ZLIB = 1,
+  /* Image data starts with table of compressed chunk sizes, followed by the chunks. */
+  DCACHE_CODEC_ZSTD = 2,
+} eDiskCacheCodec;
+
+/* DiskCacheHeaderEntry.flag */
+enum {
+  /* Bytes of 4-byte values are grouped by their significance, see #seq_disk_cache_shuffle. */
+  DCACHE_FLAG_SHUFFLE = (1 << 0),
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
+  unsigned char flag;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -196,6 +228,18 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static eDiskCacheCodec seq_disk_cache_codec(void)
+{
+  if (seq_disk_cache_compression_level() == 0) {
+    return DCACHE_CODEC_NONE;
+  }
+#ifdef WITH_ZSTD
+  return DCACHE_CODEC_ZSTD;
+#else
+  return DCACHE_CODEC_ZLIB;
+#endif
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -491,29 +535,289 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void *seq_disk_cache_imbuf_data(ImBuf *ibuf)
 {
   if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+    return ibuf->rect;
   }
+  return ibuf->rect_float;
+}
+
+#ifdef WITH_ZSTD
 
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+static int seq_disk_cache_num_chunks(uint64_t size_raw)
+{
+  return (int)((size_raw + DCACHE_CHUNK_SIZE - 1) / DCACHE_CHUNK_SIZE);
 }
 
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
+static size_t seq_disk_cache_chunk_size(uint64_t size_raw, int chunk)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  return (size_t)min_zz(size_raw - (uint64_t)chunk * DCACHE_CHUNK_SIZE, DCACHE_CHUNK_SIZE);
+}
+
+/* Group bytes of 4-byte values by their significance. Exponents and high mantissa bytes of
+ * neighboring floats are mostly the same, which makes shuffled data compress much better. */
+static void seq_disk_cache_shuffle(const uchar *src, uchar *dst, size_t size)
+{
+  const size_t num_values = size / 4;
+  for (size_t i = 0; i < num_values; i++) {
+    for (int byte = 0; byte < 4; byte++) {
+      dst[byte * num_values + i] = src[i * 4 + byte];
+    }
+  }
+}
+
+static void seq_disk_cache_unshuffle(const uchar *src, uchar *dst, size_t size)
+{
+  const size_t num_values = size / 4;
+  for (size_t i = 0; i < num_values; i++) {
+    for (int byte = 0; byte < 4; byte++) {
+      dst[i * 4 + byte] = src[byte * num_values + i];
+    }
+  }
+}
+
+typedef struct DiskCacheCodecData {
+  uchar *data_raw;
+  uint64_t size_raw;
+  bool shuffle;
+  int level;
+  /* Compressed chunks. */
+  uchar **chunks;
+  uint64_t *chunk_sizes;
+  bool error;
+} DiskCacheCodecData;
+
+static void seq_disk_cache_compress_chunk_cb(void *__restrict userdata,
+                                             const int chunk,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DiskCacheCodecData *data = userdata;
+  const size_t size = seq_disk_cache_chunk_size(data->size_raw, chunk);
+  const uchar *src = data->data_raw + (size_t)chunk * DCACHE_CHUNK_SIZE;
+  uchar *shuffled = NULL;
+
+  if (data->shuffle) {
+    shuffled = MEM_mallocN(size, __func__);
+    seq_disk_cache_shuffle(src, shuffled, size);
+    src = shuffled;
+  }
+
+  const size_t bound = ZSTD_compressBound(size);
+  data->chunks[chunk] = MEM_mallocN(bound, __func__);
+  const size_t compressed_size = ZSTD_compress(data->chunks[chunk], bound, src, size, data->level);
+  if (ZSTD_isError(compressed_size)) {
+    data->error = true;
+  }
+  else {
+    data->chunk_sizes[chunk] = compressed_size;
+  }
+
+  MEM_SAFE_FREE(shuffled);
+}
+
+/* Compress image data to table of compressed chunk sizes followed by the chunks.
+ * Returns NULL on failure. */
+static uchar *seq_disk_cache_encode_chunks(ImBuf *ibuf,
+                                           const DiskCacheHeaderEntry *header_entry,
+                                           size_t *r_size)
+{
+  const int num_chunks = seq_disk_cache_num_chunks(header_entry->size_raw);
+  const size_t table_size = sizeof(uint64_t) * num_chunks;
+
+  DiskCacheCodecData data = {
+      .data_raw = seq_disk_cache_imbuf_data(ibuf),
+      .size_raw = header_entry->size_raw,
+      .shuffle = (header_entry->flag & DCACHE_FLAG_SHUFFLE) != 0,
+      .level = seq_disk_cache_compression_level(),
+      .chunks = MEM_callocN(sizeof(uchar *) * num_chunks, __func__),
+      .chunk_sizes = MEM_callocN(table_size, __func__),
+      .error = false,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, num_chunks, &data, seq_disk_cache_compress_chunk_cb, &settings);
+
+  uchar *payload = NULL;
+  if (!data.error) {
+    size_t size = table_size;
+    for (int i = 0; i < num_chunks; i++) {
+      size += data.chunk_sizes[i];
+    }
+
+    payload = MEM_mallocN(size, __func__);
+    memcpy(payload, data.chunk_sizes, table_size);
+    size_t offset = table_size;
+    for (int i = 0; i < num_chunks; i++) {
+      memcpy(payload + offset, data.chunks[i], data.chunk_sizes[i]);
+      offset += data.chunk_sizes[i];
+    }
+    *r_size = size;
+  }
+
+  for (int i = 0; i < num_chunks; i++) {
+    MEM_SAFE_FREE(data.chunks[i]);
+  }
+  MEM_freeN(data.chunks);
+  MEM_freeN(data.chunk_sizes);
+
+  return payload;
+}
+
+typedef struct DiskCacheDecodeData {
+  DiskCacheCodecData codec;
+  const uchar *payload;
+  uint64_t *chunk_offsets;
+} DiskCacheDecodeData;
+
+static void seq_disk_cache_decompress_chunk_cb(void *__restrict userdata,
+                                               const int chunk,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DiskCacheDecodeData *data = userdata;
+  const size_t size = seq_disk_cache_chunk_size(data->codec.size_raw, chunk);
+  uchar *dst = data->codec.data_raw + (size_t)chunk * DCACHE_CHUNK_SIZE;
+  uchar *shuffled = NULL;
+
+  if (data->codec.shuffle) {
+    shuffled = MEM_mallocN(size, __func__);
+  }
+
+  const size_t decompressed_size = ZSTD_decompress(shuffled ? shuffled : dst,
+                                                   size,
+                                                   data->payload + data->chunk_offsets[chunk],
+                                                   data->codec.chunk_sizes[chunk]);
+  if (ZSTD_isError(decompressed_size) || decompressed_size != size) {
+    data->codec.error = true;
+  }
+  else if (shuffled) {
+    seq_disk_cache_unshuffle(shuffled, dst, size);
+  }
+
+  MEM_SAFE_FREE(shuffled);
+}
+
+/* Decode chunks of compressed image data in parallel. */
+static bool seq_disk_cache_decode_chunks(ImBuf *ibuf,
+                                         const uchar *payload,
+                                         const DiskCacheHeaderEntry *header_entry)
+{
+  const int num_chunks = seq_disk_cache_num_chunks(header_entry->size_raw);
+  const size_t table_size = sizeof(uint64_t) * num_chunks;
+
+  if (header_entry->size_compressed < table_size) {
+    return false;
+  }
+
+  DiskCacheDecodeData data = {
+      .codec =
+          {
+              .data_raw = seq_disk_cache_imbuf_data(ibuf),
+              .size_raw = header_entry->size_raw,
+              .shuffle = (header_entry->flag & DCACHE_FLAG_SHUFFLE) != 0,
+              .chunk_sizes = MEM_mallocN(table_size, __func__),
+              .error = false,
+          },
+      .payload = payload,
+      .chunk_offsets = MEM_mallocN(table_size, __func__),
+  };
+
+  memcpy(data.codec.chunk_sizes, payload, table_size);
+  uint64_t offset = table_size;
+  for (int i = 0; i < num_chunks; i++) {
+    if ((ENDIAN_ORDER == B_ENDIAN) && header_entry->encoding == 0) {
+      BLI_endian_switch_uint64(&data.codec.chunk_sizes[i]);
+    }
+    data.chunk_offsets[i] = offset;
+    offset += data.codec.chunk_sizes[i];
+  }
+
+  /* Sanity check. */
+  if (offset == header_entry->size_compressed) {
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, num_chunks, &data, seq_disk_cache_decompress_chunk_cb, &settings);
+  }
+  else {
+    data.codec.error = true;
+  }
+
+  MEM_freeN(data.codec.chunk_sizes);
+  MEM_freeN(data.chunk_offsets);
+
+  return !data.codec.error;
+}
+
+#endif /* WITH_ZSTD */
+
+static size_t seq_disk_cache_write_data(FILE *file,
+                                        const void *data,
+                                        size_t size,
+                                        DiskCacheHeaderEntry *header_entry)
+{
+  if (header_entry->codec == DCACHE_CODEC_ZLIB) {
+    return BLI_gzip_mem_to_file_at_pos((void *)data,
+                                       header_entry->size_raw,
+                                       file,
+                                       header_entry->offset,
+                                       seq_disk_cache_compression_level());
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  BLI_fseek(file, (int64_t)header_entry->offset, SEEK_SET);
+  if (fwrite(data, size, 1, file) != 1) {
+    return 0;
+  }
+  return size;
+}
+
+/* Read image data of the entry. Uncompressed and zlib data is read to the image buffer directly,
+ * Zstd data is returned in `r_payload` to be decoded after the disk cache is unlocked. */
+static bool seq_disk_cache_read_data(ImBuf *ibuf,
+                                     FILE *file,
+                                     DiskCacheHeaderEntry *header_entry,
+                                     uchar **r_payload)
+{
+  void *data_raw = seq_disk_cache_imbuf_data(ibuf);
+  *r_payload = NULL;
+
+  switch (header_entry->codec) {
+    case DCACHE_CODEC_ZLIB:
+      return BLI_ungzip_file_to_mem_at_pos(
+                 data_raw, header_entry->size_raw, file, header_entry->offset) ==
+             header_entry->size_raw;
+    case DCACHE_CODEC_NONE:
+    case DCACHE_CODEC_ZSTD: {
+#ifndef WITH_ZSTD
+      if (header_entry->codec == DCACHE_CODEC_ZSTD) {
+        return false;
+      }
+#endif
+      if (header_entry->codec == DCACHE_CODEC_NONE &&
+          header_entry->size_compressed != header_entry->size_raw) {
+        return false;
+      }
+
+      BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+      if (mmap_file == NULL) {
+        return false;
+      }
+
+      void *dst = data_raw;
+      if (header_entry->codec == DCACHE_CODEC_ZSTD) {
+        dst = *r_payload = MEM_mallocN(header_entry->size_compressed, __func__);
+      }
+      const bool read_ok = BLI_mmap_read(
+          mmap_file, dst, header_entry->offset, header_entry->size_compressed);
+      BLI_mmap_free(mmap_file);
+
+      return read_ok;
+    }
+  }
+
+  return false;
 }
 
 static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -544,7 +848,42 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+/* Fill in image description, which doesn't depend on content of cache file. */
+static void seq_disk_cache_init_header_entry(SeqCacheKey *key,
+                                             ImBuf *ibuf,
+                                             DiskCacheHeaderEntry *header_entry)
+{
+  memset(header_entry, 0, sizeof(*header_entry));
+
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    header_entry->encoding = 255;
+  }
+  else {
+    header_entry->encoding = 0;
+  }
+
+  header_entry->frameno = key->frame_index;
+  header_entry->codec = seq_disk_cache_codec();
+
+  /* Store colorspace name of ibuf. */
+  const char *colorspace_name;
+  if (ibuf->rect) {
+    header_entry->size_raw = ibuf->x * ibuf->y * ibuf->channels;
+    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
+  }
+  else {
+    header_entry->size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
+    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+    if (header_entry->codec == DCACHE_CODEC_ZSTD) {
+      header_entry->flag |= DCACHE_FLAG_SHUFFLE;
+    }
+  }
+  BLI_strncpy(
+      header_entry->colorspace_name, colorspace_name, sizeof(header_entry->colorspace_name));
+}
+
+static int seq_disk_cache_add_header_entry(const DiskCacheHeaderEntry *new_entry,
+                                           DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -569,28 +908,8 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     offset = header->entry[i - 1].offset + header->entry[i - 1].size_compressed;
   }
 
-  if (ENDIAN_ORDER == B_ENDIAN) {
-    header->entry[i].encoding = 255;
-  }
-  else {
-    header->entry[i].encoding = 0;
-  }
-
+  header->entry[i] = *new_entry;
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->frame_index;
-
-  /* Store colorspace name of ibuf. */
-  const char *colorspace_name;
-  if (ibuf->rect) {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels;
-    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
-  }
-  else {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
-    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
-  }
-  BLI_strncpy(
-      header->entry[i].colorspace_name, colorspace_name, sizeof(header->entry[i].colorspace_name));
 
   return i;
 }
@@ -606,13 +925,13 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Must be called with disk cache locked. */
+static bool seq_disk_cache_write_entry(SeqDiskCache *disk_cache,
+                                       const char *path,
+                                       const DiskCacheHeaderEntry *new_entry,
+                                       const void *data,
+                                       size_t size)
 {
-  char path[FILE_MAX];
-
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
-
   FILE *file = BLI_fopen(path, "rb+");
   if (!file) {
     file = BLI_fopen(path, "wb+");
@@ -622,20 +941,19 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
     seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
-  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
+  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, (char *)path);
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
-  /* #BLI_make_existing_file() above may create an empty file. This is fine, don't attempt reading
+  /* #BLI_make_existing_file() may create an empty file. This is fine, don't attempt reading
    * the header in that case. */
   if (cache_file->fstat.st_size != 0 && !seq_disk_cache_read_header(file, &header)) {
     fclose(file);
     seq_disk_cache_delete_file(disk_cache, cache_file);
     return false;
   }
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  int entry_index = seq_disk_cache_add_header_entry(new_entry, &header);
 
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  size_t bytes_written = seq_disk_cache_write_data(file, data, size, &header.entry[entry_index]);
 
   if (bytes_written != 0) {
     /* Last step is writing header, as image data can be overwritten,
@@ -643,15 +961,50 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
      */
     header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
+    seq_disk_cache_update_file(disk_cache, (char *)path);
     fclose(file);
 
     return true;
   }
 
+  fclose(file);
   return false;
 }
 
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  char path[FILE_MAX];
+
+  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+  BLI_make_existing_file(path);
+
+  DiskCacheHeaderEntry new_entry;
+  seq_disk_cache_init_header_entry(key, ibuf, &new_entry);
+
+  const void *data = seq_disk_cache_imbuf_data(ibuf);
+  size_t size = new_entry.size_raw;
+  uchar *payload = NULL;
+
+#ifdef WITH_ZSTD
+  /* Compress before locking, so multiple images can be compressed at the same time. */
+  if (new_entry.codec == DCACHE_CODEC_ZSTD) {
+    payload = seq_disk_cache_encode_chunks(ibuf, &new_entry, &size);
+    if (payload == NULL) {
+      return false;
+    }
+    data = payload;
+  }
+#endif
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  const bool success = seq_disk_cache_write_entry(disk_cache, path, &new_entry, data, size);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  MEM_SAFE_FREE(payload);
+
+  return success;
+}
+
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
 {
   char path[FILE_MAX];
@@ -660,13 +1013,17 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
   FILE *file = BLI_fopen(path, "rb");
   if (!file) {
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
   if (!seq_disk_cache_read_header(file, &header)) {
     fclose(file);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
   int entry_index = seq_disk_cache_get_header_entry(key, &header);
@@ -674,40 +1031,51 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   /* Item not found. */
   if (entry_index < 0) {
     fclose(file);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
+  DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
   ImBuf *ibuf;
   uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
 
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
+  if (header_entry->size_raw == size_char) {
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_rect_colorspace(ibuf, header_entry->colorspace_name);
   }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
+  else if (header_entry->size_raw == size_float) {
     ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+    IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
   }
   else {
     fclose(file);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
     return NULL;
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  uchar *payload;
+  bool read_ok = seq_disk_cache_read_data(ibuf, file, header_entry, &payload);
 
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
+  if (read_ok) {
+    BLI_file_touch(path);
+    seq_disk_cache_update_file(disk_cache, path);
+  }
+  fclose(file);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+#ifdef WITH_ZSTD
+  /* Decode after unlocking, so multiple images can be decoded at the same time. */
+  if (read_ok && header_entry->codec == DCACHE_CODEC_ZSTD) {
+    read_ok = seq_disk_cache_decode_chunks(ibuf, payload, header_entry);
+  }
+#endif
+  MEM_SAFE_FREE(payload);
+
+  if (!read_ok) {
     IMB_freeImBuf(ibuf);
     return NULL;
   }
-  BLI_file_touch(path);
-  seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
@@ -716,6 +1084,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_CHUNK_SIZE
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -1383,9 +1752,7 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
       seq_disk_cache_create(context->bmain, context->scene);
     }
 
-    BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
     ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
-    BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
 
     if (ibuf == NULL) {
       return NULL;
@@ -1465,9 +1832,7 @@ void seq_cache_put(
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
       seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
       seq_disk_cache_enforce_limits(cache->disk_cache);
     }
   }
@@ -34,6 +34,8 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_system.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -61,33 +63,57 @@
 #include "prefetch.h"
 #include "render.h"
 
+/* Maximum number of frames that are rendered concurrently. */
+#define SEQ_PREFETCH_MAX_WORKERS 8
+
+/* Frames are handed out to workers in chunks of consecutive frames. Each worker has its own movie
+ * decoders, which can only decode efficiently when frames are read in order. */
+#define SEQ_PREFETCH_CHUNK_SIZE 32
+
+struct PrefetchJob;
+
+/* Renders frames on its own thread, with its own copy of the scene. */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+  int index;
+
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* frame that is being rendered */
+  float cfra;
+  /* end of the chunk of frames assigned to this worker, exclusive */
+  float chunk_end;
+
+  /* control */
+  bool running;
+  bool waiting;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
   struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  /* Protects prefetch area, also used to suspend workers. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
+  PrefetchWorker workers[SEQ_PREFETCH_MAX_WORKERS];
+  int num_workers;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
-
-  /* prefetch area */
+  /* prefetch area, frames up to `cfra + num_frames_prefetched` are rendered or being rendered */
   float cfra;
   int num_frames_prefetched;
 
   /* control */
-  bool running;
-  bool waiting;
   bool stop;
 } PrefetchJob;
 
@@ -128,7 +154,12 @@ bool seq_prefetch_job_is_running(Scene *scene)
     return false;
   }
 
-  return pfjob->running;
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    if (pfjob->workers[i].running) {
+      return true;
+    }
+  }
+  return false;
 }
 
 static bool seq_prefetch_job_is_waiting(Scene *scene)
@@ -139,7 +170,16 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  /* Waiting when all workers, which did not finish yet, are suspended. */
+  bool waiting = false;
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    const PrefetchWorker *worker = &pfjob->workers[i];
+    if (worker->running && !worker->waiting) {
+      return false;
+    }
+    waiting |= worker->waiting;
+  }
+  return waiting;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -171,8 +211,10 @@ Sequence *seq_prefetch_get_original_sequence(Sequence *seq, Scene *scene)
 SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
+  BLI_assert(index >= 0 && index < pfjob->num_workers);
 
-  return &pfjob->context;
+  return &pfjob->workers[index].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -186,13 +228,14 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
   return seq_cache_recycle_item(pfjob->scene) == false;
 }
 
+/* Next frame to be prefetched. */
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
@@ -203,37 +246,52 @@ void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+/* Each worker has its own depsgraph, so the scene and strips can be evaluated at different frames
+ * at the same time. Must be called from the main thread, because the original scene is read. */
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
   Main *bmain = pfjob->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  worker->cfra = seq_prefetch_cfra(pfjob);
+  seq_prefetch_update_depsgraph(worker);
+
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
+/* Next frame in the chunk of the worker. Frames that the playhead already passed are skipped. */
+static float seq_prefetch_worker_next_cfra(PrefetchWorker *worker)
+{
+  return max_ff(worker->cfra, worker->pfjob->cfra) + 1;
+}
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+static bool seq_prefetch_worker_has_chunk(PrefetchWorker *worker)
+{
+  return seq_prefetch_worker_next_cfra(worker) < worker->chunk_end;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -255,6 +313,11 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
   if (cfra < pfjob->cfra) {
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched = 1;
+
+    /* Frames of chunks in flight may be handed out again. */
+    for (int i = 0; i < pfjob->num_workers; i++) {
+      pfjob->workers[i].chunk_end = pfjob->workers[i].cfra;
+    }
   }
 }
 
@@ -280,45 +343,44 @@ void SEQ_prefetch_stop(Scene *scene)
 
   pfjob->stop = true;
 
-  while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  while (seq_prefetch_job_is_running(scene)) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
-static void seq_prefetch_update_context(const SeqRenderData *context)
+static void seq_prefetch_update_context(PrefetchWorker *worker, const SeqRenderData *context)
 {
-  PrefetchJob *pfjob;
-  pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchJob *pfjob = worker->pfjob;
 
   SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+                             &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + worker->index;
 
   SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
+                             worker->depsgraph,
                              pfjob->scene,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+                             &worker->context);
+  worker->context.is_prefetch_render = false;
 
   /* Same ID as prefetch context, because context will be swapped, but we still
    * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
+   * This is to allow "temp cache" work correctly for all threads.
    */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  worker->context.task_id = worker->context_cpy.task_id;
 }
 
-static void seq_prefetch_update_scene(Scene *scene)
+static void seq_prefetch_update_scene(Scene *scene, const int num_active_workers)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
@@ -327,16 +389,20 @@ static void seq_prefetch_update_scene(Scene *scene)
   }
 
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+    if (i < num_active_workers) {
+      seq_prefetch_init_depsgraph(&pfjob->workers[i]);
+    }
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && seq_prefetch_job_is_running(scene)) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -349,11 +415,15 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
@@ -361,18 +431,18 @@ void seq_prefetch_free(Scene *scene)
 
 /* Skip frame if we need to render 3D scene strip. Rendering 3D scene requires main lock or setting
  * up render job that doesn't have API to do openGL renders which can be used for sequencer. */
-static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker, ListBase *seqbase)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = seq_get_shown_sequences(seqbase, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
   for (int i = 0; i < count; i++) {
     if (seq_arr[i]->type == SEQ_TYPE_META &&
-        seq_prefetch_do_skip_frame(pfjob, &seq_arr[i]->seqbase)) {
+        seq_prefetch_do_skip_frame(worker, &seq_arr[i]->seqbase)) {
       return true;
     }
 
@@ -423,37 +493,88 @@ static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
   return false;
 }
 
-static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_is_enabled(PrefetchJob *pfjob)
 {
-  return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+  return (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop;
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_need_suspend(PrefetchWorker *worker)
 {
-  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+  PrefetchJob *pfjob = worker->pfjob;
+
+  if (seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain)) {
+    return true;
+  }
+
+  return !seq_prefetch_worker_has_chunk(worker) &&
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
+}
+
+/* Must be called with `prefetch_suspend_mutex` locked. */
+static void seq_prefetch_do_suspend(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+
+  while (seq_prefetch_need_suspend(worker) && seq_prefetch_is_enabled(pfjob)) {
+    worker->waiting = true;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
     seq_prefetch_update_area(pfjob);
   }
-  pfjob->waiting = false;
+  worker->waiting = false;
+}
+
+/* Assign the next frame to the worker. Workers render their chunk of frames in order, new chunks
+ * are handed out in order, so frames nearest to the playhead are rendered first.
+ * Returns false when the worker should stop. */
+static bool seq_prefetch_next_frame(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+  bool has_frame = false;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+
+  /* Suspend thread if there is nothing to be prefetched. */
+  seq_prefetch_do_suspend(worker);
+  seq_prefetch_update_area(pfjob);
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  const bool collision = pfjob->num_frames_prefetched > 5 &&
+                         (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2;
+
+  if (!seq_prefetch_is_enabled(pfjob)) {
+    /* Pass. */
+  }
+  else if (seq_prefetch_worker_has_chunk(worker)) {
+    worker->cfra = seq_prefetch_worker_next_cfra(worker);
+    has_frame = true;
+  }
+  else if (!collision && seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
+    const int num_frames = min_ii(SEQ_PREFETCH_CHUNK_SIZE,
+                                  pfjob->scene->r.efra - seq_prefetch_cfra(pfjob) + 1);
+    worker->cfra = seq_prefetch_cfra(pfjob);
+    worker->chunk_end = worker->cfra + num_frames;
+    pfjob->num_frames_prefetched += num_frames;
+    has_frame = true;
+  }
+
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return has_frame;
 }
 
-static void *seq_prefetch_frames(void *job)
+static void *seq_prefetch_frames(void *worker_v)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = (PrefetchWorker *)worker_v;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  while (seq_prefetch_next_frame(worker)) {
+    worker->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -461,38 +582,21 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    worker->scene_eval->ed->prefetch_job = pfjob;
 
     ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
-    if (seq_prefetch_do_skip_frame(pfjob, seqbase)) {
-      pfjob->num_frames_prefetched++;
+    if (seq_prefetch_do_skip_frame(worker, seqbase)) {
       continue;
     }
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+    ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
     IMB_freeImBuf(ibuf);
-
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
-
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
-
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
-
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
   }
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  worker->scene_eval->ed->prefetch_job = NULL;
+  worker->running = false;
 
   return NULL;
 }
@@ -506,13 +610,19 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      /* Leave part of the threads to the main thread and to threading within the renderer. */
+      pfjob->num_workers = clamp_i(BLI_system_thread_count() / 2, 1, SEQ_PREFETCH_MAX_WORKERS);
+      for (int i = 0; i < pfjob->num_workers; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+        pfjob->workers[i].index = i;
+      }
+
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->num_workers);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
       pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
     }
   }
   pfjob->bmain = context->bmain;
@@ -520,15 +630,27 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
-  pfjob->waiting = false;
   pfjob->stop = false;
-  pfjob->running = true;
 
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+
+  /* Depsgraphs are built on the main thread, only do this for workers which get a chunk. */
+  const int num_frames = max_ii(context->scene->r.efra - (int)cfra, 1);
+  const int num_chunks = (num_frames + SEQ_PREFETCH_CHUNK_SIZE - 1) / SEQ_PREFETCH_CHUNK_SIZE;
+  const int num_active_workers = min_ii(pfjob->num_workers, num_chunks);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  seq_prefetch_update_scene(context->scene, num_active_workers);
+
+  for (int i = 0; i < num_active_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    seq_prefetch_update_context(worker, context);
+    worker->chunk_end = worker->cfra;
+    worker->waiting = false;
+    worker->running = true;
+    BLI_threadpool_insert(&pfjob->threads, worker);
+  }
 
   return pfjob;
 }
@@ -475,6 +475,28 @@ static void wm_init_userdef(Main *bmain)
  * we could support registering other file formats and their loaders.
  * \{ */
 
+#ifdef WITH_ZSTD
+/**
+ * Zstd compressed files start with the magic number of their first frame,
+ * the blend header is only checked when the file is read, see #blo_filedata_from_file_descriptor.
+ */
+static bool wm_read_exotic_is_zstd(const char *name)
+{
+  /* #ZSTD_MAGICNUMBER (0xFD2FB528) in little endian byte order. */
+  const unsigned char zstd_magic[4] = {0x28, 0xb5, 0x2f, 0xfd};
+  unsigned char header[4];
+  bool is_zstd = false;
+
+  FILE *fp = BLI_fopen(name, "rb");
+  if (fp != NULL) {
+    is_zstd = (fread(header, 1, sizeof(header), fp) == sizeof(header)) &&
+              (memcmp(header, zstd_magic, sizeof(header)) == 0);
+    fclose(fp);
+  }
+  return is_zstd;
+}
+#endif
+
 /* intended to check for non-blender formats but for now it only reads blends */
 static int wm_read_exotic(const char *name)
 {
@@ -500,6 +522,11 @@ static int wm_read_exotic(const char *name)
       if (len == sizeof(header) && STREQLEN(header, "BLENDER", 7)) {
         retval = BKE_READ_EXOTIC_OK_BLEND;
       }
+#ifdef WITH_ZSTD
+      else if (wm_read_exotic_is_zstd(name)) {
+        retval = BKE_READ_EXOTIC_OK_BLEND;
+      }
+#endif
       else {
         /* We may want to support loading other file formats
          * from their header bytes or file extension.
@@ -733,6 +760,15 @@ static void wm_file_read_post(bContext *C,
 /** \name Read Main Blend-File API
  * \{ */
 
+/**
+ * Lazy reading of data-blocks (`--lazy-load`), not used when scripts in the file may run,
+ * because they can access any data-block.
+ */
+static bool wm_file_read_use_lazy_ids(void)
+{
+  return G.background && (G.fileflags & G_FILE_LAZY_READ) && (G.f & G_FLAG_SCRIPT_AUTOEXEC) == 0;
+}
+
 bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
 {
   /* assume automated tasks with background, don't write recent file list */
@@ -760,7 +796,8 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
         /* Loading preferences when the user intended to load a regular file is a security
          * risk, because the excluded path list is also loaded. Further it's just confusing
          * if a user loads a file and various preferences change. */
-        .skip_flags = BLO_READ_SKIP_USERDEF,
+        .skip_flags = BLO_READ_SKIP_USERDEF |
+                      (wm_file_read_use_lazy_ids() ? BLO_READ_LAZY_IDS : 0),
     };
 
     struct BlendFileData *bfd = BKE_blendfile_read(filepath, &params, reports);
@@ -1572,6 +1609,7 @@ static bool wm_file_write(bContext *C,
     }
 
     SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS, G_FILE_COMPRESS);
+    SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS_ZSTD, G_FILE_COMPRESS_ZSTD);
 
     /* prevent background mode scripts from clobbering history */
     if (do_history_file_update) {
@@ -2747,6 +2785,16 @@ static void save_set_compress(wmOperator *op)
       RNA_property_boolean_set(op->ptr, prop, (U.flag & USER_FILECOMPRESS) != 0);
     }
   }
+
+  prop = RNA_struct_find_property(op->ptr, "compress_zstd");
+  if (!RNA_property_is_set(op->ptr, prop)) {
+    if (G.save_over) { /* keep compression method of existing file */
+      RNA_property_boolean_set(op->ptr, prop, (G.fileflags & G_FILE_COMPRESS_ZSTD) != 0);
+    }
+    else {
+      RNA_property_boolean_set(op->ptr, prop, (U.flag & USER_FILECOMPRESS_ZSTD) != 0);
+    }
+  }
 }
 
 static void save_set_filepath(bContext *C, wmOperator *op)
@@ -2812,6 +2860,7 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
 
   /* set compression flag */
   SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "compress"), G_FILE_COMPRESS);
+  SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "compress_zstd"), G_FILE_COMPRESS_ZSTD);
 
   const bool ok = wm_file_write(C, path, fileflags, remap_mode, use_save_as_copy, op->reports);
 
@@ -2892,6 +2941,11 @@ void WM_OT_save_as_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_DEFAULT);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_boolean(ot->srna,
+                  "compress_zstd",
+                  false,
+                  "Zstd",
+                  "Use Zstandard instead of gzip compression (needs a build with Zstd support)");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   true,
@@ -2962,6 +3016,11 @@ void WM_OT_save_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_DEFAULT);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_boolean(ot->srna,
+                  "compress_zstd",
+                  false,
+                  "Zstd",
+                  "Use Zstandard instead of gzip compression (needs a build with Zstd support)");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   false,
@@ -43,7 +43,7 @@
 #  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
-#  include "BLO_readfile.h" /* only for BLO_has_bfile_extension */
+#  include "BLO_readfile.h"
 
 #  include "BKE_blender_version.h"
 #  include "BKE_context.h"
@@ -387,6 +387,13 @@ static void arg_py_context_backup(bContext *C,
                                   struct BlendePyContextStore *c_py,
                                   const char *script_id)
 {
+  /* Scripts may iterate over any data, read the data-blocks skipped by `--lazy-load`. */
+  Main *bmain = CTX_data_main(C);
+  if (bmain->lazy_filedata != NULL) {
+    BLO_lazy_id_load_all(bmain);
+    DEG_relations_tag_update(bmain);
+  }
+
   c_py->wm = CTX_wm_manager(C);
   c_py->scene = CTX_data_scene(C);
   c_py->has_win = !BLI_listbase_is_empty(&c_py->wm->windows);
@@ -589,6 +596,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-validate");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
   BLI_args_print_arg_doc(ba, "--debug-gpu-force-workarounds");
@@ -613,6 +621,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--open-last");
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
+  BLI_args_print_arg_doc(ba, "--lazy-load");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
   printf("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
@@ -991,6 +1000,9 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_validate[] =
+    "\n\t"
+    "Compare incrementally updated dependency graph relations with a full rebuild.";
 static const char arg_handle_debug_mode_generic_set_doc_gpu_force_workarounds[] =
     "\n\t"
     "Enable workarounds for typical GPU issues and disable all GPU extensions.";
@@ -1128,6 +1140,22 @@ static int arg_handle_factory_startup_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_lazy_load_set_doc[] =
+    "\n\t"
+    "Only load the data-blocks used by the active scene when opening blend-files\n"
+    "\t(background mode only). A scene passed to '--scene' is loaded when needed,\n"
+    "\tall data-blocks are loaded before running Python scripts passed as arguments\n"
+    "\tand before saving. The option is ignored when auto-running scripts from blend-files\n"
+    "\tis enabled.\n"
+    "\tPython handlers, for example from add-ons, may not see all data-blocks in 'bpy.data'.";
+static int arg_handle_lazy_load_set(int UNUSED(argc),
+                                    const char **UNUSED(argv),
+                                    void *UNUSED(data))
+{
+  G.fileflags |= G_FILE_LAZY_READ;
+  return 0;
+}
+
 static const char arg_handle_enable_event_simulate_doc[] =
     "\n\t"
     "Enable event simulation testing feature 'bpy.types.Window.event_simulate'.";
@@ -1635,7 +1663,13 @@ static int arg_handle_scene_set(int argc, const char **argv, void *data)
 {
   if (argc > 1) {
     bContext *C = data;
-    Scene *scene = BKE_scene_set_name(CTX_data_main(C), argv[1]);
+    Main *bmain = CTX_data_main(C);
+    /* Scenes other than the active one are skipped by `--lazy-load`. */
+    if (BKE_libblock_find_name(bmain, ID_SCE, argv[1]) == NULL &&
+        BLO_lazy_id_load(bmain, ID_SCE, argv[1]) != NULL) {
+      DEG_relations_tag_update(bmain);
+    }
+    Scene *scene = BKE_scene_set_name(bmain, argv[1]);
     if (scene) {
       CTX_data_scene_set(C, scene);
 
@@ -2193,6 +2227,11 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_build),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-depsgraph-validate",
+               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_validate),
+               (void *)G_DEBUG_DEPSGRAPH_VALIDATE);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",
@@ -2204,6 +2243,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_args_add(ba, NULL, "--app-template", CB(arg_handle_app_template), NULL);
   BLI_args_add(ba, NULL, "--factory-startup", CB(arg_handle_factory_startup_set), NULL);
+  BLI_args_add(ba, NULL, "--lazy-load", CB(arg_handle_lazy_load_set), NULL);
   BLI_args_add(ba, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
 
   /* Pass: Custom Window Stuff. */
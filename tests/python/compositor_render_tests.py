@@ -16,7 +16,7 @@ try:
 except ImportError:
     inside_blender = False
 
-def get_arguments(filepath, output_filepath):
+def get_arguments(filepath, output_filepath, execution_mode):
     return [
         "--background",
         "-noaudio",
@@ -27,6 +27,8 @@ def get_arguments(filepath, output_filepath):
         filepath,
         "-P",
         os.path.realpath(__file__),
+        "--python-expr",
+        "import bpy; bpy.context.scene.node_tree.execution_mode = '%s'" % execution_mode,
         "-o", output_filepath,
         "-F", "PNG",
         "-f", "1"]
@@ -38,6 +40,7 @@ def create_argparse():
     parser.add_argument("-testdir", nargs=1)
     parser.add_argument("-outdir", nargs=1)
     parser.add_argument("-idiff", nargs=1)
+    parser.add_argument("-execution-mode", nargs=1, default=["TILED"], choices=["TILED", "FULL_FRAME"])
     return parser
 
 
@@ -49,12 +52,17 @@ def main():
     test_dir = args.testdir[0]
     idiff = args.idiff[0]
     output_dir = args.outdir[0]
+    execution_mode = args.execution_mode[0]
+
+    def get_mode_arguments(filepath, output_filepath):
+        return get_arguments(filepath, output_filepath, execution_mode)
 
     from modules import render_report
-    report = render_report.Report("Compositor", output_dir, idiff)
+    title = "Compositor Full Frame" if execution_mode == 'FULL_FRAME' else "Compositor"
+    report = render_report.Report(title, output_dir, idiff)
     report.set_pixelated(True)
     report.set_reference_dir("compositor_renders")
-    ok = report.run(test_dir, blender, get_arguments, batch=True)
+    ok = report.run(test_dir, blender, get_mode_arguments, batch=True)
 
     sys.exit(not ok)
 
@@ -0,0 +1,188 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Compare the noise of Cycles light sampling with and without the light tree, at equal render time,
+in a procedurally generated scene with many small lights.
+
+Example Usage:
+
+./blender.bin --background --factory-startup --python tests/python/cycles_light_tree_benchmark.py -- \
+    --lamps=1000 --mesh-lights=200 --resolution=256 --time=20
+
+The noise of each configuration is estimated from two renders with different seeds, as the RMS
+difference between them divided by the square root of two.
+"""
+
+import argparse
+import os
+import random
+import sys
+import tempfile
+import time
+
+
+def create_scene(num_lamps, num_mesh_lights, resolution, seed):
+    import bpy
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    rng = random.Random(seed)
+
+    scene.render.engine = 'CYCLES'
+    scene.render.resolution_x = resolution
+    scene.render.resolution_y = resolution
+    scene.render.resolution_percentage = 100
+    scene.render.image_settings.file_format = 'OPEN_EXR'
+    scene.render.image_settings.color_depth = '32'
+    scene.cycles.device = 'CPU'
+    scene.cycles.progressive = 'PATH'
+    scene.cycles.use_adaptive_sampling = False
+    scene.cycles.use_denoising = False
+    scene.cycles.max_bounces = 2
+    scene.cycles.light_sampling_threshold = 0.0
+
+    # Ground plane, with a few boxes to give the lights something to occlude.
+    bpy.ops.mesh.primitive_plane_add(size=40.0)
+    for _ in range(8):
+        bpy.ops.mesh.primitive_cube_add(
+            size=rng.uniform(0.5, 2.0),
+            location=(rng.uniform(-8.0, 8.0), rng.uniform(-8.0, 8.0), 0.5))
+
+    # Small point lights of varying power spread over the ground.
+    for i in range(num_lamps):
+        light = bpy.data.lights.new("Lamp%d" % i, 'POINT')
+        light.energy = rng.uniform(1.0, 20.0)
+        light.shadow_soft_size = 0.05
+        light.color = (rng.random(), rng.random(), rng.random())
+        ob = bpy.data.objects.new("Lamp%d" % i, light)
+        ob.location = (rng.uniform(-10.0, 10.0), rng.uniform(-10.0, 10.0), rng.uniform(0.2, 3.0))
+        scene.collection.objects.link(ob)
+
+    # Emissive quads facing random directions.
+    material = bpy.data.materials.new("Emission")
+    material.use_nodes = True
+    nodes = material.node_tree.nodes
+    nodes.clear()
+    emission = nodes.new('ShaderNodeEmission')
+    emission.inputs['Strength'].default_value = 10.0
+    output = nodes.new('ShaderNodeOutputMaterial')
+    material.node_tree.links.new(emission.outputs['Emission'], output.inputs['Surface'])
+
+    for _ in range(num_mesh_lights):
+        bpy.ops.mesh.primitive_plane_add(
+            size=0.2,
+            location=(rng.uniform(-10.0, 10.0), rng.uniform(-10.0, 10.0), rng.uniform(0.2, 3.0)),
+            rotation=(rng.uniform(0.0, 6.28), rng.uniform(0.0, 6.28), 0.0))
+        bpy.context.object.data.materials.append(material)
+
+    camera_data = bpy.data.cameras.new("Camera")
+    camera = bpy.data.objects.new("Camera", camera_data)
+    camera.location = (0.0, -14.0, 9.0)
+    camera.rotation_euler = (0.95, 0.0, 0.0)
+    scene.collection.objects.link(camera)
+    scene.camera = camera
+
+    return scene
+
+
+def render(scene, filepath, samples, seed):
+    import bpy
+
+    scene.cycles.samples = samples
+    scene.cycles.seed = seed
+    scene.render.filepath = filepath
+
+    start_time = time.perf_counter()
+    bpy.ops.render.render(write_still=True)
+    return time.perf_counter() - start_time
+
+
+def load_pixels(filepath):
+    import bpy
+    import numpy
+
+    image = bpy.data.images.load(filepath)
+    pixels = numpy.empty(len(image.pixels), dtype=numpy.float32)
+    image.pixels.foreach_get(pixels)
+    bpy.data.images.remove(image)
+    return pixels.reshape(-1, 4)[:, :3]
+
+
+def estimate_noise(filepath_a, filepath_b):
+    import numpy
+
+    difference = load_pixels(filepath_a) - load_pixels(filepath_b)
+    return float(numpy.sqrt(numpy.mean(difference * difference) / 2.0))
+
+
+def benchmark_configuration(scene, use_light_tree, time_budget, tmpdir):
+    name = "tree" if use_light_tree else "distribution"
+    scene.cycles.use_light_tree = use_light_tree
+
+    # Estimate the fixed cost and the cost per sample from two short renders.
+    pilot_samples = (4, 16)
+    pilot_times = [render(scene, os.path.join(tmpdir, "pilot.exr"), samples, 0)
+                   for samples in pilot_samples]
+    time_per_sample = max((pilot_times[1] - pilot_times[0]) / (pilot_samples[1] - pilot_samples[0]), 1e-6)
+    overhead = max(pilot_times[0] - pilot_samples[0] * time_per_sample, 0.0)
+    samples = max(int((time_budget - overhead) / time_per_sample), 1)
+
+    filepaths = [os.path.join(tmpdir, "%s_%d.exr" % (name, seed)) for seed in (1, 2)]
+    times = [render(scene, filepath, samples, seed) for seed, filepath in zip((1, 2), filepaths)]
+
+    return {
+        "name": name,
+        "samples": samples,
+        "time": sum(times) / len(times),
+        "noise": estimate_noise(filepaths[0], filepaths[1]),
+    }
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(description="Cycles light tree benchmark")
+    parser.add_argument("--lamps", type=int, default=1000, help="Number of point lights")
+    parser.add_argument("--mesh-lights", type=int, default=200, help="Number of emissive quads")
+    parser.add_argument("--resolution", type=int, default=256, help="Image width and height")
+    parser.add_argument("--time", type=float, default=20.0, help="Render time per image in seconds")
+    parser.add_argument("--seed", type=int, default=0, help="Seed for generating the scene")
+    args = parser.parse_args(argv)
+
+    scene = create_scene(args.lamps, args.mesh_lights, args.resolution, args.seed)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        results = [benchmark_configuration(scene, use_light_tree, args.time, tmpdir)
+                   for use_light_tree in (False, True)]
+
+    print("")
+    print("%-14s %10s %10s %12s" % ("Sampling", "Samples", "Time (s)", "Noise (RMS)"))
+    for result in results:
+        print("%-14s %10d %10.2f %12.6f" %
+              (result["name"], result["samples"], result["time"], result["noise"]))
+
+    if results[1]["noise"] > 0.0:
+        print("")
+        print("Noise reduction at equal time: %.2fx" % (results[0]["noise"] / results[1]["noise"]))
+
+
+if __name__ == "__main__":
+    main()